@@ -0,0 +1,368 @@
+/*!
+ @file           kbit.c
+ @brief          bit vector library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kbit.h"
+
+/* number of words of n bits */
+#define KBV_WORDS(n) (((n) >> 6) + (((n)&63U) != 0U))
+
+/* release the directories */
+static void kbv_drop(kbitvec_t *bv)
+{
+    free(bv->r);
+    free(bv->s);
+    bv->r = NULL;
+    bv->s = NULL;
+    bv->c = 0U;
+    bv->ok = 0;
+}
+
+void kbv_init(kbitvec_t *bv)
+{
+    (void)memset(bv, 0, sizeof(*bv));
+}
+
+void kbv_free(kbitvec_t *bv)
+{
+    kbv_drop(bv);
+    free(bv->v);
+    kbv_init(bv);
+}
+
+int kbv_resize(kbitvec_t *bv,
+               size_t n)
+{
+    size_t w = KBV_WORDS(n);
+    size_t l = KBV_WORDS(bv->n);
+    if (n > SIZE_MAX - 63U)
+    {
+        return -1;
+    }
+    if (w > bv->m)
+    {
+        size_t m = bv->m << 1 > w ? bv->m << 1 : w;
+        void *v = realloc(bv->v, sizeof(uint64_t) * m);
+        if (!v)
+        {
+            return -1;
+        }
+        bv->v = (uint64_t *)v;
+        bv->m = m;
+    }
+    if (w > l)
+    {
+        (void)memset(bv->v + l, 0, sizeof(uint64_t) * (w - l));
+    }
+    /* the bits after the last bit are kept 0 */
+    if (n < bv->n && (n & 63U))
+    {
+        bv->v[n >> 6] &= (UINT64_C(1) << (n & 63U)) - 1U;
+    }
+    bv->n = n;
+    bv->ok = 0;
+    return 0;
+}
+
+int kbv_load(kbitvec_t *bv,
+             const uint64_t *v,
+             size_t n)
+{
+    bv->n = 0U;
+    if (kbv_resize(bv, n))
+    {
+        return -1;
+    }
+    if (n)
+    {
+        (void)memcpy(bv->v, v, sizeof(uint64_t) * KBV_WORDS(n));
+        if (n & 63U)
+        {
+            bv->v[n >> 6] &= (UINT64_C(1) << (n & 63U)) - 1U;
+        }
+    }
+    return 0;
+}
+
+int kbv_push(kbitvec_t *bv,
+             int x)
+{
+    size_t i = bv->n;
+    if (kbv_resize(bv, i + 1U))
+    {
+        return -1;
+    }
+    bv->v[i >> 6] |= (uint64_t)(x != 0) << (i & 63U);
+    return 0;
+}
+
+__TARGET_CLONES
+size_t kbv_count(const kbitvec_t *bv)
+{
+    const uint64_t *v = bv->v;
+    size_t w = KBV_WORDS(bv->n);
+    size_t c = 0U;
+    for (size_t i = 0U; i != w; ++i)
+    {
+        c += kpopcount64(v[i]);
+    }
+    return c;
+}
+
+/* prepare dst for the result of a and b */
+static int kbv_binary(kbitvec_t *dst,
+                      const kbitvec_t *a,
+                      const kbitvec_t *b)
+{
+    if (a->n != b->n)
+    {
+        return -1;
+    }
+    if (dst != a && dst != b && kbv_resize(dst, a->n))
+    {
+        return -1;
+    }
+    dst->ok = 0;
+    return 0;
+}
+
+__TARGET_CLONES
+int kbv_and(kbitvec_t *dst,
+            const kbitvec_t *a,
+            const kbitvec_t *b)
+{
+    if (kbv_binary(dst, a, b))
+    {
+        return -1;
+    }
+    uint64_t *v = dst->v;
+    const uint64_t *p = a->v;
+    const uint64_t *q = b->v;
+    for (size_t i = 0U, w = KBV_WORDS(a->n); i != w; ++i)
+    {
+        v[i] = p[i] & q[i];
+    }
+    return 0;
+}
+
+__TARGET_CLONES
+int kbv_or(kbitvec_t *dst,
+           const kbitvec_t *a,
+           const kbitvec_t *b)
+{
+    if (kbv_binary(dst, a, b))
+    {
+        return -1;
+    }
+    uint64_t *v = dst->v;
+    const uint64_t *p = a->v;
+    const uint64_t *q = b->v;
+    for (size_t i = 0U, w = KBV_WORDS(a->n); i != w; ++i)
+    {
+        v[i] = p[i] | q[i];
+    }
+    return 0;
+}
+
+__TARGET_CLONES
+int kbv_xor(kbitvec_t *dst,
+            const kbitvec_t *a,
+            const kbitvec_t *b)
+{
+    if (kbv_binary(dst, a, b))
+    {
+        return -1;
+    }
+    uint64_t *v = dst->v;
+    const uint64_t *p = a->v;
+    const uint64_t *q = b->v;
+    for (size_t i = 0U, w = KBV_WORDS(a->n); i != w; ++i)
+    {
+        v[i] = p[i] ^ q[i];
+    }
+    return 0;
+}
+
+__TARGET_CLONES
+int kbv_andnot(kbitvec_t *dst,
+               const kbitvec_t *a,
+               const kbitvec_t *b)
+{
+    if (kbv_binary(dst, a, b))
+    {
+        return -1;
+    }
+    uint64_t *v = dst->v;
+    const uint64_t *p = a->v;
+    const uint64_t *q = b->v;
+    for (size_t i = 0U, w = KBV_WORDS(a->n); i != w; ++i)
+    {
+        v[i] = p[i] & ~q[i];
+    }
+    return 0;
+}
+
+/*
+ Block b is words [8 * b, 8 * b + 8). r[2 * b] is the number of ones
+ before block b, r[2 * b + 1] keeps the number of ones before word j
+ of block in bits [9 * (j - 1), 9 * j) for j in [1, 8).
+*/
+
+__TARGET_CLONES
+int kbv_build(kbitvec_t *bv)
+{
+    size_t w = KBV_WORDS(bv->n);
+    size_t nb = (w >> 3) + 1U;
+    kbv_drop(bv);
+    bv->r = (uint64_t *)malloc(sizeof(uint64_t) * 2U * nb);
+    if (!bv->r)
+    {
+        return -1;
+    }
+    size_t c = 0U;
+    for (size_t b = 0U; b != nb; ++b)
+    {
+        uint64_t sub = 0U;
+        uint64_t d = 0U;
+        for (size_t j = 0U; j != 8U; ++j)
+        {
+            if (j)
+            {
+                d |= sub << (9U * (j - 1U));
+            }
+            size_t i = (b << 3) + j;
+            sub += i < w ? kpopcount64(bv->v[i]) : 0U;
+        }
+        bv->r[2U * b] = c;
+        bv->r[2U * b + 1U] = d;
+        c += (size_t)sub;
+    }
+    /* block of every 512 ones, and the last block */
+    size_t ns = (c >> 9) + 1U;
+    bv->s = (size_t *)malloc(sizeof(size_t) * (ns + 1U));
+    if (!bv->s)
+    {
+        kbv_drop(bv);
+        return -1;
+    }
+    size_t k = 0U;
+    for (size_t b = 0U; b != nb; ++b)
+    {
+        size_t e = b + 1U < nb ? (size_t)bv->r[2U * (b + 1U)] : c;
+        /* the one k * 512 is in block b */
+        for (; k != ns && (k << 9) < e; ++k)
+        {
+            bv->s[k] = b;
+        }
+    }
+    for (; k != ns; ++k)
+    {
+        bv->s[k] = nb - 1U;
+    }
+    bv->s[ns] = nb - 1U;
+    bv->c = c;
+    bv->ok = 1;
+    return 0;
+}
+
+int kbv_rank(size_t *dst,
+             const kbitvec_t *bv,
+             size_t i)
+{
+    if (!bv->ok || i > bv->n)
+    {
+        return -1;
+    }
+    size_t w = i >> 6;
+    size_t b = w >> 3;
+    size_t j = w & 7U;
+    size_t c = (size_t)bv->r[2U * b];
+    if (j)
+    {
+        c += (size_t)((bv->r[2U * b + 1U] >> (9U * (j - 1U))) & 511U);
+    }
+    if (i & 63U)
+    {
+        c += kpopcount64(bv->v[w] & ((UINT64_C(1) << (i & 63U)) - 1U));
+    }
+    *dst = c;
+    return 0;
+}
+
+int kbv_select(size_t *dst,
+               const kbitvec_t *bv,
+               size_t k)
+{
+    if (!bv->ok || k >= bv->c)
+    {
+        return -1;
+    }
+    /* the last block in the samples that has not more than k ones before */
+    size_t lo = bv->s[k >> 9];
+    size_t hi = bv->s[(k >> 9) + 1U];
+    while (lo < hi)
+    {
+        size_t mid = lo + ((hi - lo + 1U) >> 1);
+        if (bv->r[2U * mid] <= k)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1U;
+        }
+    }
+    k -= (size_t)bv->r[2U * lo];
+    uint64_t d = bv->r[2U * lo + 1U];
+    size_t j = 0U;
+    while (j != 7U && ((d >> (9U * j)) & 511U) <= k)
+    {
+        ++j;
+    }
+    if (j)
+    {
+        k -= (size_t)((d >> (9U * (j - 1U))) & 511U);
+    }
+    size_t w = (lo << 3) + j;
+    uint64_t x = bv->v[w];
+    size_t i = w << 6;
+    /* skip the bytes, then the ones in the byte */
+    for (size_t c = kpopcount64(x & 0xFFU); c <= k;)
+    {
+        k -= c;
+        x >>= 8;
+        i += 8U;
+        c = kpopcount64(x & 0xFFU);
+    }
+    for (; k; --k)
+    {
+        x &= x - 1U;
+    }
+    *dst = i + kctz64(x);
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,278 @@
+/*!
+ @file           kbit.h
+ @brief          bit vector library
+ @details        The bits are kept in words of 64 bits. After kbv_build, rank
+                 is answered from the count of ones before each 512 bits and
+                 the counts of its words, select is started from a sample of
+                 every 512 ones.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KBIT_H__
+#define __KBIT_H__
+
+#include "klib.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*!
+ @brief          bit vector
+*/
+typedef struct kbitvec_t
+{
+    size_t n;    /* number of bits                  */
+    size_t m;    /* number of words of memory       */
+    uint64_t *v; /* words of bits                   */
+    uint64_t *r; /* rank directory, two words a 512 */
+    size_t *s;   /* select samples, a 512 ones      */
+    size_t c;    /* number of ones when it is built */
+    int ok;      /* the directories are valid       */
+} kbitvec_t;
+
+__BEGIN_DECLS
+
+/*!
+ @brief          initialize a bit vector
+ @param[in,out]  bv: pointer of bit vector
+*/
+extern void kbv_init(kbitvec_t *bv)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free the memory of bit vector
+ @param[in,out]  bv: pointer of bit vector
+*/
+extern void kbv_free(kbitvec_t *bv)
+    __NONNULL_ALL;
+
+/*!
+ @brief          change the number of bits, new bits are 0
+ @param[in,out]  bv: pointer of bit vector
+ @param[in]      n: number of bits
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_resize(kbitvec_t *bv,
+                      size_t n)
+    __NONNULL_ALL;
+
+/*!
+ @brief          copy the bits from words
+ @param[in,out]  bv: pointer of bit vector
+ @param[in]      v: address of words, bit i is bit i % 64 of word i / 64
+ @param[in]      n: number of bits
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_load(kbitvec_t *bv,
+                    const uint64_t *v,
+                    size_t n)
+    __NONNULL((1));
+
+/*!
+ @brief          append a bit to bit vector
+ @param[in,out]  bv: pointer of bit vector
+ @param[in]      x: bit, it is 1 if it is not 0
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_push(kbitvec_t *bv,
+                    int x)
+    __NONNULL_ALL;
+
+/*!
+ @brief          number of ones in bit vector
+ @param[in]      bv: pointer of bit vector
+ @return         number of ones
+*/
+extern size_t kbv_count(const kbitvec_t *bv)
+    __NONNULL_ALL;
+
+/*!
+ @brief          dst = a & b
+ @param[out]     dst: pointer of bit vector, it may be a or b
+ @param[in]      a: pointer of bit vector
+ @param[in]      b: pointer of bit vector, it has the same size as a
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_and(kbitvec_t *dst,
+                   const kbitvec_t *a,
+                   const kbitvec_t *b)
+    __NONNULL_ALL;
+
+/*!
+ @brief          dst = a | b
+ @param[out]     dst: pointer of bit vector, it may be a or b
+ @param[in]      a: pointer of bit vector
+ @param[in]      b: pointer of bit vector, it has the same size as a
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_or(kbitvec_t *dst,
+                  const kbitvec_t *a,
+                  const kbitvec_t *b)
+    __NONNULL_ALL;
+
+/*!
+ @brief          dst = a ^ b
+ @param[out]     dst: pointer of bit vector, it may be a or b
+ @param[in]      a: pointer of bit vector
+ @param[in]      b: pointer of bit vector, it has the same size as a
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_xor(kbitvec_t *dst,
+                   const kbitvec_t *a,
+                   const kbitvec_t *b)
+    __NONNULL_ALL;
+
+/*!
+ @brief          dst = a & ~b
+ @param[out]     dst: pointer of bit vector, it may be a or b
+ @param[in]      a: pointer of bit vector
+ @param[in]      b: pointer of bit vector, it has the same size as a
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_andnot(kbitvec_t *dst,
+                      const kbitvec_t *a,
+                      const kbitvec_t *b)
+    __NONNULL_ALL;
+
+/*!
+ @brief          build the directories of rank and select
+ @details        it should be called again after the bits are changed
+ @param[in,out]  bv: pointer of bit vector
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kbv_build(kbitvec_t *bv)
+    __NONNULL_ALL;
+
+/*!
+ @brief          number of ones in [0, i)
+ @param[out]     dst: pointer of number
+ @param[in]      bv: pointer of bit vector, it is built
+ @param[in]      i: index of bit, it is not greater than the size
+ @return         the execution state of the function
+  @retval        -1 failure, it is not built or i is out of range
+  @retval        0  success
+*/
+extern int kbv_rank(size_t *dst,
+                    const kbitvec_t *bv,
+                    size_t i)
+    __NONNULL_ALL;
+
+/*!
+ @brief          index of the one that has k ones before it
+ @param[out]     dst: pointer of index
+ @param[in]      bv: pointer of bit vector, it is built
+ @param[in]      k: number of ones before it, from 0
+ @return         the execution state of the function
+  @retval        -1 failure, it is not built or there are not k + 1 ones
+  @retval        0  success
+*/
+extern int kbv_select(size_t *dst,
+                      const kbitvec_t *bv,
+                      size_t k)
+    __NONNULL_ALL;
+
+__END_DECLS
+
+/* number of bits of bit vector */
+#ifndef kbv_size
+#define kbv_size(bv) ((bv).n)
+#endif /* kbv_size */
+
+__STATIC_INLINE
+/*!
+ @brief          test bit i
+ @param[in]      bv: pointer of bit vector
+ @param[in]      i: index of bit
+ @return         the bit, 0 if i is out of range
+*/
+int kbv_test(const kbitvec_t *bv,
+             size_t i)
+{
+    return i < bv->n ? (int)(bv->v[i >> 6] >> (i & 63U) & 1U) : 0;
+}
+
+__STATIC_INLINE
+/*!
+ @brief          set bit i to 1
+ @param[in,out]  bv: pointer of bit vector
+ @param[in]      i: index of bit
+ @return         the execution state of the function
+  @retval        -1 failure, i is out of range
+  @retval        0  success
+*/
+int kbv_set(kbitvec_t *bv,
+            size_t i)
+{
+    if (i < bv->n)
+    {
+        bv->v[i >> 6] |= UINT64_C(1) << (i & 63U);
+        bv->ok = 0;
+        return 0;
+    }
+    return -1;
+}
+
+__STATIC_INLINE
+/*!
+ @brief          set bit i to 0
+ @param[in,out]  bv: pointer of bit vector
+ @param[in]      i: index of bit
+ @return         the execution state of the function
+  @retval        -1 failure, i is out of range
+  @retval        0  success
+*/
+int kbv_clear(kbitvec_t *bv,
+              size_t i)
+{
+    if (i < bv->n)
+    {
+        bv->v[i >> 6] &= ~(UINT64_C(1) << (i & 63U));
+        bv->ok = 0;
+        return 0;
+    }
+    return -1;
+}
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KBIT_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,737 @@
+/*!
+ @file           kbtree.h
+ @brief          B+ tree of ordered map
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KBTREE_H__
+#define __KBTREE_H__
+
+#include "klib.h"
+#include "klist.h"
+#include "ksearch.h"
+#include "ksort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* bytes of a node, about 8 cache lines */
+#ifndef KBTREE_BYTES
+#define KBTREE_BYTES 512U
+#endif /* KBTREE_BYTES */
+
+/* nothing to do for a node of memory pool */
+#undef KBTREE_NOP
+#define KBTREE_NOP(p) (void)(p)
+
+/* size of a key with a value or a child in node */
+#undef KBTREE_SLOT
+#define KBTREE_SLOT(key_t, val_t)                                       \
+    (sizeof(key_t) +                                                    \
+     (sizeof(val_t) > sizeof(void *) ? sizeof(val_t) : sizeof(void *)))
+
+/* kbtree_order */
+#ifndef kbtree_order
+/*!
+ @brief          the most keys of a node, no less than 4
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+*/
+#define kbtree_order(key_t, val_t)                                          \
+    (KBTREE_BYTES > 3U * sizeof(void *) + 4U * KBTREE_SLOT(key_t, val_t)    \
+         ? (KBTREE_BYTES - 3U * sizeof(void *)) / KBTREE_SLOT(key_t, val_t) \
+         : 4U)
+#endif /* kbtree_order */
+
+/* kbtree_type */
+#ifndef kbtree_type
+/*!
+ @brief          Register type of B+ tree structure
+ @details        a leaf has keys and values, and is linked to the next leaf.
+                 an inner node has n keys and n + 1 children, the keys of
+                 child i + 1 are not less than key i.
+ @param[in]      name: identity name of B+ tree structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+*/
+#define kbtree_type(name, key_t, val_t)                                   \
+    typedef struct kbtree_##name##_n                                      \
+    {                                                                     \
+        key_t k[kbtree_order(key_t, val_t)];                              \
+        union                                                             \
+        {                                                                 \
+            val_t v[kbtree_order(key_t, val_t)];                          \
+            struct kbtree_##name##_n *c[kbtree_order(key_t, val_t) + 1U]; \
+        } u;                            /* values of leaf, or children */ \
+        struct kbtree_##name##_n *next; /* next leaf                  */  \
+        unsigned int n;                 /* number of keys             */  \
+        unsigned int leaf;              /* 1 if it is a leaf          */  \
+    } kbtree_##name##_n;                                                  \
+    kmempool_type(kb_##name, kbtree_##name##_n);                          \
+    typedef struct kbtree_##name##_e                                      \
+    {                                                                     \
+        key_t k; /* key   */                                              \
+        val_t v; /* value */                                              \
+    } kbtree_##name##_e;                                                  \
+    typedef struct kbtree_##name##_i                                      \
+    {                                                                     \
+        kbtree_##name##_n *p; /* leaf, NULL at the end */                 \
+        unsigned int i;       /* index of leaf         */                 \
+    } kbtree_##name##_i;                                                  \
+    typedef struct kbtree_##name##_t                                      \
+    {                                                                     \
+        kbtree_##name##_n *root; /* root node            */               \
+        size_t n;                /* number of keys       */               \
+        kmp_kb_##name##_t kmp;   /* memory pool of nodes */               \
+    } kbtree_##name##_t
+#endif /* kbtree_type */
+
+/* kbtree_t */
+#ifndef kbtree_t
+/*!
+ @brief          typedef of B+ tree registration
+ @param[in]      name: identity name of B+ tree structure
+*/
+#define kbtree_t(name) kbtree_##name##_t
+#endif /* kbtree_t */
+
+/* kbtree_i */
+#ifndef kbtree_i
+/*!
+ @brief          typedef of B+ tree iterator
+ @param[in]      name: identity name of B+ tree structure
+*/
+#define kbtree_i(name) kbtree_##name##_i
+#endif /* kbtree_i */
+
+/* kb_key */
+#ifndef kb_key
+/*!
+ @brief          key of B+ tree iterator
+ @param[in]      it: iterator of B+ tree
+*/
+#define kb_key(it) (it).p->k[(it).i]
+#endif /* kb_key */
+
+/* kb_val */
+#ifndef kb_val
+/*!
+ @brief          value of B+ tree iterator
+ @param[in]      it: iterator of B+ tree
+*/
+#define kb_val(it) (it).p->u.v[(it).i]
+#endif /* kb_val */
+
+/* __KBTREE_IMPL */
+#undef __KBTREE_IMPL
+#define __KBTREE_IMPL(SCOPE, NAME, KEY, VAL, CMP)                                \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void kb_##NAME##_init(kbtree_##NAME##_t *kb)                                 \
+    {                                                                            \
+        kb->root = NULL;                                                         \
+        kb->n = 0U;                                                              \
+        kmp_init(kb->kmp);                                                       \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void kb_##NAME##_free_(kbtree_##NAME##_t *kb,                                \
+                           kbtree_##NAME##_n *p)                                 \
+    {                                                                            \
+        if (!p->leaf)                                                            \
+        {                                                                        \
+            for (unsigned int i = 0U; i <= p->n; ++i)                            \
+            {                                                                    \
+                kb_##NAME##_free_(kb, p->u.c[i]);                                \
+            }                                                                    \
+        }                                                                        \
+        (void)kmp_free(kbtree_##NAME##_n, kb->kmp, p);                           \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void kb_##NAME##_clear(kbtree_##NAME##_t *kb)                                \
+    {                                                                            \
+        if (kb->root)                                                            \
+        {                                                                        \
+            kb_##NAME##_free_(kb, kb->root);                                     \
+        }                                                                        \
+        kmp_clear(KBTREE_NOP, kb->kmp);                                          \
+        kb_##NAME##_init(kb);                                                    \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    size_t kb_##NAME##_size(const kbtree_##NAME##_t *kb)                         \
+    {                                                                            \
+        return kb->n;                                                            \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    kbtree_##NAME##_n *kb_##NAME##_node_(kbtree_##NAME##_t *kb,                  \
+                                         unsigned int leaf)                      \
+    {                                                                            \
+        kbtree_##NAME##_n *p = kmp_alloc(kbtree_##NAME##_n, kb->kmp);            \
+        if (!p)                                                                  \
+        {                                                                        \
+            --kb->kmp.cnt;                                                       \
+            return NULL;                                                         \
+        }                                                                        \
+        p->next = NULL;                                                          \
+        p->n = 0U;                                                               \
+        p->leaf = leaf;                                                          \
+        return p;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    unsigned int kb_##NAME##_pos_(const kbtree_##NAME##_n *p,                    \
+                                  KEY key)                                       \
+    {                                                                            \
+        /* the lines of keys are loaded at once, not one by one of search */     \
+        for (size_t o = 0U; o < sizeof(KEY) * p->n; o += 64U)                    \
+        {                                                                        \
+            kprefetch((const char *)p->k + o);                                   \
+        }                                                                        \
+        size_t i;                                                                \
+        ksearch_lower(KEY, i, p->k, p->n, key, CMP);                             \
+        return (unsigned int)i;                                                  \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    unsigned int kb_##NAME##_child_(const kbtree_##NAME##_n *p,                  \
+                                    KEY key)                                     \
+    {                                                                            \
+        /* the keys equal to a separator are in the right child */               \
+        unsigned int i = kb_##NAME##_pos_(p, key);                               \
+        return i < p->n && !CMP(key, p->k[i]) ? i + 1U : i;                      \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    VAL *kb_##NAME##_get(const kbtree_##NAME##_t *kb,                            \
+                         KEY key)                                                \
+    {                                                                            \
+        kbtree_##NAME##_n *p = kb->root;                                         \
+        if (!p)                                                                  \
+        {                                                                        \
+            return NULL;                                                         \
+        }                                                                        \
+        while (!p->leaf)                                                         \
+        {                                                                        \
+            p = p->u.c[kb_##NAME##_child_(p, key)];                              \
+        }                                                                        \
+        unsigned int i = kb_##NAME##_pos_(p, key);                               \
+        return i < p->n && !CMP(key, p->k[i]) ? p->u.v + i : NULL;               \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    int kb_##NAME##_split_(kbtree_##NAME##_t *kb,                                \
+                           kbtree_##NAME##_n *x,                                 \
+                           unsigned int i)                                       \
+    {                                                                            \
+        const unsigned int o = kbtree_order(KEY, VAL), m = o >> 1;               \
+        kbtree_##NAME##_n *y = x->u.c[i];                                        \
+        kbtree_##NAME##_n *z = kb_##NAME##_node_(kb, y->leaf);                   \
+        if (!z)                                                                  \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        KEY sep;                                                                 \
+        if (y->leaf)                                                             \
+        {                                                                        \
+            z->n = o - m;                                                        \
+            (void)memcpy(z->k, y->k + m, sizeof(KEY) * z->n);                    \
+            (void)memcpy(z->u.v, y->u.v + m, sizeof(VAL) * z->n);                \
+            z->next = y->next;                                                   \
+            y->next = z;                                                         \
+            sep = z->k[0];                                                       \
+        }                                                                        \
+        else                                                                     \
+        {                                                                        \
+            z->n = o - m - 1U;                                                   \
+            (void)memcpy(z->k, y->k + m + 1U, sizeof(KEY) * z->n);               \
+            (void)memcpy(z->u.c, y->u.c + m + 1U, sizeof(z) * (z->n + 1U));      \
+            sep = y->k[m];                                                       \
+        }                                                                        \
+        y->n = m;                                                                \
+        (void)memmove(x->k + i + 1U, x->k + i, sizeof(KEY) * (x->n - i));        \
+        (void)memmove(x->u.c + i + 2U, x->u.c + i + 1U, sizeof(z) * (x->n - i)); \
+        x->k[i] = sep;                                                           \
+        x->u.c[i + 1U] = z;                                                      \
+        ++x->n;                                                                  \
+        return 0;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    VAL *kb_##NAME##_put(kbtree_##NAME##_t *kb,                                  \
+                         KEY key,                                                \
+                         int *absent)                                            \
+    {                                                                            \
+        const unsigned int o = kbtree_order(KEY, VAL);                           \
+        if (!kb->root)                                                           \
+        {                                                                        \
+            kb->root = kb_##NAME##_node_(kb, 1U);                                \
+            if (!kb->root)                                                       \
+            {                                                                    \
+                return NULL;                                                     \
+            }                                                                    \
+        }                                                                        \
+        /* full nodes are split on the way down, so a parent has room */         \
+        if (kb->root->n == o)                                                    \
+        {                                                                        \
+            kbtree_##NAME##_n *r = kb_##NAME##_node_(kb, 0U);                    \
+            if (!r)                                                              \
+            {                                                                    \
+                return NULL;                                                     \
+            }                                                                    \
+            r->u.c[0] = kb->root;                                                \
+            kb->root = r;                                                        \
+            if (kb_##NAME##_split_(kb, r, 0U))                                   \
+            {                                                                    \
+                kb->root = r->u.c[0];                                            \
+                (void)kmp_free(kbtree_##NAME##_n, kb->kmp, r);                   \
+                return NULL;                                                     \
+            }                                                                    \
+        }                                                                        \
+        kbtree_##NAME##_n *p = kb->root;                                         \
+        while (!p->leaf)                                                         \
+        {                                                                        \
+            unsigned int i = kb_##NAME##_child_(p, key);                         \
+            if (p->u.c[i]->n == o)                                               \
+            {                                                                    \
+                if (kb_##NAME##_split_(kb, p, i))                                \
+                {                                                                \
+                    return NULL;                                                 \
+                }                                                                \
+                if (!CMP(key, p->k[i]))                                          \
+                {                                                                \
+                    ++i;                                                         \
+                }                                                                \
+            }                                                                    \
+            p = p->u.c[i];                                                       \
+        }                                                                        \
+        unsigned int i = kb_##NAME##_pos_(p, key);                               \
+        if (i < p->n && !CMP(key, p->k[i]))                                      \
+        {                                                                        \
+            if (absent)                                                          \
+            {                                                                    \
+                *absent = 0;                                                     \
+            }                                                                    \
+            return p->u.v + i;                                                   \
+        }                                                                        \
+        (void)memmove(p->k + i + 1U, p->k + i, sizeof(KEY) * (p->n - i));        \
+        (void)memmove(p->u.v + i + 1U, p->u.v + i, sizeof(VAL) * (p->n - i));    \
+        p->k[i] = key;                                                           \
+        ++p->n;                                                                  \
+        ++kb->n;                                                                 \
+        if (absent)                                                              \
+        {                                                                        \
+            *absent = 1;                                                         \
+        }                                                                        \
+        return p->u.v + i;                                                       \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int kb_##NAME##_set(kbtree_##NAME##_t *kb,                                   \
+                        KEY key,                                                 \
+                        VAL val)                                                 \
+    {                                                                            \
+        int absent;                                                              \
+        VAL *v = kb_##NAME##_put(kb, key, &absent);                              \
+        if (!v)                                                                  \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        *v = val;                                                                \
+        return absent;                                                           \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void kb_##NAME##_merge_(kbtree_##NAME##_t *kb,                               \
+                            kbtree_##NAME##_n *x,                                \
+                            unsigned int i)                                      \
+    {                                                                            \
+        kbtree_##NAME##_n *a = x->u.c[i];                                        \
+        kbtree_##NAME##_n *b = x->u.c[i + 1U];                                   \
+        if (a->leaf)                                                             \
+        {                                                                        \
+            (void)memcpy(a->k + a->n, b->k, sizeof(KEY) * b->n);                 \
+            (void)memcpy(a->u.v + a->n, b->u.v, sizeof(VAL) * b->n);             \
+            a->next = b->next;                                                   \
+            a->n += b->n;                                                        \
+        }                                                                        \
+        else                                                                     \
+        {                                                                        \
+            a->k[a->n] = x->k[i];                                                \
+            (void)memcpy(a->k + a->n + 1U, b->k, sizeof(KEY) * b->n);            \
+            (void)memcpy(a->u.c + a->n + 1U, b->u.c, sizeof(b) * (b->n + 1U));   \
+            a->n += b->n + 1U;                                                   \
+        }                                                                        \
+        --x->n;                                                                  \
+        (void)memmove(x->k + i, x->k + i + 1U, sizeof(KEY) * (x->n - i));        \
+        (void)memmove(x->u.c + i + 1U, x->u.c + i + 2U, sizeof(b) * (x->n - i)); \
+        (void)kmp_free(kbtree_##NAME##_n, kb->kmp, b);                           \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    unsigned int kb_##NAME##_fill_(kbtree_##NAME##_t *kb,                        \
+                                   kbtree_##NAME##_n *x,                         \
+                                   unsigned int i)                               \
+    {                                                                            \
+        const unsigned int o = kbtree_order(KEY, VAL), h = (o - 1U) >> 1;        \
+        kbtree_##NAME##_n *c = x->u.c[i];                                        \
+        kbtree_##NAME##_n *l = i ? x->u.c[i - 1U] : NULL;                        \
+        kbtree_##NAME##_n *r = i < x->n ? x->u.c[i + 1U] : NULL;                 \
+        if (l && l->n > h)                                                       \
+        {                                                                        \
+            /* take the last one of left sibling */                              \
+            (void)memmove(c->k + 1U, c->k, sizeof(KEY) * c->n);                  \
+            if (c->leaf)                                                         \
+            {                                                                    \
+                (void)memmove(c->u.v + 1U, c->u.v, sizeof(VAL) * c->n);          \
+                c->k[0] = l->k[l->n - 1U];                                       \
+                c->u.v[0] = l->u.v[l->n - 1U];                                   \
+                x->k[i - 1U] = c->k[0];                                          \
+            }                                                                    \
+            else                                                                 \
+            {                                                                    \
+                (void)memmove(c->u.c + 1U, c->u.c, sizeof(c) * (c->n + 1U));     \
+                c->k[0] = x->k[i - 1U];                                          \
+                c->u.c[0] = l->u.c[l->n];                                        \
+                x->k[i - 1U] = l->k[l->n - 1U];                                  \
+            }                                                                    \
+            --l->n;                                                              \
+            ++c->n;                                                              \
+            return i;                                                            \
+        }                                                                        \
+        if (r && r->n > h)                                                       \
+        {                                                                        \
+            /* take the first one of right sibling */                            \
+            if (c->leaf)                                                         \
+            {                                                                    \
+                c->k[c->n] = r->k[0];                                            \
+                c->u.v[c->n] = r->u.v[0];                                        \
+                (void)memmove(r->u.v, r->u.v + 1U, sizeof(VAL) * (r->n - 1U));   \
+            }                                                                    \
+            else                                                                 \
+            {                                                                    \
+                c->k[c->n] = x->k[i];                                            \
+                c->u.c[c->n + 1U] = r->u.c[0];                                   \
+                x->k[i] = r->k[0];                                               \
+                (void)memmove(r->u.c, r->u.c + 1U, sizeof(c) * r->n);            \
+            }                                                                    \
+            (void)memmove(r->k, r->k + 1U, sizeof(KEY) * (r->n - 1U));           \
+            ++c->n;                                                              \
+            --r->n;                                                              \
+            if (c->leaf)                                                         \
+            {                                                                    \
+                x->k[i] = r->k[0];                                               \
+            }                                                                    \
+            return i;                                                            \
+        }                                                                        \
+        if (l)                                                                   \
+        {                                                                        \
+            kb_##NAME##_merge_(kb, x, i - 1U);                                   \
+            return i - 1U;                                                       \
+        }                                                                        \
+        kb_##NAME##_merge_(kb, x, i);                                            \
+        return i;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int kb_##NAME##_del(kbtree_##NAME##_t *kb,                                   \
+                        KEY key)                                                 \
+    {                                                                            \
+        const unsigned int h = (kbtree_order(KEY, VAL) - 1U) >> 1;               \
+        kbtree_##NAME##_n *p = kb->root;                                         \
+        if (!p)                                                                  \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        /* a child has more than the least keys before it is entered */          \
+        while (!p->leaf)                                                         \
+        {                                                                        \
+            unsigned int i = kb_##NAME##_child_(p, key);                         \
+            if (p->u.c[i]->n <= h)                                               \
+            {                                                                    \
+                i = kb_##NAME##_fill_(kb, p, i);                                 \
+                if (!p->n)                                                       \
+                {                                                                \
+                    /* the root is left with a child */                          \
+                    kb->root = p->u.c[0];                                        \
+                    (void)kmp_free(kbtree_##NAME##_n, kb->kmp, p);               \
+                    p = kb->root;                                                \
+                    continue;                                                    \
+                }                                                                \
+            }                                                                    \
+            p = p->u.c[i];                                                       \
+        }                                                                        \
+        unsigned int i = kb_##NAME##_pos_(p, key);                               \
+        if (i == p->n || CMP(key, p->k[i]))                                      \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        --p->n;                                                                  \
+        (void)memmove(p->k + i, p->k + i + 1U, sizeof(KEY) * (p->n - i));        \
+        (void)memmove(p->u.v + i, p->u.v + i + 1U, sizeof(VAL) * (p->n - i));    \
+        if (!--kb->n)                                                            \
+        {                                                                        \
+            (void)kmp_free(kbtree_##NAME##_n, kb->kmp, kb->root);                \
+            kb->root = NULL;                                                     \
+        }                                                                        \
+        return 0;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    int kb_##NAME##_begin(const kbtree_##NAME##_t *kb,                           \
+                          kbtree_##NAME##_i *it)                                 \
+    {                                                                            \
+        kbtree_##NAME##_n *p = kb->root;                                         \
+        it->i = 0U;                                                              \
+        if (p)                                                                   \
+        {                                                                        \
+            while (!p->leaf)                                                     \
+            {                                                                    \
+                p = p->u.c[0];                                                   \
+            }                                                                    \
+        }                                                                        \
+        it->p = p;                                                               \
+        return p ? 0 : -1;                                                       \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    int kb_##NAME##_lower(const kbtree_##NAME##_t *kb,                           \
+                          KEY key,                                               \
+                          kbtree_##NAME##_i *it)                                 \
+    {                                                                            \
+        kbtree_##NAME##_n *p = kb->root;                                         \
+        it->p = NULL;                                                            \
+        it->i = 0U;                                                              \
+        if (!p)                                                                  \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        while (!p->leaf)                                                         \
+        {                                                                        \
+            p = p->u.c[kb_##NAME##_child_(p, key)];                              \
+        }                                                                        \
+        unsigned int i = kb_##NAME##_pos_(p, key);                               \
+        if (i == p->n)                                                           \
+        {                                                                        \
+            p = p->next;                                                         \
+            i = 0U;                                                              \
+        }                                                                        \
+        it->p = p;                                                               \
+        it->i = i;                                                               \
+        return p ? 0 : -1;                                                       \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    int kb_##NAME##_next(kbtree_##NAME##_i *it)                                  \
+    {                                                                            \
+        if (++it->i == it->p->n)                                                 \
+        {                                                                        \
+            it->p = it->p->next;                                                 \
+            it->i = 0U;                                                          \
+        }                                                                        \
+        return it->p ? 0 : -1;                                                   \
+    }                                                                            \
+                                                                                 \
+    SCOPE                                                                        \
+    int kb_##NAME##_elt_(kbtree_##NAME##_e a,                                    \
+                         kbtree_##NAME##_e b)                                    \
+    {                                                                            \
+        return CMP(a.k, b.k);                                                    \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int kb_##NAME##_build(kbtree_##NAME##_t *kb,                                 \
+                          kbtree_##NAME##_e *e,                                  \
+                          size_t n)                                              \
+    {                                                                            \
+        const unsigned int o = kbtree_order(KEY, VAL), f = o - (o >> 2);         \
+        kb_##NAME##_clear(kb);                                                   \
+        if (!n)                                                                  \
+        {                                                                        \
+            return 0;                                                            \
+        }                                                                        \
+        for (size_t i = 1U; i != n; ++i)                                         \
+        {                                                                        \
+            if (CMP(e[i].k, e[i - 1U].k))                                        \
+            {                                                                    \
+                ksort_intro(kbtree_##NAME##_e, e, n, kb_##NAME##_elt_);          \
+                break;                                                           \
+            }                                                                    \
+        }                                                                        \
+        /* one of the equal keys is kept */                                      \
+        size_t u = 1U;                                                           \
+        for (size_t i = 1U; i != n; ++i)                                         \
+        {                                                                        \
+            if (CMP(e[u - 1U].k, e[i].k))                                        \
+            {                                                                    \
+                ++u;                                                             \
+            }                                                                    \
+            e[u - 1U] = e[i];                                                    \
+        }                                                                        \
+        /* leaves are filled to 3/4, and the keys are spread evenly */           \
+        size_t l = (u + f - 1U) / f;                                             \
+        kbtree_##NAME##_n **c = (kbtree_##NAME##_n **)malloc(sizeof(*c) * l);    \
+        KEY *k = (KEY *)malloc(sizeof(KEY) * l);                                 \
+        size_t s = l, j = 0U;                                                    \
+        if (!c || !k)                                                            \
+        {                                                                        \
+            goto fail;                                                           \
+        }                                                                        \
+        for (; j != l; ++j)                                                      \
+        {                                                                        \
+            kbtree_##NAME##_n *p = kb_##NAME##_node_(kb, 1U);                    \
+            if (!p)                                                              \
+            {                                                                    \
+                goto fail;                                                       \
+            }                                                                    \
+            p->n = (unsigned int)(u / l + (j < u % l ? 1U : 0U));                \
+            for (unsigned int i = 0U; i != p->n; ++i, ++e)                       \
+            {                                                                    \
+                p->k[i] = e->k;                                                  \
+                p->u.v[i] = e->v;                                                \
+            }                                                                    \
+            if (j)                                                               \
+            {                                                                    \
+                c[j - 1U]->next = p;                                             \
+            }                                                                    \
+            c[j] = p;                                                            \
+            k[j] = p->k[0];                                                      \
+        }                                                                        \
+        /* each level up has at most f + 1 children in a node */                 \
+        while (l > 1U)                                                           \
+        {                                                                        \
+            size_t m = (l + f) / (f + 1U);                                       \
+            s = 0U;                                                              \
+            for (j = 0U; j != m; ++j)                                            \
+            {                                                                    \
+                kbtree_##NAME##_n *p = kb_##NAME##_node_(kb, 0U);                \
+                if (!p)                                                          \
+                {                                                                \
+                    goto fail;                                                   \
+                }                                                                \
+                size_t t = l / m + (j < l % m ? 1U : 0U);                        \
+                KEY k0 = k[s];                                                   \
+                p->n = (unsigned int)t - 1U;                                     \
+                for (unsigned int i = 0U; i != t; ++i, ++s)                      \
+                {                                                                \
+                    p->u.c[i] = c[s];                                            \
+                    if (i)                                                       \
+                    {                                                            \
+                        p->k[i - 1U] = k[s];                                     \
+                    }                                                            \
+                }                                                                \
+                c[j] = p;                                                        \
+                k[j] = k0;                                                       \
+            }                                                                    \
+            l = m;                                                               \
+        }                                                                        \
+        kb->root = c[0];                                                         \
+        kb->n = u;                                                               \
+        free(c);                                                                 \
+        free(k);                                                                 \
+        return 0;                                                                \
+    fail:                                                                        \
+        /* the new nodes of [0, j) and the rest of a level [s, l) */             \
+        if (c)                                                                   \
+        {                                                                        \
+            for (size_t i = 0U; i != j; ++i)                                     \
+            {                                                                    \
+                kb_##NAME##_free_(kb, c[i]);                                     \
+            }                                                                    \
+            for (; s < l; ++s)                                                   \
+            {                                                                    \
+                kb_##NAME##_free_(kb, c[s]);                                     \
+            }                                                                    \
+        }                                                                        \
+        free(c);                                                                 \
+        free(k);                                                                 \
+        kb_##NAME##_clear(kb);                                                   \
+        return -1;                                                               \
+    }
+
+#ifndef kbtree_impl
+/*!
+ @brief          B+ tree function Initial Microprogram Loading
+ @details        It generates kb_##name##_init, clear, size, get, put, set,
+                 del, begin, lower, next and build.
+                 nodes are taken from the memory pool of tree, and split or
+                 merged on the way down, so put and del do not go back up.
+                 lower and begin set an iterator, next walks the linked
+                 leaves in order, kb_key and kb_val read the iterator.
+                 build replaces the tree by an array of kbtree_##name##_e,
+                 which is sorted by ksort_intro if it is not sorted, and the
+                 tree is built bottom up with leaves filled to 3/4.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of B+ tree structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kbtree_impl(scope, name, key_t, val_t, cmp) \
+    __KBTREE_IMPL(scope, name, key_t, val_t, cmp)
+#endif /* kbtree_impl */
+
+/* __KBTREE_INIT */
+#undef __KBTREE_INIT
+#define __KBTREE_INIT(NAME, KEY, VAL, CMP)                       \
+    kbtree_type(NAME, KEY, VAL);                                 \
+    __KBTREE_IMPL(__STATIC_INLINE __UNUSED, NAME, KEY, VAL, CMP)
+
+#ifndef kbtree_init
+/*!
+ @brief          B+ tree function Initial Microprogram Loading
+ @param[in]      name: identity name of B+ tree structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kbtree_init(name, key_t, val_t, cmp) \
+    __KBTREE_INIT(name, key_t, val_t, cmp)
+#endif /* kbtree_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KBTREE_H__ */
+
+/* END OF FILE */
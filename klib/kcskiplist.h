@@ -0,0 +1,586 @@
+/*!
+ @file           kcskiplist.h
+ @brief          lock-free skip list of ordered map
+ @details        The nodes are linked by compare and swap, and a deleted
+                 node is marked at bit 0 of its next pointers from the top
+                 down before it is unlinked. get and lower pass over the
+                 marked nodes without writing, so they are wait-free.
+                 Each thread works on the list by a handle, the handle has
+                 a record of kebr and memory pools. A retired node is given
+                 back to the memory pool of handle by kebr when no thread
+                 is able to read it.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KCSKIPLIST_H__
+#define __KCSKIPLIST_H__
+
+#include "klib.h"
+#include "kebr.h"
+#include "klist.h"
+#include "kskiplist.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* bit 0 of a next pointer marks the node that has it as deleted */
+#undef KCSKIPLIST_MARKED
+#define KCSKIPLIST_MARKED(p) ((uintptr_t)(p) & 1U)
+#undef KCSKIPLIST_PTR
+#define KCSKIPLIST_PTR(type, p)                 \
+    ((type *)((uintptr_t)(p) & ~(uintptr_t)1U))
+#undef KCSKIPLIST_MARK
+#define KCSKIPLIST_MARK(type, p)    \
+    ((type *)((uintptr_t)(p) | 1U))
+
+/* kcskiplist_type */
+#ifndef kcskiplist_type
+/*!
+ @brief          Register type of lock-free skip list structure
+ @param[in]      name: identity name of skip list structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+*/
+#define kcskiplist_type(name, key_t, val_t)                                        \
+    typedef struct kcskiplist_##name##_n                                           \
+    {                                                                              \
+        key_t k;                              /* key                        */     \
+        val_t v;                              /* value                      */     \
+        kebr_node_t r;                        /* link of retired node       */     \
+        unsigned int h;                       /* height of tower            */     \
+        unsigned int s;                       /* 1 inserted, 2 deleted      */     \
+        struct kcskiplist_##name##_n *next[]; /* next node, bit 0 is marked */     \
+    } kcskiplist_##name##_n;                                                       \
+    kmempool_type(kcsl_##name, kcskiplist_##name##_n);                             \
+    typedef struct kcskiplist_##name##_h                                           \
+    {                                                                              \
+        struct kcskiplist_##name##_t *kl;       /* skip list of handle         */  \
+        struct kcskiplist_##name##_h *next;     /* next handle of skip list    */  \
+        kebr_thread_t *t;                       /* record of epoch             */  \
+        int used;                               /* 1 if a thread holds it      */  \
+        long n;                                 /* nodes added minus deleted   */  \
+        uint64_t r;                             /* state of random number      */  \
+        kmp_kcsl_##name##_t kmp[KSKIPLIST_MAX]; /* memory pool of each height  */  \
+    } kcskiplist_##name##_h;                                                       \
+    typedef struct kcskiplist_##name##_t                                           \
+    {                                                                              \
+        kcskiplist_##name##_n *head[KSKIPLIST_MAX]; /* first node of each level */ \
+        kcskiplist_##name##_h *h;                   /* handles of threads       */ \
+        kebr_t d;                                   /* domain of epoch          */ \
+        unsigned int lv;                            /* number of levels in use  */ \
+    } kcskiplist_##name##_t
+#endif /* kcskiplist_type */
+
+/* kcskiplist_t */
+#ifndef kcskiplist_t
+/*!
+ @brief          typedef of lock-free skip list registration
+ @param[in]      name: identity name of skip list structure
+*/
+#define kcskiplist_t(name) kcskiplist_##name##_t
+#endif /* kcskiplist_t */
+
+/* kcskiplist_h */
+#ifndef kcskiplist_h
+/*!
+ @brief          typedef of handle of a thread on lock-free skip list
+ @param[in]      name: identity name of skip list structure
+*/
+#define kcskiplist_h(name) kcskiplist_##name##_h
+#endif /* kcskiplist_h */
+
+/* __KCSKIPLIST_IMPL */
+#undef __KCSKIPLIST_IMPL
+#define __KCSKIPLIST_IMPL(SCOPE, NAME, KEY, VAL, CMP)                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    void kcsl_##NAME##_init(kcskiplist_##NAME##_t *kl)                                                         \
+    {                                                                                                          \
+        for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)                                                     \
+        {                                                                                                      \
+            kl->head[i] = NULL;                                                                                \
+        }                                                                                                      \
+        kl->h = NULL;                                                                                          \
+        kebr_init(&kl->d);                                                                                     \
+        kl->lv = 1U;                                                                                           \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    void kcsl_##NAME##_free_(void *arg,                                                                        \
+                             kebr_node_t *r)                                                                   \
+    {                                                                                                          \
+        kcskiplist_##NAME##_h *h = (kcskiplist_##NAME##_h *)arg;                                               \
+        kcskiplist_##NAME##_n *p = kebr_entry(r, kcskiplist_##NAME##_n, r);                                    \
+        (void)kmp_free(kcskiplist_##NAME##_n, h->kmp[p->h - 1U], p);                                           \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    void kcsl_##NAME##_clear(kcskiplist_##NAME##_t *kl)                                                        \
+    {                                                                                                          \
+        /* the retired nodes go back to the memory pools of handles */                                         \
+        kebr_clear(&kl->d);                                                                                    \
+        kcskiplist_##NAME##_n *p = kl->head[0];                                                                \
+        while (p)                                                                                              \
+        {                                                                                                      \
+            kcskiplist_##NAME##_n *q = KCSKIPLIST_PTR(kcskiplist_##NAME##_n, p->next[0]);                      \
+            free(p);                                                                                           \
+            p = q;                                                                                             \
+        }                                                                                                      \
+        kcskiplist_##NAME##_h *h = kl->h;                                                                      \
+        while (h)                                                                                              \
+        {                                                                                                      \
+            kcskiplist_##NAME##_h *q = h->next;                                                                \
+            for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)                                                 \
+            {                                                                                                  \
+                kmp_clear(KSKIPLIST_NOP, h->kmp[i]);                                                           \
+            }                                                                                                  \
+            free(h);                                                                                           \
+            h = q;                                                                                             \
+        }                                                                                                      \
+        kcsl_##NAME##_init(kl);                                                                                \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    size_t kcsl_##NAME##_size(kcskiplist_##NAME##_t *kl)                                                       \
+    {                                                                                                          \
+        long n = 0;                                                                                            \
+        kcskiplist_##NAME##_h *h = __atomic_load_n(&kl->h, __ATOMIC_ACQUIRE);                                  \
+        for (; h; h = h->next)                                                                                 \
+        {                                                                                                      \
+            n += __atomic_load_n(&h->n, __ATOMIC_RELAXED);                                                     \
+        }                                                                                                      \
+        return n > 0 ? (size_t)n : 0U;                                                                         \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    kcskiplist_##NAME##_h *kcsl_##NAME##_join(kcskiplist_##NAME##_t *kl)                                       \
+    {                                                                                                          \
+        kcskiplist_##NAME##_h *h = __atomic_load_n(&kl->h, __ATOMIC_ACQUIRE);                                  \
+        for (; h; h = h->next)                                                                                 \
+        {                                                                                                      \
+            int used = 0;                                                                                      \
+            if (!__atomic_load_n(&h->used, __ATOMIC_RELAXED) &&                                                \
+                __atomic_compare_exchange_n(&h->used, &used, 1, 0,                                             \
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))                               \
+            {                                                                                                  \
+                h->t = kebr_join(&kl->d, kcsl_##NAME##_free_, h);                                              \
+                if (h->t)                                                                                      \
+                {                                                                                              \
+                    return h;                                                                                  \
+                }                                                                                              \
+                __atomic_store_n(&h->used, 0, __ATOMIC_RELEASE);                                               \
+                return NULL;                                                                                   \
+            }                                                                                                  \
+        }                                                                                                      \
+        h = (kcskiplist_##NAME##_h *)calloc(1U, sizeof(*h));                                                   \
+        if (!h)                                                                                                \
+        {                                                                                                      \
+            return NULL;                                                                                       \
+        }                                                                                                      \
+        h->t = kebr_join(&kl->d, kcsl_##NAME##_free_, h);                                                      \
+        if (!h->t)                                                                                             \
+        {                                                                                                      \
+            free(h);                                                                                           \
+            return NULL;                                                                                       \
+        }                                                                                                      \
+        for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)                                                     \
+        {                                                                                                      \
+            kmp_init(h->kmp[i]);                                                                               \
+        }                                                                                                      \
+        h->kl = kl;                                                                                            \
+        h->used = 1;                                                                                           \
+        h->r = KSKIPLIST_SEED ^ (uint64_t)(uintptr_t)h;                                                        \
+        h->next = __atomic_load_n(&kl->h, __ATOMIC_RELAXED);                                                   \
+        while (!__atomic_compare_exchange_n(&kl->h, &h->next, h, 1,                                            \
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED))                               \
+        {                                                                                                      \
+        }                                                                                                      \
+        return h;                                                                                              \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    void kcsl_##NAME##_leave(kcskiplist_##NAME##_h *h)                                                         \
+    {                                                                                                          \
+        kebr_leave(h->t);                                                                                      \
+        __atomic_store_n(&h->used, 0, __ATOMIC_RELEASE);                                                       \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    kcskiplist_##NAME##_n *kcsl_##NAME##_node_(kcskiplist_##NAME##_h *h)                                       \
+    {                                                                                                          \
+        /* xorshift64, each level up has a quarter of the nodes */                                             \
+        uint64_t r = h->r;                                                                                     \
+        r ^= r << 13;                                                                                          \
+        r ^= r >> 7;                                                                                           \
+        r ^= r << 17;                                                                                          \
+        h->r = r;                                                                                              \
+        unsigned int lv = (kctz64(r | (uint64_t)1 << (2U * KSKIPLIST_MAX - 2U)) >> 1) + 1U;                    \
+        kmp_kcsl_##NAME##_t *kmp = h->kmp + lv - 1U;                                                           \
+        kcskiplist_##NAME##_n *p;                                                                              \
+        if (kmp->n)                                                                                            \
+        {                                                                                                      \
+            p = kmp->p[--kmp->n];                                                                              \
+        }                                                                                                      \
+        else                                                                                                   \
+        {                                                                                                      \
+            p = (kcskiplist_##NAME##_n *)malloc(sizeof(*p) + sizeof(p) * lv);                                  \
+            if (!p)                                                                                            \
+            {                                                                                                  \
+                return NULL;                                                                                   \
+            }                                                                                                  \
+        }                                                                                                      \
+        ++kmp->cnt;                                                                                            \
+        p->h = lv;                                                                                             \
+        p->s = 0U;                                                                                             \
+        return p;                                                                                              \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL((1))                                                                                             \
+    SCOPE                                                                                                      \
+    int kcsl_##NAME##_find_(kcskiplist_##NAME##_t *kl,                                                         \
+                            KEY key,                                                                           \
+                            kcskiplist_##NAME##_n ***pred,                                                     \
+                            kcskiplist_##NAME##_n **succ,                                                      \
+                            unsigned int top)                                                                  \
+    {                                                                                                          \
+        /* the marked nodes on the way are unlinked */                                                         \
+        kcskiplist_##NAME##_n *p, *q, **x;                                                                     \
+    retry:                                                                                                     \
+        p = NULL;                                                                                              \
+        x = kl->head;                                                                                          \
+        for (unsigned int i = top; i--;)                                                                       \
+        {                                                                                                      \
+            p = KCSKIPLIST_PTR(kcskiplist_##NAME##_n, __atomic_load_n(x + i, __ATOMIC_ACQUIRE));               \
+            while (p)                                                                                          \
+            {                                                                                                  \
+                q = __atomic_load_n(p->next + i, __ATOMIC_ACQUIRE);                                            \
+                if (KCSKIPLIST_MARKED(q))                                                                      \
+                {                                                                                              \
+                    q = KCSKIPLIST_PTR(kcskiplist_##NAME##_n, q);                                              \
+                    if (!__atomic_compare_exchange_n(x + i, &p, q, 0,                                          \
+                                                     __ATOMIC_RELEASE, __ATOMIC_RELAXED))                      \
+                    {                                                                                          \
+                        goto retry;                                                                            \
+                    }                                                                                          \
+                    p = q;                                                                                     \
+                }                                                                                              \
+                else if (CMP(p->k, key))                                                                       \
+                {                                                                                              \
+                    x = p->next;                                                                               \
+                    p = q;                                                                                     \
+                }                                                                                              \
+                else                                                                                           \
+                {                                                                                              \
+                    break;                                                                                     \
+                }                                                                                              \
+            }                                                                                                  \
+            if (pred)                                                                                          \
+            {                                                                                                  \
+                pred[i] = x;                                                                                   \
+                succ[i] = p;                                                                                   \
+            }                                                                                                  \
+        }                                                                                                      \
+        return p && !CMP(key, p->k);                                                                           \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL_ALL                                                                                              \
+    SCOPE                                                                                                      \
+    void kcsl_##NAME##_unlink_(kcskiplist_##NAME##_t *kl,                                                      \
+                               kcskiplist_##NAME##_n *n)                                                       \
+    {                                                                                                          \
+        /* the marked node n is unlinked from all levels, the walk goes past the                               \
+           nodes of the same key, a new one may be linked in front of n */                                     \
+        kcskiplist_##NAME##_n *p, *q, **x;                                                                     \
+    retry:                                                                                                     \
+        x = kl->head;                                                                                          \
+        for (unsigned int i = __atomic_load_n(&kl->lv, __ATOMIC_ACQUIRE); i--;)                                \
+        {                                                                                                      \
+            p = KCSKIPLIST_PTR(kcskiplist_##NAME##_n, __atomic_load_n(x + i, __ATOMIC_ACQUIRE));               \
+            while (p)                                                                                          \
+            {                                                                                                  \
+                q = __atomic_load_n(p->next + i, __ATOMIC_ACQUIRE);                                            \
+                if (KCSKIPLIST_MARKED(q))                                                                      \
+                {                                                                                              \
+                    q = KCSKIPLIST_PTR(kcskiplist_##NAME##_n, q);                                              \
+                    if (!__atomic_compare_exchange_n(x + i, &p, q, 0,                                          \
+                                                     __ATOMIC_RELEASE, __ATOMIC_RELAXED))                      \
+                    {                                                                                          \
+                        goto retry;                                                                            \
+                    }                                                                                          \
+                    p = q;                                                                                     \
+                }                                                                                              \
+                else if (!CMP(n->k, p->k))                                                                     \
+                {                                                                                              \
+                    x = p->next;                                                                               \
+                    p = q;                                                                                     \
+                }                                                                                              \
+                else                                                                                           \
+                {                                                                                              \
+                    break;                                                                                     \
+                }                                                                                              \
+            }                                                                                                  \
+        }                                                                                                      \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL((1))                                                                                             \
+    SCOPE                                                                                                      \
+    kcskiplist_##NAME##_n *kcsl_##NAME##_search_(kcskiplist_##NAME##_t *kl,                                    \
+                                                 KEY key)                                                      \
+    {                                                                                                          \
+        /* the marked nodes are passed over, it does not write or retry */                                     \
+        kcskiplist_##NAME##_n *p = NULL, *q, **x = kl->head;                                                   \
+        for (unsigned int i = __atomic_load_n(&kl->lv, __ATOMIC_ACQUIRE); i--;)                                \
+        {                                                                                                      \
+            p = KCSKIPLIST_PTR(kcskiplist_##NAME##_n, __atomic_load_n(x + i, __ATOMIC_ACQUIRE));               \
+            while (p)                                                                                          \
+            {                                                                                                  \
+                q = __atomic_load_n(p->next + i, __ATOMIC_ACQUIRE);                                            \
+                if (KCSKIPLIST_MARKED(q))                                                                      \
+                {                                                                                              \
+                    p = KCSKIPLIST_PTR(kcskiplist_##NAME##_n, q);                                              \
+                }                                                                                              \
+                else if (CMP(p->k, key))                                                                       \
+                {                                                                                              \
+                    x = p->next;                                                                               \
+                    p = q;                                                                                     \
+                }                                                                                              \
+                else                                                                                           \
+                {                                                                                              \
+                    break;                                                                                     \
+                }                                                                                              \
+            }                                                                                                  \
+        }                                                                                                      \
+        return p;                                                                                              \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL((1))                                                                                             \
+    SCOPE                                                                                                      \
+    int kcsl_##NAME##_get(kcskiplist_##NAME##_h *h,                                                            \
+                          KEY key,                                                                             \
+                          VAL *val)                                                                            \
+    {                                                                                                          \
+        kebr_enter(h->t);                                                                                      \
+        kcskiplist_##NAME##_n *p = kcsl_##NAME##_search_(h->kl, key);                                          \
+        int ok = p && !CMP(key, p->k);                                                                         \
+        if (ok && val)                                                                                         \
+        {                                                                                                      \
+            *val = p->v;                                                                                       \
+        }                                                                                                      \
+        kebr_exit(h->t);                                                                                       \
+        return ok ? 0 : -1;                                                                                    \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL((1))                                                                                             \
+    SCOPE                                                                                                      \
+    int kcsl_##NAME##_lower(kcskiplist_##NAME##_h *h,                                                          \
+                            KEY key,                                                                           \
+                            KEY *k,                                                                            \
+                            VAL *v)                                                                            \
+    {                                                                                                          \
+        kebr_enter(h->t);                                                                                      \
+        kcskiplist_##NAME##_n *p = kcsl_##NAME##_search_(h->kl, key);                                          \
+        if (p)                                                                                                 \
+        {                                                                                                      \
+            if (k)                                                                                             \
+            {                                                                                                  \
+                *k = p->k;                                                                                     \
+            }                                                                                                  \
+            if (v)                                                                                             \
+            {                                                                                                  \
+                *v = p->v;                                                                                     \
+            }                                                                                                  \
+        }                                                                                                      \
+        kebr_exit(h->t);                                                                                       \
+        return p ? 0 : -1;                                                                                     \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL((1))                                                                                             \
+    SCOPE                                                                                                      \
+    int kcsl_##NAME##_add(kcskiplist_##NAME##_h *h,                                                            \
+                          KEY key,                                                                             \
+                          VAL val)                                                                             \
+    {                                                                                                          \
+        kcskiplist_##NAME##_t *kl = h->kl;                                                                     \
+        kcskiplist_##NAME##_n **pred[KSKIPLIST_MAX], *succ[KSKIPLIST_MAX], *q;                                 \
+        kcskiplist_##NAME##_n *p = kcsl_##NAME##_node_(h);                                                     \
+        if (!p)                                                                                                \
+        {                                                                                                      \
+            return -1;                                                                                         \
+        }                                                                                                      \
+        p->k = key;                                                                                            \
+        p->v = val;                                                                                            \
+        /* the levels in use are raised before the node is seen */                                             \
+        unsigned int top = __atomic_load_n(&kl->lv, __ATOMIC_RELAXED);                                         \
+        while (top < p->h && !__atomic_compare_exchange_n(&kl->lv, &top, p->h, 1,                              \
+                                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED))                 \
+        {                                                                                                      \
+        }                                                                                                      \
+        top = top > p->h ? top : p->h;                                                                         \
+        kebr_enter(h->t);                                                                                      \
+        do                                                                                                     \
+        {                                                                                                      \
+            if (kcsl_##NAME##_find_(kl, key, pred, succ, top))                                                 \
+            {                                                                                                  \
+                kebr_exit(h->t);                                                                               \
+                (void)kmp_free(kcskiplist_##NAME##_n, h->kmp[p->h - 1U], p);                                   \
+                return 0;                                                                                      \
+            }                                                                                                  \
+            for (unsigned int i = 0U; i != p->h; ++i)                                                          \
+            {                                                                                                  \
+                p->next[i] = succ[i];                                                                          \
+            }                                                                                                  \
+            q = succ[0];                                                                                       \
+        } while (!__atomic_compare_exchange_n(pred[0], &q, p, 0,                                               \
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));                            \
+        /* the node is in the list from level 0, the levels up may fail */                                     \
+        for (unsigned int i = 1U; i < p->h; ++i)                                                               \
+        {                                                                                                      \
+            for (;;)                                                                                           \
+            {                                                                                                  \
+                q = __atomic_load_n(p->next + i, __ATOMIC_ACQUIRE);                                            \
+                if (KCSKIPLIST_MARKED(q) ||                                                                    \
+                    (q != succ[i] &&                                                                           \
+                     !__atomic_compare_exchange_n(p->next + i, &q, succ[i], 0,                                 \
+                                                  __ATOMIC_RELEASE, __ATOMIC_RELAXED)))                        \
+                {                                                                                              \
+                    goto done;                                                                                 \
+                }                                                                                              \
+                q = succ[i];                                                                                   \
+                if (__atomic_compare_exchange_n(pred[i] + i, &q, p, 0,                                         \
+                                                __ATOMIC_RELEASE, __ATOMIC_RELAXED))                           \
+                {                                                                                              \
+                    break;                                                                                     \
+                }                                                                                              \
+                (void)kcsl_##NAME##_find_(kl, key, pred, succ, top);                                           \
+            }                                                                                                  \
+        }                                                                                                      \
+    done:                                                                                                      \
+        /* the last of insertion and deletion unlinks and retires the node */                                  \
+        if (__atomic_fetch_or(&p->s, 1U, __ATOMIC_ACQ_REL) & 2U)                                               \
+        {                                                                                                      \
+            kcsl_##NAME##_unlink_(kl, p);                                                                      \
+            kebr_retire(h->t, &p->r);                                                                          \
+        }                                                                                                      \
+        __atomic_store_n(&h->n, h->n + 1, __ATOMIC_RELAXED);                                                   \
+        kebr_exit(h->t);                                                                                       \
+        return 1;                                                                                              \
+    }                                                                                                          \
+                                                                                                               \
+    __NONNULL((1))                                                                                             \
+    SCOPE                                                                                                      \
+    int kcsl_##NAME##_del(kcskiplist_##NAME##_h *h,                                                            \
+                          KEY key)                                                                             \
+    {                                                                                                          \
+        kcskiplist_##NAME##_t *kl = h->kl;                                                                     \
+        kcskiplist_##NAME##_n **pred[KSKIPLIST_MAX], *succ[KSKIPLIST_MAX], *q;                                 \
+        kebr_enter(h->t);                                                                                      \
+        if (!kcsl_##NAME##_find_(kl, key, pred, succ, __atomic_load_n(&kl->lv, __ATOMIC_ACQUIRE)))             \
+        {                                                                                                      \
+            kebr_exit(h->t);                                                                                   \
+            return -1;                                                                                         \
+        }                                                                                                      \
+        kcskiplist_##NAME##_n *p = succ[0];                                                                    \
+        for (unsigned int i = p->h; --i;)                                                                      \
+        {                                                                                                      \
+            q = __atomic_load_n(p->next + i, __ATOMIC_ACQUIRE);                                                \
+            while (!KCSKIPLIST_MARKED(q) &&                                                                    \
+                   !__atomic_compare_exchange_n(p->next + i, &q, KCSKIPLIST_MARK(kcskiplist_##NAME##_n, q), 0, \
+                                                __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))                           \
+            {                                                                                                  \
+            }                                                                                                  \
+        }                                                                                                      \
+        /* the one that marks level 0 deletes the node */                                                      \
+        q = __atomic_load_n(p->next, __ATOMIC_ACQUIRE);                                                        \
+        do                                                                                                     \
+        {                                                                                                      \
+            if (KCSKIPLIST_MARKED(q))                                                                          \
+            {                                                                                                  \
+                kebr_exit(h->t);                                                                               \
+                return -1;                                                                                     \
+            }                                                                                                  \
+        } while (!__atomic_compare_exchange_n(p->next, &q, KCSKIPLIST_MARK(kcskiplist_##NAME##_n, q), 0,       \
+                                              __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));                            \
+        __atomic_store_n(&h->n, h->n - 1, __ATOMIC_RELAXED);                                                   \
+        if (__atomic_fetch_or(&p->s, 2U, __ATOMIC_ACQ_REL) & 1U)                                               \
+        {                                                                                                      \
+            kcsl_##NAME##_unlink_(kl, p);                                                                      \
+            kebr_retire(h->t, &p->r);                                                                          \
+        }                                                                                                      \
+        kebr_exit(h->t);                                                                                       \
+        return 0;                                                                                              \
+    }
+
+#ifndef kcskiplist_impl
+/*!
+ @brief          lock-free skip list function Initial Microprogram Loading
+ @details        It generates kcsl_##name##_init, clear, size, join, leave,
+                 get, lower, add and del.
+                 init and clear must not run with other functions.
+                 join returns a handle for the calling thread, NULL if out
+                 of memory, and leave gives it back to be joined again.
+                 the others take the handle, a handle is used by one thread
+                 at a time. add returns 1 if the key is added, 0 if it is
+                 in the list already, -1 if out of memory. get and lower
+                 copy the key and value of the node found and return 0,
+                 or return -1. size is exact only when nothing is running.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of skip list structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kcskiplist_impl(scope, name, key_t, val_t, cmp) \
+    __KCSKIPLIST_IMPL(scope, name, key_t, val_t, cmp)
+#endif /* kcskiplist_impl */
+
+/* __KCSKIPLIST_INIT */
+#undef __KCSKIPLIST_INIT
+#define __KCSKIPLIST_INIT(NAME, KEY, VAL, CMP)                       \
+    kcskiplist_type(NAME, KEY, VAL);                                 \
+    __KCSKIPLIST_IMPL(__STATIC_INLINE __UNUSED, NAME, KEY, VAL, CMP)
+
+#ifndef kcskiplist_init
+/*!
+ @brief          lock-free skip list function Initial Microprogram Loading
+ @param[in]      name: identity name of skip list structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kcskiplist_init(name, key_t, val_t, cmp) \
+    __KCSKIPLIST_INIT(name, key_t, val_t, cmp)
+#endif /* kcskiplist_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KCSKIPLIST_H__ */
+
+/* END OF FILE */
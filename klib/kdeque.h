@@ -0,0 +1,261 @@
+/*!
+ @file           kdeque.h
+ @brief          double-ended queue on a ring buffer
+ @details        The ring has 2^* elements and is indexed by mask. It grows
+                 to a new buffer where the elements are copied in order.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KDEQUE_H__
+#define __KDEQUE_H__
+
+#include "klib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* kdeque_type */
+#ifndef kdeque_type
+/*!
+ @brief          Register type of deque structure
+ @param[in]      name: identity name of deque structure
+ @param[in]      type: type of deque data
+*/
+#define kdeque_type(name, type)                  \
+    typedef struct kdeque_##name##_t             \
+    {                                            \
+        size_t n; /* number of elements      */  \
+        size_t m; /* size of real memory, 2^* */ \
+        type *v;  /* first address of ring   */  \
+        size_t h; /* index of the front      */  \
+    } kdeque_##name##_t
+#endif /* kdeque_type */
+
+/* kdeque_t */
+#ifndef kdeque_t
+/*!
+ @brief          typedef of deque registration
+ @param[in]      name: identity name of deque structure
+*/
+#define kdeque_t(name) kdeque_##name##_t
+#endif /* kdeque_t */
+
+/* kdq_v */
+#ifndef kdq_v
+/*!
+ @brief          element whose index from the front is i, no check
+ @param[in]      kq: deque structure
+ @param[in]      i: index of element
+*/
+#define kdq_v(kq, i)                       \
+    (kq).v[((kq).h + (i)) & ((kq).m - 1U)]
+#endif /* kdq_v */
+
+/* __KDEQUE_IMPL */
+#undef __KDEQUE_IMPL
+#define __KDEQUE_IMPL(SCOPE, NAME, TYPE)                                     \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    void kdq_##NAME##_init(kdeque_##NAME##_t *kq)                            \
+    {                                                                        \
+        kq->n = 0U;                                                          \
+        kq->m = 0U;                                                          \
+        kq->v = NULL;                                                        \
+        kq->h = 0U;                                                          \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    void kdq_##NAME##_clear(kdeque_##NAME##_t *kq)                           \
+    {                                                                        \
+        free(kq->v);                                                         \
+        kdq_##NAME##_init(kq);                                               \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    size_t kdq_##NAME##_size(const kdeque_##NAME##_t *kq)                    \
+    {                                                                        \
+        return kq->n;                                                        \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    size_t kdq_##NAME##_max(const kdeque_##NAME##_t *kq)                     \
+    {                                                                        \
+        return kq->m;                                                        \
+    }                                                                        \
+                                                                             \
+    __NONNULL((1))                                                           \
+    SCOPE                                                                    \
+    int kdq_##NAME##_reserve(kdeque_##NAME##_t *kq,                          \
+                             size_t n)                                       \
+    {                                                                        \
+        if (n <= kq->m)                                                      \
+        {                                                                    \
+            return 0;                                                        \
+        }                                                                    \
+        size_t m = n;                                                        \
+        kroundup(m);                                                         \
+        if (!m || ksize_overflow(m, sizeof(TYPE)))                           \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        TYPE *v = (TYPE *)malloc(sizeof(TYPE) * m);                          \
+        if (!v)                                                              \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        /* the two parts of ring are copied to the start */                  \
+        if (kq->n)                                                           \
+        {                                                                    \
+            size_t l = kq->m - kq->h < kq->n ? kq->m - kq->h : kq->n;        \
+            (void)memcpy(v, kq->v + kq->h, sizeof(TYPE) * l);                \
+            (void)memcpy(v + l, kq->v, sizeof(TYPE) * (kq->n - l));          \
+        }                                                                    \
+        free(kq->v);                                                         \
+        kq->v = v;                                                           \
+        kq->m = m;                                                           \
+        kq->h = 0U;                                                          \
+        return 0;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    TYPE *kdq_##NAME##_at(const kdeque_##NAME##_t *kq,                       \
+                          size_t i)                                          \
+    {                                                                        \
+        if (i >= kq->n)                                                      \
+        {                                                                    \
+            return NULL;                                                     \
+        }                                                                    \
+        return kq->v + ((kq->h + i) & (kq->m - 1U));                         \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    TYPE *kdq_##NAME##_front(const kdeque_##NAME##_t *kq)                    \
+    {                                                                        \
+        return kq->n ? kq->v + kq->h : NULL;                                 \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    TYPE *kdq_##NAME##_back(const kdeque_##NAME##_t *kq)                     \
+    {                                                                        \
+        return kq->n ? kq->v + ((kq->h + kq->n - 1U) & (kq->m - 1U)) : NULL; \
+    }                                                                        \
+                                                                             \
+    __NONNULL((1))                                                           \
+    SCOPE                                                                    \
+    int kdq_##NAME##_push(kdeque_##NAME##_t *kq,                             \
+                          TYPE x)                                            \
+    {                                                                        \
+        if (kq->n == kq->m &&                                                \
+            kdq_##NAME##_reserve(kq, kq->m ? kq->m << 1 : 8U))               \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        kq->v[(kq->h + kq->n++) & (kq->m - 1U)] = x;                         \
+        return 0;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL((1))                                                           \
+    SCOPE                                                                    \
+    int kdq_##NAME##_unshift(kdeque_##NAME##_t *kq,                          \
+                             TYPE x)                                         \
+    {                                                                        \
+        if (kq->n == kq->m &&                                                \
+            kdq_##NAME##_reserve(kq, kq->m ? kq->m << 1 : 8U))               \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        kq->h = (kq->h - 1U) & (kq->m - 1U);                                 \
+        kq->v[kq->h] = x;                                                    \
+        ++kq->n;                                                             \
+        return 0;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kdq_##NAME##_pop(TYPE *dst,                                          \
+                         kdeque_##NAME##_t *kq)                              \
+    {                                                                        \
+        if (!kq->n)                                                          \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        *dst = kq->v[(kq->h + --kq->n) & (kq->m - 1U)];                      \
+        return 0;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kdq_##NAME##_shift(TYPE *dst,                                        \
+                           kdeque_##NAME##_t *kq)                            \
+    {                                                                        \
+        if (!kq->n)                                                          \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        *dst = kq->v[kq->h];                                                 \
+        kq->h = (kq->h + 1U) & (kq->m - 1U);                                 \
+        --kq->n;                                                             \
+        return 0;                                                            \
+    }
+
+#ifndef kdeque_impl
+/*!
+ @brief          Deque function Initial Microprogram Loading
+ @details        It generates kdq_##name##_init, clear, size, max, reserve,
+                 at, front, back, push and pop at the back, unshift and
+                 shift at the front.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of deque structure
+ @param[in]      type: type of deque data
+*/
+#define kdeque_impl(scope, name, type) __KDEQUE_IMPL(scope, name, type)
+#endif /* kdeque_impl */
+
+/* __KDEQUE_INIT */
+#undef __KDEQUE_INIT
+#define __KDEQUE_INIT(NAME, TYPE)                       \
+    kdeque_type(NAME, TYPE);                            \
+    __KDEQUE_IMPL(__STATIC_INLINE __UNUSED, NAME, TYPE)
+
+#ifndef kdeque_init
+/*!
+ @brief          Deque function Initial Microprogram Loading
+ @param[in]      name: identity name of deque structure
+ @param[in]      type: type of deque data
+*/
+#define kdeque_init(name, type) __KDEQUE_INIT(name, type)
+#endif /* kdeque_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KDEQUE_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,143 @@
+/*!
+ @file           kebr.c
+ @brief          epoch based reclamation of memory for lock-free structures
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kebr.h"
+
+#include <stdlib.h>
+
+void kebr_init(kebr_t *d)
+{
+    d->e = 0U;
+    d->t = NULL;
+}
+
+/* free the retired nodes of epoch slot i */
+static void kebr_free(kebr_thread_t *t,
+                      unsigned int i)
+{
+    void (*func)(void *, kebr_node_t *) = (void (*)(void *, kebr_node_t *))t->r.func;
+    kebr_node_t *p = t->b[i];
+    t->b[i] = NULL;
+    while (p)
+    {
+        kebr_node_t *q = p->next;
+        func(t->r.arg, p);
+        p = q;
+    }
+}
+
+static int kebr_empty(const krecord_t *r)
+{
+    const kebr_thread_t *t = krecord_entry(r, const kebr_thread_t, r);
+    return !t->b[0] && !t->b[1] && !t->b[2];
+}
+
+static void kebr_free_all(krecord_t *r)
+{
+    kebr_thread_t *t = krecord_entry(r, kebr_thread_t, r);
+    for (unsigned int i = 0U; i != 3U; ++i)
+    {
+        kebr_free(t, i);
+    }
+}
+
+void kebr_clear(kebr_t *d)
+{
+    krecord_clear(&d->t, kebr_free_all);
+    kebr_init(d);
+}
+
+kebr_thread_t *kebr_join(kebr_t *d,
+                         void (*func)(void *arg, kebr_node_t *p),
+                         void *arg)
+{
+    krecord_t *r = krecord_join(&d->t, sizeof(kebr_thread_t), offsetof(kebr_thread_t, r),
+                                (void (*)(void))func, arg, kebr_empty);
+    if (!r)
+    {
+        return NULL;
+    }
+    /* others read d of the record only after it is left */
+    kebr_thread_t *t = krecord_entry(r, kebr_thread_t, r);
+    t->d = d;
+    return t;
+}
+
+void kebr_leave(kebr_thread_t *t)
+{
+    (void)kebr_advance(t);
+    krecord_leave(&t->r);
+}
+
+void kebr_reclaim(kebr_thread_t *t)
+{
+    /* the nodes retired in epoch e are not read by anyone from e + 2 */
+    unsigned long e = __atomic_load_n(&t->d->e, __ATOMIC_ACQUIRE);
+    for (unsigned int i = 0U; i != 3U; ++i)
+    {
+        if (t->b[i] && t->be[i] + 2U <= e)
+        {
+            kebr_free(t, i);
+        }
+    }
+}
+
+int kebr_advance(kebr_thread_t *t)
+{
+    /* the epoch goes on when the active records have all seen it */
+    kebr_t *d = t->d;
+    unsigned long e = __atomic_load_n(&d->e, __ATOMIC_SEQ_CST);
+    krecord_t *r = __atomic_load_n(&d->t, __ATOMIC_ACQUIRE);
+    for (; r; r = r->next)
+    {
+        kebr_thread_t *q = krecord_entry(r, kebr_thread_t, r);
+        unsigned long s = __atomic_load_n(&q->e, __ATOMIC_SEQ_CST);
+        if ((s & 1U) && s >> 1 != e)
+        {
+            break;
+        }
+    }
+    int ok = r ? -1 : 0;
+    if (!r)
+    {
+        (void)__atomic_compare_exchange_n(&d->e, &e, e + 1U, 0,
+                                          __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    }
+    kebr_reclaim(t);
+    /* the records that are left have no thread to free their nodes */
+    for (r = __atomic_load_n(&d->t, __ATOMIC_ACQUIRE); r; r = r->next)
+    {
+        if (r != &t->r && !krecord_claim(r))
+        {
+            kebr_reclaim(krecord_entry(r, kebr_thread_t, r));
+            krecord_leave(r);
+        }
+    }
+    return ok;
+}
+
+/* END OF FILE */
@@ -0,0 +1,214 @@
+/*!
+ @file           kebr.h
+ @brief          epoch based reclamation of memory for lock-free structures
+ @details        A thread joins a domain and gets a record. It reads shared
+                 nodes only between kebr_enter and kebr_exit, and a node it
+                 has unlinked is given to kebr_retire. The global epoch goes
+                 on when all the active records have seen it, and a node
+                 retired in epoch e is freed by the function of record from
+                 epoch e + 2, when no thread is able to read it.
+                 A thread that stays in a critical section holds the epoch
+                 back, and retired nodes are not freed until it exits.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KEBR_H__
+#define __KEBR_H__
+
+#include "klib.h"
+#include "krecord.h"
+
+#include <stddef.h>
+
+/* a record tries to advance the epoch once per this many retired nodes */
+#ifndef KEBR_BATCH
+#define KEBR_BATCH 64U
+#endif /* KEBR_BATCH */
+
+/* a record is on its own cache lines */
+#ifndef KEBR_LINE
+#define KEBR_LINE KRECORD_LINE
+#endif /* KEBR_LINE */
+
+/* kebr_entry */
+#ifndef kebr_entry
+/*!
+ @brief          the structure that a kebr_node_t is the member of
+ @param[in]      p: pointer of kebr_node_t
+ @param[in]      type: type of structure
+ @param[in]      member: name of kebr_node_t member in structure
+*/
+#define kebr_entry(p, type, member) \
+    ((type *)(void *)((char *)(p)-offsetof(type, member)))
+#endif /* kebr_entry */
+
+/*!
+ @brief          link of a retired node, it is a member of the node
+*/
+typedef struct kebr_node_t
+{
+    struct kebr_node_t *next; /* next retired node       */
+} kebr_node_t;
+
+typedef struct kebr_thread_t kebr_thread_t;
+
+/*!
+ @brief          domain of epoch
+*/
+typedef struct kebr_t
+{
+    unsigned long e; /* global epoch            */
+    krecord_t *t;    /* records of threads      */
+} kebr_t;
+
+/*!
+ @brief          record of a thread in domain
+*/
+struct kebr_thread_t
+{
+    krecord_t r;         /* record of list of domain   */
+    unsigned long e;     /* epoch << 1 | 1 when active */
+    kebr_t *d;           /* domain of record           */
+    size_t c;            /* count of retired nodes     */
+    unsigned long be[3]; /* epoch of retired nodes     */
+    kebr_node_t *b[3];   /* retired nodes of epoch     */
+};
+
+__BEGIN_DECLS
+
+/*!
+ @brief          initialize a domain of epoch
+ @param[in,out]  d: domain of epoch
+*/
+extern void kebr_init(kebr_t *d)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free all the retired nodes and the records of domain
+ @details        no thread is in the domain when it is called.
+ @param[in,out]  d: domain of epoch
+*/
+extern void kebr_clear(kebr_t *d)
+    __NONNULL_ALL;
+
+/*!
+ @brief          join a domain of epoch
+ @details        the record is taken as krecord_join does.
+ @param[in,out]  d: domain of epoch
+ @param[in]      func: function that frees a retired node
+  @arg           arg: argument of func
+  @arg           p: link of the retired node
+ @param[in]      arg: argument of func
+ @return         record of the calling thread
+  @retval        NULL out of memory
+*/
+extern kebr_thread_t *kebr_join(kebr_t *d,
+                                void (*func)(void *arg, kebr_node_t *p),
+                                void *arg)
+    __NONNULL((1, 2)) __RESULT_USE_CHECK;
+
+/*!
+ @brief          leave a domain of epoch, the record is joined again later
+ @param[in,out]  t: record of the calling thread
+*/
+extern void kebr_leave(kebr_thread_t *t)
+    __NONNULL_ALL;
+
+/*!
+ @brief          advance the epoch and free the retired nodes that are safe
+ @details        it frees the safe nodes of the records that are left too.
+ @param[in,out]  t: record of the calling thread
+ @return         the epoch is advanced or not
+  @retval        0 the epoch is advanced
+  @retval        -1 an active thread has not seen the epoch
+*/
+extern int kebr_advance(kebr_thread_t *t)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free the retired nodes of the record that are safe
+ @param[in,out]  t: record of a thread
+*/
+extern void kebr_reclaim(kebr_thread_t *t)
+    __NONNULL_ALL;
+
+__END_DECLS
+
+__NONNULL_ALL
+__STATIC_INLINE
+/*!
+ @brief          enter a critical section, the shared nodes are read in it
+ @details        it is not nested.
+ @param[in,out]  t: record of the calling thread
+*/
+void kebr_enter(kebr_thread_t *t)
+{
+    /* the epoch is seen by advance before any node is read */
+    unsigned long e = __atomic_load_n(&t->d->e, __ATOMIC_RELAXED);
+    (void)__atomic_exchange_n(&t->e, e << 1 | 1U, __ATOMIC_SEQ_CST);
+}
+
+__NONNULL_ALL
+__STATIC_INLINE
+/*!
+ @brief          exit a critical section
+ @param[in,out]  t: record of the calling thread
+*/
+void kebr_exit(kebr_thread_t *t)
+{
+    __atomic_store_n(&t->e, 0U, __ATOMIC_RELEASE);
+}
+
+__NONNULL_ALL
+__STATIC_INLINE
+/*!
+ @brief          retire a node that is unlinked from the shared structure
+ @details        it is called in or out of a critical section.
+ @param[in,out]  t: record of the calling thread
+ @param[in]      p: link of the node
+*/
+void kebr_retire(kebr_thread_t *t,
+                 kebr_node_t *p)
+{
+    unsigned long e = __atomic_load_n(&t->d->e, __ATOMIC_SEQ_CST);
+    unsigned int i = (unsigned int)(e % 3U);
+    if (t->b[i] && t->be[i] != e)
+    {
+        /* it is of epoch e - 3 or older */
+        kebr_reclaim(t);
+    }
+    p->next = t->b[i];
+    t->b[i] = p;
+    t->be[i] = e;
+    if (++t->c % KEBR_BATCH == 0U)
+    {
+        (void)kebr_advance(t);
+    }
+}
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KEBR_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,430 @@
+/*!
+ @file           kflatmap.h
+ @brief          sorted flat map on parallel vectors
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KFLATMAP_H__
+#define __KFLATMAP_H__
+
+#include "klib.h"
+#include "ksort.h"
+#include "kvec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* least length of unsorted tail before it is merged */
+#ifndef KFM_TAIL
+#define KFM_TAIL 32U
+#endif /* KFM_TAIL */
+
+/* kflatmap_type */
+#ifndef kflatmap_type
+/*!
+ @brief          Register type of flat map structure
+ @details        keys and values are kept in two parallel vectors, the keys
+                 in [0, s) are sorted and the rest is an unsorted tail.
+ @param[in]      name: identity name of flat map structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+*/
+#define kflatmap_type(name, key_t, val_t)                      \
+    kvec_type(kfm_##name##_k, key_t);                          \
+    kvec_type(kfm_##name##_v, val_t);                          \
+    typedef struct kflatmap_##name##_e                         \
+    {                                                          \
+        key_t k;  /* key                    */                 \
+        val_t v;  /* value                  */                 \
+        size_t i; /* order of insertion     */                 \
+    } kflatmap_##name##_e;                                     \
+    typedef struct kflatmap_##name##_t                         \
+    {                                                          \
+        kvec_t(kfm_##name##_k) k; /* keys, sorted in [0, s) */ \
+        kvec_t(kfm_##name##_v) v; /* values of keys         */ \
+        size_t s;                 /* length of sorted keys  */ \
+    } kflatmap_##name##_t
+#endif /* kflatmap_type */
+
+/* kflatmap_t */
+#ifndef kflatmap_t
+/*!
+ @brief          typedef of flat map registration
+ @param[in]      name: identity name of flat map structure
+*/
+#define kflatmap_t(name) kflatmap_##name##_t
+#endif /* kflatmap_t */
+
+/* __KFLATMAP_IMPL */
+#undef __KFLATMAP_IMPL
+#define __KFLATMAP_IMPL(SCOPE, NAME, KEY, VAL, CMP)                              \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void kfm_##NAME##_init(kflatmap_##NAME##_t *kf)                              \
+    {                                                                            \
+        kf->k.n = kf->k.m = 0U;                                                  \
+        kf->k.v = NULL;                                                          \
+        kf->v.n = kf->v.m = 0U;                                                  \
+        kf->v.v = NULL;                                                          \
+        kf->s = 0U;                                                              \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void kfm_##NAME##_clear(kflatmap_##NAME##_t *kf)                             \
+    {                                                                            \
+        free(kf->k.v);                                                           \
+        free(kf->v.v);                                                           \
+        kfm_##NAME##_init(kf);                                                   \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    size_t kfm_##NAME##_size(const kflatmap_##NAME##_t *kf)                      \
+    {                                                                            \
+        return kf->k.n;                                                          \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    size_t kfm_##NAME##_lower(const kflatmap_##NAME##_t *kf,                     \
+                              KEY key)                                           \
+    {                                                                            \
+        KEY const *p = kf->k.v;                                                  \
+        size_t n = kf->s;                                                        \
+        if (!n)                                                                  \
+        {                                                                        \
+            return 0U;                                                           \
+        }                                                                        \
+        /* branchless, the step is taken by a conditional move */                \
+        while (n > 1U)                                                           \
+        {                                                                        \
+            size_t h = n >> 1;                                                   \
+            /* both of the next probes, so misses of cache overlap */            \
+            kprefetch(p + ((n - h) >> 1));                                       \
+            kprefetch(p + h + ((n - h) >> 1));                                   \
+            p = CMP(p[h], key) ? p + h : p;                                      \
+            n -= h;                                                              \
+        }                                                                        \
+        return (size_t)(p - kf->k.v) + (CMP(*p, key) ? 1U : 0U);                 \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    size_t kfm_##NAME##_find(const kflatmap_##NAME##_t *kf,                      \
+                             KEY key)                                            \
+    {                                                                            \
+        size_t i = kfm_##NAME##_lower(kf, key);                                  \
+        if (i != kf->s && !CMP(key, kf->k.v[i]))                                 \
+        {                                                                        \
+            return i;                                                            \
+        }                                                                        \
+        for (i = kf->s; i != kf->k.n; ++i)                                       \
+        {                                                                        \
+            if (!CMP(kf->k.v[i], key) && !CMP(key, kf->k.v[i]))                  \
+            {                                                                    \
+                return i;                                                        \
+            }                                                                    \
+        }                                                                        \
+        return kf->k.n;                                                          \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    VAL *kfm_##NAME##_get(const kflatmap_##NAME##_t *kf,                         \
+                          KEY key)                                               \
+    {                                                                            \
+        size_t i = kfm_##NAME##_find(kf, key);                                   \
+        return i != kf->k.n ? kf->v.v + i : NULL;                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int kfm_##NAME##_reserve(kflatmap_##NAME##_t *kf,                            \
+                             size_t n)                                           \
+    {                                                                            \
+        if (ksize_overflow(n, sizeof(KEY)) || ksize_overflow(n, sizeof(VAL)))    \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        if (kf->k.m < n)                                                         \
+        {                                                                        \
+            KEY *k = (KEY *)realloc(kf->k.v, sizeof(KEY) * n);                   \
+            if (!k)                                                              \
+            {                                                                    \
+                return -1;                                                       \
+            }                                                                    \
+            kf->k.v = k;                                                         \
+            kf->k.m = n;                                                         \
+        }                                                                        \
+        if (kf->v.m < n)                                                         \
+        {                                                                        \
+            VAL *v = (VAL *)realloc(kf->v.v, sizeof(VAL) * n);                   \
+            if (!v)                                                              \
+            {                                                                    \
+                return -1;                                                       \
+            }                                                                    \
+            kf->v.v = v;                                                         \
+            kf->v.m = n;                                                         \
+        }                                                                        \
+        return 0;                                                                \
+    }                                                                            \
+                                                                                 \
+    SCOPE                                                                        \
+    int kfm_##NAME##_lt_(kflatmap_##NAME##_e a,                                  \
+                         kflatmap_##NAME##_e b)                                  \
+    {                                                                            \
+        /* the later one of equal keys goes first */                             \
+        return CMP(a.k, b.k) || (!CMP(b.k, a.k) && a.i > b.i);                   \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    int kfm_##NAME##_flush(kflatmap_##NAME##_t *kf)                              \
+    {                                                                            \
+        size_t t = kf->k.n - kf->s;                                              \
+        if (!t)                                                                  \
+        {                                                                        \
+            return 0;                                                            \
+        }                                                                        \
+        if (ksize_overflow(t, sizeof(kflatmap_##NAME##_e) << 1))                 \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        kflatmap_##NAME##_e *e = (kflatmap_##NAME##_e *)                         \
+            malloc(sizeof(kflatmap_##NAME##_e) * (t << 1));                      \
+        if (!e)                                                                  \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        for (size_t j = 0U; j != t; ++j)                                         \
+        {                                                                        \
+            e[j].k = kf->k.v[kf->s + j];                                         \
+            e[j].v = kf->v.v[kf->s + j];                                         \
+            e[j].i = j;                                                          \
+        }                                                                        \
+        ksort_merge(kflatmap_##NAME##_e, e, t, kfm_##NAME##_lt_, e + t);         \
+        /* keep the last value of a key, set the keys that are sorted already */ \
+        size_t u = 0U;                                                           \
+        for (size_t j = 0U; j != t; ++j)                                         \
+        {                                                                        \
+            if (j && !CMP(e[j - 1U].k, e[j].k))                                  \
+            {                                                                    \
+                continue;                                                        \
+            }                                                                    \
+            size_t i = kfm_##NAME##_lower(kf, e[j].k);                           \
+            if (i != kf->s && !CMP(e[j].k, kf->k.v[i]))                          \
+            {                                                                    \
+                kf->v.v[i] = e[j].v;                                             \
+                continue;                                                        \
+            }                                                                    \
+            e[u++] = e[j];                                                       \
+        }                                                                        \
+        /* merge from the back, the rest keys are not in the sorted ones */      \
+        size_t i = kf->s, o = kf->s + u;                                         \
+        kf->v.n = kf->k.n = o;                                                   \
+        while (u)                                                                \
+        {                                                                        \
+            if (i && CMP(e[u - 1U].k, kf->k.v[i - 1U]))                          \
+            {                                                                    \
+                --i;                                                             \
+                --o;                                                             \
+                kf->k.v[o] = kf->k.v[i];                                         \
+                kf->v.v[o] = kf->v.v[i];                                         \
+            }                                                                    \
+            else                                                                 \
+            {                                                                    \
+                --u;                                                             \
+                --o;                                                             \
+                kf->k.v[o] = e[u].k;                                             \
+                kf->v.v[o] = e[u].v;                                             \
+            }                                                                    \
+        }                                                                        \
+        free(e);                                                                 \
+        kf->s = kf->k.n;                                                         \
+        return 0;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int kfm_##NAME##_insert(kflatmap_##NAME##_t *kf,                             \
+                            KEY const *k,                                        \
+                            VAL const *v,                                        \
+                            size_t n)                                            \
+    {                                                                            \
+        if (!n)                                                                  \
+        {                                                                        \
+            return 0;                                                            \
+        }                                                                        \
+        if (n > ~(size_t)0 - kf->k.n ||                                          \
+            kfm_##NAME##_reserve(kf, kf->k.n + n))                               \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        (void)memcpy(kf->k.v + kf->k.n, k, sizeof(KEY) * n);                     \
+        (void)memcpy(kf->v.v + kf->k.n, v, sizeof(VAL) * n);                     \
+        kf->v.n = kf->k.n += n;                                                  \
+        if (kfm_##NAME##_flush(kf))                                              \
+        {                                                                        \
+            kf->v.n = kf->k.n -= n;                                              \
+            return -1;                                                           \
+        }                                                                        \
+        return 0;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    VAL *kfm_##NAME##_put(kflatmap_##NAME##_t *kf,                               \
+                          KEY key,                                               \
+                          int *absent)                                           \
+    {                                                                            \
+        size_t i = kfm_##NAME##_find(kf, key);                                   \
+        if (i != kf->k.n)                                                        \
+        {                                                                        \
+            if (absent)                                                          \
+            {                                                                    \
+                *absent = 0;                                                     \
+            }                                                                    \
+            return kf->v.v + i;                                                  \
+        }                                                                        \
+        /* the tail is at most about the square root of sorted keys */           \
+        size_t t = kf->k.n - kf->s, l = KFM_TAIL;                                \
+        while (l <= t && l * l < kf->s)                                          \
+        {                                                                        \
+            l <<= 1;                                                             \
+        }                                                                        \
+        if (t >= l && kfm_##NAME##_flush(kf))                                    \
+        {                                                                        \
+            return NULL;                                                         \
+        }                                                                        \
+        if (kf->k.n == kf->k.m || kf->k.n == kf->v.m)                            \
+        {                                                                        \
+            size_t m = kf->k.n < KFM_TAIL ? KFM_TAIL : kf->k.n << 1;             \
+            if (m < kf->k.n || kfm_##NAME##_reserve(kf, m))                      \
+            {                                                                    \
+                return NULL;                                                     \
+            }                                                                    \
+        }                                                                        \
+        if (absent)                                                              \
+        {                                                                        \
+            *absent = 1;                                                         \
+        }                                                                        \
+        i = kf->k.n++;                                                           \
+        kf->v.n = kf->k.n;                                                       \
+        kf->k.v[i] = key;                                                        \
+        return kf->v.v + i;                                                      \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int kfm_##NAME##_set(kflatmap_##NAME##_t *kf,                                \
+                         KEY key,                                                \
+                         VAL val)                                                \
+    {                                                                            \
+        int absent;                                                              \
+        VAL *v = kfm_##NAME##_put(kf, key, &absent);                             \
+        if (!v)                                                                  \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        *v = val;                                                                \
+        return absent;                                                           \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int kfm_##NAME##_del(kflatmap_##NAME##_t *kf,                                \
+                         KEY key)                                                \
+    {                                                                            \
+        size_t i = kfm_##NAME##_find(kf, key);                                   \
+        size_t n = kf->k.n;                                                      \
+        if (i == n)                                                              \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        if (i < kf->s)                                                           \
+        {                                                                        \
+            (void)memmove(kf->k.v + i, kf->k.v + i + 1U,                         \
+                          sizeof(KEY) * (n - i - 1U));                           \
+            (void)memmove(kf->v.v + i, kf->v.v + i + 1U,                         \
+                          sizeof(VAL) * (n - i - 1U));                           \
+            --kf->s;                                                             \
+        }                                                                        \
+        else                                                                     \
+        {                                                                        \
+            kf->k.v[i] = kf->k.v[n - 1U];                                        \
+            kf->v.v[i] = kf->v.v[n - 1U];                                        \
+        }                                                                        \
+        kf->v.n = kf->k.n = n - 1U;                                              \
+        return 0;                                                                \
+    }
+
+#ifndef kflatmap_impl
+/*!
+ @brief          Flat map function Initial Microprogram Loading
+ @details        It generates kfm_##name##_init, clear, size, lower, find,
+                 get, put, set, insert, del, reserve and flush.
+                 new keys of put are appended to an unsorted tail. when the
+                 tail reaches KFM_TAIL or the square root of sorted keys, it
+                 is sorted by ksort_merge and merged into the sorted keys.
+                 insert appends a batch of keys and values, and merges them
+                 at once in O(n log n), the last value of a key is kept.
+                 lower is the branchless lower bound in the sorted keys,
+                 after flush all keys are sorted in kf->k.v.
+                 put returns the address of value, *absent is 1 if the key
+                 is new, its value must be set then.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of flat map structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kflatmap_impl(scope, name, key_t, val_t, cmp) \
+    __KFLATMAP_IMPL(scope, name, key_t, val_t, cmp)
+#endif /* kflatmap_impl */
+
+/* __KFLATMAP_INIT */
+#undef __KFLATMAP_INIT
+#define __KFLATMAP_INIT(NAME, KEY, VAL, CMP)                       \
+    kflatmap_type(NAME, KEY, VAL);                                 \
+    __KFLATMAP_IMPL(__STATIC_INLINE __UNUSED, NAME, KEY, VAL, CMP)
+
+#ifndef kflatmap_init
+/*!
+ @brief          Flat map function Initial Microprogram Loading
+ @param[in]      name: identity name of flat map structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kflatmap_init(name, key_t, val_t, cmp) \
+    __KFLATMAP_INIT(name, key_t, val_t, cmp)
+#endif /* kflatmap_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KFLATMAP_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,448 @@
+/*!
+ @file           khash.h
+ @brief          open addressing hash map, Swiss table
+ @details        The slots are in groups of 16. Each slot has a control byte,
+                 empty, deleted, or the low 7 bits of the hash of its key. A
+                 lookup goes to the group chosen by the high bits of the hash
+                 and compares 16 control bytes at once, SSE2 if it is there.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KHASH_H__
+#define __KHASH_H__
+
+#include "klib.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined __SSE2__ && !defined KH_NO_SSE2
+#include <emmintrin.h>
+#endif /* __SSE2__ */
+
+/* control byte of empty slot */
+#undef KH_EMPTY
+#define KH_EMPTY 0x80U
+/* control byte of deleted slot */
+#undef KH_DELETED
+#define KH_DELETED 0xFEU
+
+/* mask of the slots in group g whose control byte is h */
+__STATIC_INLINE
+unsigned int kh_match(const uint8_t *g, uint8_t h)
+{
+#if defined __SSE2__ && !defined KH_NO_SSE2
+    __m128i x = _mm_loadu_si128((const __m128i *)(const void *)g);
+    x = _mm_cmpeq_epi8(x, _mm_set1_epi8((char)h));
+    return (unsigned int)_mm_movemask_epi8(x);
+#else
+    unsigned int b = 0U;
+    for (unsigned int i = 0U; i != 16U; ++i)
+    {
+        b |= (unsigned int)(g[i] == h) << i;
+    }
+    return b;
+#endif /* __SSE2__ */
+}
+
+/* mask of the empty slots in group g */
+__STATIC_INLINE
+unsigned int kh_match_empty(const uint8_t *g)
+{
+    return kh_match(g, (uint8_t)KH_EMPTY);
+}
+
+/* mask of the empty or deleted slots in group g */
+__STATIC_INLINE
+unsigned int kh_match_free(const uint8_t *g)
+{
+#if defined __SSE2__ && !defined KH_NO_SSE2
+    __m128i x = _mm_loadu_si128((const __m128i *)(const void *)g);
+    return (unsigned int)_mm_movemask_epi8(x);
+#else
+    unsigned int b = 0U;
+    for (unsigned int i = 0U; i != 16U; ++i)
+    {
+        b |= (unsigned int)(g[i] >> 7) << i;
+    }
+    return b;
+#endif /* __SSE2__ */
+}
+
+/* hash of 64 bits integer, the finalizer of MurmurHash3 */
+__STATIC_INLINE
+uint64_t kh_hash_u64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDU;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53U;
+    x ^= x >> 33;
+    return x;
+}
+
+/* hash of string, FNV-1a */
+__STATIC_INLINE
+uint64_t kh_hash_str(const char *s)
+{
+    uint64_t h = 0xCBF29CE484222325U;
+    for (; *s; ++s)
+    {
+        h ^= (uint8_t)*s;
+        h *= 0x100000001B3U;
+    }
+    return h;
+}
+
+#ifndef kh_eq
+#define kh_eq(a, b) ((a) == (b))
+#endif /* kh_eq */
+#ifndef kh_str_eq
+#define kh_str_eq(a, b) (strcmp(a, b) == 0)
+#endif /* kh_str_eq */
+
+/* khash_type */
+#ifndef khash_type
+/*!
+ @brief          Register type of hash map structure
+ @param[in]      name: identity name of hash map structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+*/
+#define khash_type(name, key_t, val_t)                  \
+    typedef struct khash_##name##_t                     \
+    {                                                   \
+        size_t n;   /* number of elements            */ \
+        size_t m;   /* number of slots, 16 * 2^*     */ \
+        size_t g;   /* empty slots left to be filled */ \
+        uint8_t *c; /* control bytes                 */ \
+        key_t *k;   /* keys                          */ \
+        val_t *v;   /* values                        */ \
+    } khash_##name##_t
+#endif /* khash_type */
+
+/* khash_t */
+#ifndef khash_t
+/*!
+ @brief          typedef of hash map registration
+ @param[in]      name: identity name of hash map structure
+*/
+#define khash_t(name) khash_##name##_t
+#endif /* khash_t */
+
+/* __KHASH_IMPL */
+#undef __KHASH_IMPL
+#define __KHASH_IMPL(SCOPE, NAME, KEY, VAL, HASH, EQ)                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kh_##NAME##_init(khash_##NAME##_t *kh)                               \
+    {                                                                         \
+        kh->n = 0U;                                                           \
+        kh->m = 0U;                                                           \
+        kh->g = 0U;                                                           \
+        kh->c = NULL;                                                         \
+        kh->k = NULL;                                                         \
+        kh->v = NULL;                                                         \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kh_##NAME##_clear(khash_##NAME##_t *kh)                              \
+    {                                                                         \
+        free(kh->c);                                                          \
+        free(kh->k);                                                          \
+        free(kh->v);                                                          \
+        kh_##NAME##_init(kh);                                                 \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    size_t kh_##NAME##_size(const khash_##NAME##_t *kh)                       \
+    {                                                                         \
+        return kh->n;                                                         \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    size_t kh_##NAME##_find(const khash_##NAME##_t *kh,                       \
+                            KEY key)                                          \
+    {                                                                         \
+        if (!kh->n)                                                           \
+        {                                                                     \
+            return kh->m;                                                     \
+        }                                                                     \
+        uint64_t h = (uint64_t)(HASH(key));                                   \
+        size_t mask = (kh->m >> 4) - 1U;                                      \
+        size_t i = (size_t)(h >> 7) & mask;                                   \
+        for (size_t s = 0U; s <= mask; i = (i + ++s) & mask)                  \
+        {                                                                     \
+            const uint8_t *g = kh->c + (i << 4);                              \
+            unsigned int b = kh_match(g, (uint8_t)(h & 0x7FU));               \
+            for (; b; b &= b - 1U)                                            \
+            {                                                                 \
+                size_t j = (i << 4) + kctz64(b);                              \
+                if (EQ(kh->k[j], key))                                        \
+                {                                                             \
+                    return j;                                                 \
+                }                                                             \
+            }                                                                 \
+            if (kh_match_empty(g))                                            \
+            {                                                                 \
+                break;                                                        \
+            }                                                                 \
+        }                                                                     \
+        return kh->m;                                                         \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    VAL *kh_##NAME##_get(const khash_##NAME##_t *kh,                          \
+                         KEY key)                                             \
+    {                                                                         \
+        size_t i = kh_##NAME##_find(kh, key);                                 \
+        return i != kh->m ? kh->v + i : NULL;                                 \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    size_t kh_##NAME##_slot_(const khash_##NAME##_t *kh,                      \
+                             uint64_t h)                                      \
+    {                                                                         \
+        size_t mask = (kh->m >> 4) - 1U;                                      \
+        size_t i = (size_t)(h >> 7) & mask;                                   \
+        for (size_t s = 0U;; i = (i + ++s) & mask)                            \
+        {                                                                     \
+            unsigned int b = kh_match_free(kh->c + (i << 4));                 \
+            if (b)                                                            \
+            {                                                                 \
+                return (i << 4) + kctz64(b);                                  \
+            }                                                                 \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    int kh_##NAME##_resize_(khash_##NAME##_t *kh,                             \
+                            size_t m)                                         \
+    {                                                                         \
+        if (ksize_overflow(m, sizeof(KEY)) || ksize_overflow(m, sizeof(VAL))) \
+        {                                                                     \
+            return -1;                                                        \
+        }                                                                     \
+        khash_##NAME##_t t;                                                   \
+        t.n = kh->n;                                                          \
+        t.m = m;                                                              \
+        t.g = m - (m >> 3) - kh->n;                                           \
+        t.c = (uint8_t *)malloc(m);                                           \
+        t.k = (KEY *)malloc(sizeof(KEY) * m);                                 \
+        t.v = (VAL *)malloc(sizeof(VAL) * m);                                 \
+        if (!t.c || !t.k || !t.v)                                             \
+        {                                                                     \
+            free(t.c);                                                        \
+            free(t.k);                                                        \
+            free(t.v);                                                        \
+            return -1;                                                        \
+        }                                                                     \
+        (void)memset(t.c, KH_EMPTY, m);                                       \
+        for (size_t i = 0U; i != kh->m; ++i)                                  \
+        {                                                                     \
+            if (!(kh->c[i] & 0x80U))                                          \
+            {                                                                 \
+                uint64_t h = (uint64_t)(HASH(kh->k[i]));                      \
+                size_t j = kh_##NAME##_slot_(&t, h);                          \
+                t.c[j] = (uint8_t)(h & 0x7FU);                                \
+                t.k[j] = kh->k[i];                                            \
+                t.v[j] = kh->v[i];                                            \
+            }                                                                 \
+        }                                                                     \
+        free(kh->c);                                                          \
+        free(kh->k);                                                          \
+        free(kh->v);                                                          \
+        *kh = t;                                                              \
+        return 0;                                                             \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    int kh_##NAME##_reserve(khash_##NAME##_t *kh,                             \
+                            size_t n)                                         \
+    {                                                                         \
+        n = n < kh->n ? kh->n : n;                                            \
+        if (kh->m && kh->g >= n - kh->n)                                      \
+        {                                                                     \
+            return 0;                                                         \
+        }                                                                     \
+        /* at most 7/8 of slots are used */                                   \
+        size_t m = n + n / 7U + 1U;                                           \
+        m = m < 16U ? 16U : m;                                                \
+        kroundup(m);                                                          \
+        if (!m)                                                               \
+        {                                                                     \
+            return -1;                                                        \
+        }                                                                     \
+        return kh_##NAME##_resize_(kh, m);                                    \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    int kh_##NAME##_rehash(khash_##NAME##_t *kh)                              \
+    {                                                                         \
+        return kh->m ? kh_##NAME##_resize_(kh, kh->m) : 0;                    \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    VAL *kh_##NAME##_put(khash_##NAME##_t *kh,                                \
+                         KEY key,                                             \
+                         int *absent)                                         \
+    {                                                                         \
+        size_t i = kh_##NAME##_find(kh, key);                                 \
+        if (i != kh->m)                                                       \
+        {                                                                     \
+            *absent = 0;                                                      \
+            return kh->v + i;                                                 \
+        }                                                                     \
+        if (!kh->g)                                                           \
+        {                                                                     \
+            /* drop the tombstones if there are many, otherwise grow */       \
+            size_t m = kh->m ? kh->m : 16U;                                   \
+            if (kh->n >= (m >> 2) + (m >> 3) && kh->m)                        \
+            {                                                                 \
+                m <<= 1;                                                      \
+            }                                                                 \
+            if (!m || kh_##NAME##_resize_(kh, m))                             \
+            {                                                                 \
+                return NULL;                                                  \
+            }                                                                 \
+        }                                                                     \
+        uint64_t h = (uint64_t)(HASH(key));                                   \
+        i = kh_##NAME##_slot_(kh, h);                                         \
+        kh->g -= kh->c[i] == KH_EMPTY;                                        \
+        kh->c[i] = (uint8_t)(h & 0x7FU);                                      \
+        kh->k[i] = key;                                                       \
+        ++kh->n;                                                              \
+        *absent = 1;                                                          \
+        return kh->v + i;                                                     \
+    }                                                                         \
+                                                                              \
+    __NONNULL((1))                                                            \
+    SCOPE                                                                     \
+    int kh_##NAME##_set(khash_##NAME##_t *kh,                                 \
+                        KEY key,                                              \
+                        VAL val)                                              \
+    {                                                                         \
+        int absent;                                                           \
+        VAL *v = kh_##NAME##_put(kh, key, &absent);                           \
+        if (!v)                                                               \
+        {                                                                     \
+            return -1;                                                        \
+        }                                                                     \
+        *v = val;                                                             \
+        return absent;                                                        \
+    }                                                                         \
+                                                                              \
+    __NONNULL((1))                                                            \
+    SCOPE                                                                     \
+    int kh_##NAME##_del(khash_##NAME##_t *kh,                                 \
+                        KEY key)                                              \
+    {                                                                         \
+        size_t i = kh_##NAME##_find(kh, key);                                 \
+        if (i == kh->m)                                                       \
+        {                                                                     \
+            return -1;                                                        \
+        }                                                                     \
+        /* lookups stop at a group with an empty slot, so no tombstone */     \
+        if (kh_match_empty(kh->c + (i & ~(size_t)15U)))                       \
+        {                                                                     \
+            kh->c[i] = KH_EMPTY;                                              \
+            ++kh->g;                                                          \
+        }                                                                     \
+        else                                                                  \
+        {                                                                     \
+            kh->c[i] = KH_DELETED;                                            \
+        }                                                                     \
+        --kh->n;                                                              \
+        return 0;                                                             \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    int kh_##NAME##_next(const khash_##NAME##_t *kh,                          \
+                         size_t *i)                                           \
+    {                                                                         \
+        for (; *i < kh->m; ++*i)                                              \
+        {                                                                     \
+            if (!(kh->c[*i] & 0x80U))                                         \
+            {                                                                 \
+                return 0;                                                     \
+            }                                                                 \
+        }                                                                     \
+        return -1;                                                            \
+    }
+
+#ifndef khash_impl
+/*!
+ @brief          Hash map function Initial Microprogram Loading
+ @details        It generates kh_##name##_init, clear, size, find, get, put,
+                 set, del, reserve, rehash and next.
+                 put returns the address of value, *absent is 1 if the key
+                 is new, its value must be set then. del leaves no tombstone
+                 when the group of key has an empty slot.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of hash map structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      hash: function of hash, hash(key) of 64 bits
+ @param[in]      eq: function of equal, eq(a, b)
+*/
+#define khash_impl(scope, name, key_t, val_t, hash, eq) \
+    __KHASH_IMPL(scope, name, key_t, val_t, hash, eq)
+#endif /* khash_impl */
+
+/* __KHASH_INIT */
+#undef __KHASH_INIT
+#define __KHASH_INIT(NAME, KEY, VAL, HASH, EQ)                       \
+    khash_type(NAME, KEY, VAL);                                      \
+    __KHASH_IMPL(__STATIC_INLINE __UNUSED, NAME, KEY, VAL, HASH, EQ)
+
+#ifndef khash_init
+/*!
+ @brief          Hash map function Initial Microprogram Loading
+ @param[in]      name: identity name of hash map structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      hash: function of hash, hash(key) of 64 bits
+ @param[in]      eq: function of equal, eq(a, b)
+*/
+#define khash_init(name, key_t, val_t, hash, eq) \
+    __KHASH_INIT(name, key_t, val_t, hash, eq)
+#endif /* khash_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KHASH_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,321 @@
+/*!
+ @file           khashfn.c
+ @brief          fast non-cryptographic hash functions
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "khashfn.h"
+
+/* bytes of a stripe of the long loop */
+#define KHF_STRIPE 64U
+/* a block of stripes is followed by a scramble of lanes */
+#define KHF_BLOCK 16U
+
+/* secret of the short hash, from wyhash */
+static const uint64_t khf_s[4] = {
+    0x2D358DCCAA6C78A5U,
+    0x8BB84B93962EACC9U,
+    0x4B33A62ED433D4A3U,
+    0x4D5A2DA51DE1AA47U,
+};
+
+/* secret of the long hash, random odd words */
+static const uint64_t khf_k[16] = {
+    0xBE4BA423396CFEB9U,
+    0x1CAD21F72C81017DU,
+    0xDB979083E96DD4DFU,
+    0x78E5C0CC4EE679CBU,
+    0x2172FFCC7DD05A83U,
+    0x8E2443F7744608B9U,
+    0x4C263A81E69035E1U,
+    0xCB00C391BB52283DU,
+    0xA32E531B8B65D089U,
+    0x6ED6CA0A3FEF5AF7U,
+    0x3D2E6A7DA4FC53C5U,
+    0xD7F5B5A0C9F0A1E3U,
+    0x58A3E6E2E1B8F2A5U,
+    0x9F1C8D7B6A5E4F37U,
+    0xE4D5C6B7A8F9E0D1U,
+    0x17B0F1E2D3C4B5A9U,
+};
+
+static inline uint64_t khf_r8(const uint8_t *p)
+{
+    uint64_t x;
+    (void)memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline uint64_t khf_r4(const uint8_t *p)
+{
+    uint32_t x;
+    (void)memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline uint64_t khf_r3(const uint8_t *p,
+                              size_t n)
+{
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[n >> 1] << 8) | p[n - 1];
+}
+
+/* the multiplier of scramble of lanes */
+#define KHF_P32 0x9E3779B1U
+
+/* stripes of the long input to 8 lanes, portable */
+__UNUSED
+static void khf_lanes_c(uint64_t *acc,
+                        const uint8_t *p,
+                        size_t n,
+                        const uint64_t *k)
+{
+    /* the last stripe is read at the end, it may overlap the one before */
+    size_t c = (n - 1U) / KHF_STRIPE;
+    for (size_t s = 0U; s <= c; ++s)
+    {
+        const uint8_t *q = s != c ? p + s * KHF_STRIPE : p + n - KHF_STRIPE;
+        const uint64_t *ks = k + (s != c ? s & 7U : 7U);
+        uint64_t d[8];
+        (void)memcpy(d, q, sizeof(d));
+        for (unsigned int i = 0U; i != 8U; ++i)
+        {
+            uint64_t x = d[i] ^ ks[i];
+            acc[i] += (x & 0xFFFFFFFFU) * (x >> 32) + d[i ^ 1U];
+        }
+        if ((s & (KHF_BLOCK - 1U)) == KHF_BLOCK - 1U && s != c)
+        {
+            for (unsigned int i = 0U; i != 8U; ++i)
+            {
+                acc[i] ^= acc[i] >> 47;
+                acc[i] ^= k[i + 8U];
+                acc[i] *= KHF_P32;
+            }
+        }
+    }
+}
+
+#if defined __SSE2__ && !defined KHF_NO_SIMD
+
+#include <emmintrin.h>
+
+#define KHF_LD128(p) _mm_loadu_si128((const __m128i *)(const void *)(p))
+
+#define KHF_SSE2 1
+
+/* stripes of the long input to 8 lanes, 2 lanes of each SSE2 register */
+static void khf_lanes_sse2(uint64_t *acc,
+                           const uint8_t *p,
+                           size_t n,
+                           const uint64_t *k)
+{
+    __m128i a[4];
+    const __m128i p32 = _mm_set1_epi32((int)KHF_P32);
+    for (unsigned int i = 0U; i != 4U; ++i)
+    {
+        a[i] = KHF_LD128(acc + 2U * i);
+    }
+    size_t c = (n - 1U) / KHF_STRIPE;
+    for (size_t s = 0U; s <= c; ++s)
+    {
+        const uint8_t *q = s != c ? p + s * KHF_STRIPE : p + n - KHF_STRIPE;
+        const uint64_t *ks = k + (s != c ? s & 7U : 7U);
+        for (unsigned int i = 0U; i != 4U; ++i)
+        {
+            __m128i d = KHF_LD128(q + 16U * i);
+            __m128i x = _mm_xor_si128(d, KHF_LD128(ks + 2U * i));
+            __m128i m = _mm_mul_epu32(x, _mm_srli_epi64(x, 32));
+            d = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(m, d));
+        }
+        if ((s & (KHF_BLOCK - 1U)) == KHF_BLOCK - 1U && s != c)
+        {
+            for (unsigned int i = 0U; i != 4U; ++i)
+            {
+                __m128i x = _mm_xor_si128(a[i], _mm_srli_epi64(a[i], 47));
+                x = _mm_xor_si128(x, KHF_LD128(k + 8U + 2U * i));
+                __m128i h = _mm_mul_epu32(_mm_srli_epi64(x, 32), p32);
+                x = _mm_mul_epu32(x, p32);
+                a[i] = _mm_add_epi64(x, _mm_slli_epi64(h, 32));
+            }
+        }
+    }
+    for (unsigned int i = 0U; i != 4U; ++i)
+    {
+        _mm_storeu_si128((__m128i *)(void *)(acc + 2U * i), a[i]);
+    }
+}
+
+#endif /* __SSE2__ */
+
+#if defined __x86_64__ && !defined KHF_NO_SIMD && \
+    (__GNUC_PREREQ(4, 9) || __glibc_clang_prereq(3, 8))
+
+#include <immintrin.h>
+
+#define KHF_LD256(p) _mm256_loadu_si256((const __m256i *)(const void *)(p))
+
+#define KHF_AVX2 1
+
+/* stripes of the long input to 8 lanes, 4 lanes of each AVX2 register */
+__attribute__((__target__("avx2")))
+static void khf_lanes_avx2(uint64_t *acc,
+                           const uint8_t *p,
+                           size_t n,
+                           const uint64_t *k)
+{
+    __m256i a[2];
+    const __m256i p32 = _mm256_set1_epi32((int)KHF_P32);
+    for (unsigned int i = 0U; i != 2U; ++i)
+    {
+        a[i] = KHF_LD256(acc + 4U * i);
+    }
+    size_t c = (n - 1U) / KHF_STRIPE;
+    for (size_t s = 0U; s <= c; ++s)
+    {
+        const uint8_t *q = s != c ? p + s * KHF_STRIPE : p + n - KHF_STRIPE;
+        const uint64_t *ks = k + (s != c ? s & 7U : 7U);
+        for (unsigned int i = 0U; i != 2U; ++i)
+        {
+            __m256i d = KHF_LD256(q + 32U * i);
+            __m256i x = _mm256_xor_si256(d, KHF_LD256(ks + 4U * i));
+            __m256i m = _mm256_mul_epu32(x, _mm256_srli_epi64(x, 32));
+            d = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm256_add_epi64(a[i], _mm256_add_epi64(m, d));
+        }
+        if ((s & (KHF_BLOCK - 1U)) == KHF_BLOCK - 1U && s != c)
+        {
+            for (unsigned int i = 0U; i != 2U; ++i)
+            {
+                __m256i x = _mm256_xor_si256(a[i], _mm256_srli_epi64(a[i], 47));
+                x = _mm256_xor_si256(x, KHF_LD256(k + 8U + 4U * i));
+                __m256i h = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), p32);
+                x = _mm256_mul_epu32(x, p32);
+                a[i] = _mm256_add_epi64(x, _mm256_slli_epi64(h, 32));
+            }
+        }
+    }
+    for (unsigned int i = 0U; i != 2U; ++i)
+    {
+        _mm256_storeu_si256((__m256i *)(void *)(acc + 4U * i), a[i]);
+    }
+}
+
+#endif /* __x86_64__ */
+
+static uint64_t khf_long(const uint8_t *p,
+                         size_t n,
+                         uint64_t seed)
+{
+    uint64_t acc[8], k[16];
+    for (unsigned int i = 0U; i != 16U; ++i)
+    {
+        k[i] = khf_k[i] + seed;
+    }
+    for (unsigned int i = 0U; i != 8U; ++i)
+    {
+        acc[i] = khf_k[i] ^ seed;
+    }
+#if defined KHF_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        khf_lanes_avx2(acc, p, n, k);
+    }
+    else
+#endif /* KHF_AVX2 */
+    {
+#if defined KHF_SSE2
+        khf_lanes_sse2(acc, p, n, k);
+#else
+        khf_lanes_c(acc, p, n, k);
+#endif /* KHF_SSE2 */
+    }
+    uint64_t h = (uint64_t)n * 0x9E3779B185EBCA87U;
+    for (unsigned int i = 0U; i != 8U; i += 2U)
+    {
+        h += khf_mix(acc[i] ^ k[i + 1U], acc[i + 1U] ^ k[i + 2U]);
+    }
+    return khf_u64(h);
+}
+
+uint64_t khf_hash(const void *p,
+                  size_t n,
+                  uint64_t seed)
+{
+    const uint8_t *s = (const uint8_t *)p;
+    if (n >= KHF_LONG)
+    {
+        return khf_long(s, n, seed);
+    }
+    uint64_t a, b;
+    seed ^= khf_mix(seed ^ khf_s[0], khf_s[1]);
+    if (n <= 16U)
+    {
+        if (n >= 4U)
+        {
+            size_t o = (n >> 3) << 2;
+            a = (khf_r4(s) << 32) | khf_r4(s + o);
+            b = (khf_r4(s + n - 4U) << 32) | khf_r4(s + n - 4U - o);
+        }
+        else if (n)
+        {
+            a = khf_r3(s, n);
+            b = 0U;
+        }
+        else
+        {
+            a = b = 0U;
+        }
+    }
+    else
+    {
+        size_t i = n;
+        if (i > 48U)
+        {
+            uint64_t s1 = seed, s2 = seed;
+            do
+            {
+                seed = khf_mix(khf_r8(s) ^ khf_s[1], khf_r8(s + 8U) ^ seed);
+                s1 = khf_mix(khf_r8(s + 16U) ^ khf_s[2], khf_r8(s + 24U) ^ s1);
+                s2 = khf_mix(khf_r8(s + 32U) ^ khf_s[3], khf_r8(s + 40U) ^ s2);
+                s += 48U;
+                i -= 48U;
+            } while (i > 48U);
+            seed ^= s1 ^ s2;
+        }
+        while (i > 16U)
+        {
+            seed = khf_mix(khf_r8(s) ^ khf_s[1], khf_r8(s + 8U) ^ seed);
+            s += 16U;
+            i -= 16U;
+        }
+        a = khf_r8(s + i - 16U);
+        b = khf_r8(s + i - 8U);
+    }
+    a ^= khf_s[1];
+    b ^= seed;
+    khf_mum(&a, &b);
+    return khf_mix(a ^ khf_s[0] ^ n, b ^ khf_s[1]);
+}
+
+/* END OF FILE */
@@ -0,0 +1,135 @@
+/*!
+ @file           khashfn.h
+ @brief          fast non-cryptographic hash functions
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KHASHFN_H__
+#define __KHASHFN_H__
+
+#include "klib.h"
+#include "kstring.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* inputs of at least this length are hashed by the lanes of stripes */
+#ifndef KHF_LONG
+#define KHF_LONG 1024U
+#endif /* KHF_LONG */
+
+/* hash of 32 bits integer, lowbias32 */
+__STATIC_INLINE
+uint32_t khf_u32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    return x;
+}
+
+/* hash of 64 bits integer, the finalizer of splitmix64 */
+__STATIC_INLINE
+uint64_t khf_u64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9U;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBU;
+    x ^= x >> 31;
+    return x;
+}
+
+/* 128 bits product of a and b, a is the low half and b is the high half */
+__STATIC_INLINE
+void khf_mum(uint64_t *a,
+             uint64_t *b)
+{
+#if defined __SIZEOF_INT128__
+    __extension__ unsigned __int128 r = (unsigned __int128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, la = (uint32_t)*a;
+    uint64_t hb = *b >> 32, lb = (uint32_t)*b;
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t t = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+    *a = (t << 32) | (uint32_t)ll;
+    *b = hh + (hl >> 32) + (lh >> 32) + (t >> 32);
+#endif /* __SIZEOF_INT128__ */
+}
+
+/* mix two 64 bits values, xor of the two halves of 128 bits product */
+__STATIC_INLINE
+uint64_t khf_mix(uint64_t a,
+                 uint64_t b)
+{
+    khf_mum(&a, &b);
+    return a ^ b;
+}
+
+__BEGIN_DECLS
+
+/*!
+ @brief          hash of bytes, 64 bits
+ @details        inputs shorter than KHF_LONG are hashed like wyhash, with one
+                 128 bits multiplication for each 16 bytes. longer inputs go
+                 through 8 lanes of 32x32 bits multiplications in the style
+                 of xxh3, on AVX2 or SSE2 as cpu supports at runtime. all the
+                 paths give the same value, KHF_NO_SIMD keeps the portable one.
+ @note           it is not a cryptographic hash, and the value depends on the
+                 byte order of cpu
+ @param[in]      p: address of bytes, it may be NULL if n is 0
+ @param[in]      n: number of bytes
+ @param[in]      seed: seed of hash
+ @return         hash value
+*/
+extern uint64_t khf_hash(const void *p,
+                         size_t n,
+                         uint64_t seed);
+
+__END_DECLS
+
+/* hash of c string */
+__STATIC_INLINE
+uint64_t khf_str(const char *s)
+{
+    return khf_hash(s, strlen(s), 0U);
+}
+
+/* hash of kstring_t, the content of l bytes */
+__STATIC_INLINE
+uint64_t ks_hash(const kstring_t *ks)
+{
+    return khf_hash(ks->s, ks->l, 0U);
+}
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KHASHFN_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,182 @@
+/*!
+ @file           khazard.c
+ @brief          hazard pointers, reclamation of memory for lock-free structures
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "khazard.h"
+#include "ksearch.h"
+#include "ksort.h"
+
+#include <stdlib.h>
+
+#define KHAZARD_LT(a, b) ((a) < (b))
+
+void khazard_init(khazard_t *d)
+{
+    d->t = NULL;
+}
+
+static int khazard_empty(const krecord_t *r)
+{
+    return !krecord_entry(r, const khazard_thread_t, r)->b;
+}
+
+static void khazard_free_all(krecord_t *r)
+{
+    khazard_thread_t *t = krecord_entry(r, khazard_thread_t, r);
+    void (*func)(void *, khazard_node_t *) = (void (*)(void *, khazard_node_t *))r->func;
+    for (khazard_node_t *p = t->b; p;)
+    {
+        khazard_node_t *n = p->next;
+        func(r->arg, p);
+        p = n;
+    }
+    free(t->s);
+}
+
+void khazard_clear(khazard_t *d)
+{
+    krecord_clear(&d->t, khazard_free_all);
+    khazard_init(d);
+}
+
+khazard_thread_t *khazard_join(khazard_t *d,
+                               void (*func)(void *arg, khazard_node_t *p),
+                               void *arg)
+{
+    krecord_t *r = krecord_join(&d->t, sizeof(khazard_thread_t), offsetof(khazard_thread_t, r),
+                                (void (*)(void))func, arg, khazard_empty);
+    if (!r)
+    {
+        return NULL;
+    }
+    /* others read d of the record only after it is left */
+    khazard_thread_t *t = krecord_entry(r, khazard_thread_t, r);
+    t->d = d;
+    return t;
+}
+
+void khazard_leave(khazard_thread_t *t)
+{
+    for (unsigned int i = 0U; i != KHAZARD_SLOT; ++i)
+    {
+        khazard_reset(t, i);
+    }
+    (void)khazard_scan(t);
+    krecord_leave(&t->r);
+}
+
+/* load the hazard pointers of domain to s of t in order, n of them */
+static int khazard_load(khazard_thread_t *t,
+                        size_t *n)
+{
+    /* the nodes were unlinked before, so a record joined later has none */
+    krecord_t *r = __atomic_load_n(&t->d->t, __ATOMIC_SEQ_CST);
+    size_t m = 0U;
+    for (krecord_t *q = r; q; q = q->next)
+    {
+        m += KHAZARD_SLOT;
+    }
+    if (m > t->m)
+    {
+        void *s = realloc(t->s, sizeof(uintptr_t) * m);
+        if (!s)
+        {
+            return -1;
+        }
+        t->s = (uintptr_t *)s;
+        t->m = m;
+    }
+    m = 0U;
+    for (krecord_t *q = r; q; q = q->next)
+    {
+        void **hp = krecord_entry(q, khazard_thread_t, r)->h;
+        for (unsigned int i = 0U; i != KHAZARD_SLOT; ++i)
+        {
+            void *h = __atomic_load_n(hp + i, __ATOMIC_SEQ_CST);
+            if (h)
+            {
+                t->s[m++] = (uintptr_t)h;
+            }
+        }
+    }
+    ksort_intro(uintptr_t, t->s, m, KHAZARD_LT);
+    *n = m;
+    return 0;
+}
+
+/* free the retired nodes of r that are not in s of t */
+static void khazard_free(khazard_thread_t *t,
+                         khazard_thread_t *r)
+{
+    size_t n = 0U;
+    if (khazard_load(t, &n))
+    {
+        return;
+    }
+    void (*func)(void *, khazard_node_t *) = (void (*)(void *, khazard_node_t *))r->r.func;
+    khazard_node_t *p = r->b, *b = NULL;
+    size_t c = 0U;
+    while (p)
+    {
+        khazard_node_t *q = p->next;
+        size_t i = 0U;
+        ksearch_lower(uintptr_t, i, t->s, n, (uintptr_t)p, KHAZARD_LT);
+        if (i != n && t->s[i] == (uintptr_t)p)
+        {
+            p->next = b;
+            b = p;
+            ++c;
+        }
+        else
+        {
+            func(r->r.arg, p);
+        }
+        p = q;
+    }
+    r->b = b;
+    r->n = r->c = c;
+}
+
+size_t khazard_scan(khazard_thread_t *t)
+{
+    khazard_free(t, t);
+    /* the records that are left have no thread to free their nodes */
+    for (krecord_t *r = __atomic_load_n(&t->d->t, __ATOMIC_ACQUIRE); r; r = r->next)
+    {
+        if (r != &t->r && !krecord_claim(r))
+        {
+            khazard_thread_t *q = krecord_entry(r, khazard_thread_t, r);
+            if (q->b)
+            {
+                khazard_free(t, q);
+            }
+            krecord_leave(r);
+        }
+    }
+    return t->n;
+}
+
+/* END OF FILE */
@@ -0,0 +1,225 @@
+/*!
+ @file           khazard.h
+ @brief          hazard pointers, reclamation of memory for lock-free structures
+ @details        A thread joins a domain and gets a record of KHAZARD_SLOT
+                 hazard pointers. A shared node is read after it is published
+                 in a slot by khazard_protect, and a node that is unlinked is
+                 given to khazard_retire. A scan frees the retired nodes that
+                 no slot points to. A stalled thread keeps only the nodes of
+                 its slots, so the retired nodes that are not freed are fewer
+                 than records * (KHAZARD_SLOT + KHAZARD_BATCH).
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KHAZARD_H__
+#define __KHAZARD_H__
+
+#include "klib.h"
+#include "krecord.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* number of hazard pointers of a record */
+#ifndef KHAZARD_SLOT
+#define KHAZARD_SLOT 4U
+#endif /* KHAZARD_SLOT */
+
+/* a record scans once per this many retired nodes */
+#ifndef KHAZARD_BATCH
+#define KHAZARD_BATCH 64U
+#endif /* KHAZARD_BATCH */
+
+/* a record is on its own cache lines */
+#ifndef KHAZARD_LINE
+#define KHAZARD_LINE KRECORD_LINE
+#endif /* KHAZARD_LINE */
+
+/*!
+ @brief          link of a retired node, it is the first member of the node
+ @details        a hazard pointer points to the node, and the retired link is
+                 compared with it, so they are at the same address.
+*/
+typedef struct khazard_node_t
+{
+    struct khazard_node_t *next; /* next retired node  */
+} khazard_node_t;
+
+typedef struct khazard_thread_t khazard_thread_t;
+
+/*!
+ @brief          domain of hazard pointers
+*/
+typedef struct khazard_t
+{
+    krecord_t *t; /* records of threads      */
+} khazard_t;
+
+/*!
+ @brief          record of a thread in domain
+*/
+struct khazard_thread_t
+{
+    void *h[KHAZARD_SLOT]; /* hazard pointers          */
+    krecord_t r;           /* record of list of domain */
+    khazard_t *d;          /* domain of record         */
+    khazard_node_t *b;     /* retired nodes            */
+    size_t n;              /* number of retired nodes  */
+    size_t c;              /* number kept by last scan */
+    uintptr_t *s;          /* hazard pointers of scan  */
+    size_t m;              /* size of s                */
+};
+
+__BEGIN_DECLS
+
+/*!
+ @brief          initialize a domain of hazard pointers
+ @param[in,out]  d: domain of hazard pointers
+*/
+extern void khazard_init(khazard_t *d)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free all the retired nodes and the records of domain
+ @details        no thread is in the domain when it is called.
+ @param[in,out]  d: domain of hazard pointers
+*/
+extern void khazard_clear(khazard_t *d)
+    __NONNULL_ALL;
+
+/*!
+ @brief          join a domain of hazard pointers
+ @details        the record is taken as krecord_join does.
+ @param[in,out]  d: domain of hazard pointers
+ @param[in]      func: function that frees a retired node
+  @arg           arg: argument of func
+  @arg           p: link of the retired node
+ @param[in]      arg: argument of func
+ @return         record of the calling thread
+  @retval        NULL out of memory
+*/
+extern khazard_thread_t *khazard_join(khazard_t *d,
+                                      void (*func)(void *arg, khazard_node_t *p),
+                                      void *arg)
+    __NONNULL((1, 2)) __RESULT_USE_CHECK;
+
+/*!
+ @brief          leave a domain of hazard pointers, the slots are cleared
+ @param[in,out]  t: record of the calling thread
+*/
+extern void khazard_leave(khazard_thread_t *t)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free the retired nodes that no hazard pointer points to
+ @details        it frees the nodes of the records that are left too.
+ @param[in,out]  t: record of the calling thread
+ @return         number of the retired nodes that are kept by the record
+*/
+extern size_t khazard_scan(khazard_thread_t *t)
+    __NONNULL_ALL;
+
+__END_DECLS
+
+__NONNULL_ALL
+__STATIC_INLINE
+/*!
+ @brief          load a shared pointer and protect it by a hazard pointer
+ @details        the node is not freed until the slot is set again or reset.
+                 the shared pointer is read as void *, such as
+                 khazard_protect(t, 0, (void *const *)&q->head).
+ @param[in,out]  t: record of the calling thread
+ @param[in]      i: index of slot, less than KHAZARD_SLOT
+ @param[in]      src: address of the shared pointer
+ @return         value of the shared pointer that is protected
+*/
+void *khazard_protect(khazard_thread_t *t,
+                      unsigned int i,
+                      void *const *src)
+{
+    void *p = __atomic_load_n(src, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        /* the slot is seen by scan before the pointer is checked again */
+        __atomic_store_n(&t->h[i], p, __ATOMIC_SEQ_CST);
+        void *q = __atomic_load_n(src, __ATOMIC_SEQ_CST);
+        if (q == p)
+        {
+            return p;
+        }
+        p = q;
+    }
+}
+
+__NONNULL((1))
+__STATIC_INLINE
+/*!
+ @brief          set a hazard pointer to a node that is protected already
+ @param[in,out]  t: record of the calling thread
+ @param[in]      i: index of slot, less than KHAZARD_SLOT
+ @param[in]      p: pointer of node
+*/
+void khazard_set(khazard_thread_t *t,
+                 unsigned int i,
+                 void *p)
+{
+    __atomic_store_n(&t->h[i], p, __ATOMIC_SEQ_CST);
+}
+
+__NONNULL_ALL
+__STATIC_INLINE
+/*!
+ @brief          reset a hazard pointer, the node is not read any more
+ @param[in,out]  t: record of the calling thread
+ @param[in]      i: index of slot, less than KHAZARD_SLOT
+*/
+void khazard_reset(khazard_thread_t *t,
+                   unsigned int i)
+{
+    __atomic_store_n(&t->h[i], NULL, __ATOMIC_RELEASE);
+}
+
+__NONNULL_ALL
+__STATIC_INLINE
+/*!
+ @brief          retire a node that is unlinked from the shared structure
+ @param[in,out]  t: record of the calling thread
+ @param[in]      p: link of the node, the first member of it
+*/
+void khazard_retire(khazard_thread_t *t,
+                    khazard_node_t *p)
+{
+    p->next = t->b;
+    t->b = p;
+    if (++t->n >= t->c + KHAZARD_BATCH)
+    {
+        (void)khazard_scan(t);
+    }
+}
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KHAZARD_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,302 @@
+/*!
+ @file           kheap.h
+ @brief          d-ary heap, priority queue
+ @details        The order follows ksort_heap_adjust: cmp(a, b) is a less
+                 function and the top is the largest element, use a greater
+                 function for a min heap.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KHEAP_H__
+#define __KHEAP_H__
+
+#include "klib.h"
+#include "ksort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* kheap_type */
+#ifndef kheap_type
+/*!
+ @brief          Register type of heap structure
+ @details        The members are the same as kvec_type,
+                 so kv_v, kv_size and kv_max can be used on it.
+ @param[in]      name: identity name of heap structure
+ @param[in]      type: type of heap data
+*/
+#define kheap_type(name, type)                  \
+    typedef struct kheap_##name##_t             \
+    {                                           \
+        size_t n; /* number of elements      */ \
+        size_t m; /* size of real memory     */ \
+        type *v;  /* first address of heap   */ \
+    } kheap_##name##_t
+#endif /* kheap_type */
+
+/* kheap_t */
+#ifndef kheap_t
+/*!
+ @brief          typedef of heap registration
+ @param[in]      name: identity name of heap structure
+*/
+#define kheap_t(name) kheap_##name##_t
+#endif /* kheap_t */
+
+/* __KHEAP_IMPL */
+#undef __KHEAP_IMPL
+#define __KHEAP_IMPL(SCOPE, NAME, TYPE, CMP, ARITY)                  \
+                                                                     \
+    __NONNULL_ALL                                                    \
+    SCOPE                                                            \
+    void khp_##NAME##_init(kheap_##NAME##_t *kh)                     \
+    {                                                                \
+        kh->n = 0U;                                                  \
+        kh->m = 0U;                                                  \
+        kh->v = NULL;                                                \
+    }                                                                \
+                                                                     \
+    __NONNULL_ALL                                                    \
+    SCOPE                                                            \
+    void khp_##NAME##_clear(kheap_##NAME##_t *kh)                    \
+    {                                                                \
+        free(kh->v);                                                 \
+        khp_##NAME##_init(kh);                                       \
+    }                                                                \
+                                                                     \
+    __NONNULL_ALL                                                    \
+    SCOPE                                                            \
+    size_t khp_##NAME##_size(const kheap_##NAME##_t *kh)             \
+    {                                                                \
+        return kh->n;                                                \
+    }                                                                \
+                                                                     \
+    __NONNULL_ALL                                                    \
+    SCOPE                                                            \
+    TYPE *khp_##NAME##_top(const kheap_##NAME##_t *kh)               \
+    {                                                                \
+        return kh->n ? kh->v : NULL;                                 \
+    }                                                                \
+                                                                     \
+    __NONNULL_ALL                                                    \
+    SCOPE                                                            \
+    void khp_##NAME##_down(kheap_##NAME##_t *kh,                     \
+                           size_t i)                                 \
+    {                                                                \
+        if ((ARITY) == 2)                                            \
+        {                                                            \
+            ksort_heap_adjust(TYPE, kh->v, i, kh->n, CMP);           \
+            return;                                                  \
+        }                                                            \
+        TYPE *p = kh->v;                                             \
+        TYPE x = p[i];                                               \
+        for (;;)                                                     \
+        {                                                            \
+            size_t c = i * (ARITY) + 1U;                             \
+            if (c >= kh->n)                                          \
+            {                                                        \
+                break;                                               \
+            }                                                        \
+            /* the largest of the children */                        \
+            size_t e = kh->n - c < (ARITY) ? kh->n : c + (ARITY);    \
+            size_t j = c;                                            \
+            for (++c; c < e; ++c)                                    \
+            {                                                        \
+                if (CMP(p[j], p[c]))                                 \
+                {                                                    \
+                    j = c;                                           \
+                }                                                    \
+            }                                                        \
+            if (!CMP(x, p[j]))                                       \
+            {                                                        \
+                break;                                               \
+            }                                                        \
+            p[i] = p[j];                                             \
+            i = j;                                                   \
+        }                                                            \
+        p[i] = x;                                                    \
+    }                                                                \
+                                                                     \
+    __NONNULL_ALL                                                    \
+    SCOPE                                                            \
+    void khp_##NAME##_up(kheap_##NAME##_t *kh,                       \
+                         size_t i)                                   \
+    {                                                                \
+        TYPE *p = kh->v;                                             \
+        TYPE x = p[i];                                               \
+        while (i)                                                    \
+        {                                                            \
+            size_t j = (i - 1U) / (ARITY);                           \
+            if (!CMP(p[j], x))                                       \
+            {                                                        \
+                break;                                               \
+            }                                                        \
+            p[i] = p[j];                                             \
+            i = j;                                                   \
+        }                                                            \
+        p[i] = x;                                                    \
+    }                                                                \
+                                                                     \
+    __NONNULL((1))                                                   \
+    SCOPE                                                            \
+    int khp_##NAME##_reserve(kheap_##NAME##_t *kh,                   \
+                             size_t n)                               \
+    {                                                                \
+        if (n <= kh->m)                                              \
+        {                                                            \
+            return 0;                                                \
+        }                                                            \
+        size_t m = kh->m << 1 > n ? kh->m << 1 : n;                  \
+        if (ksize_overflow(m, sizeof(TYPE)))                         \
+        {                                                            \
+            return -1;                                               \
+        }                                                            \
+        void *p = realloc(kh->v, sizeof(TYPE) * m);                  \
+        if (!p)                                                      \
+        {                                                            \
+            return -1;                                               \
+        }                                                            \
+        kh->v = (TYPE *)p;                                           \
+        kh->m = m;                                                   \
+        return 0;                                                    \
+    }                                                                \
+                                                                     \
+    __NONNULL((1))                                                   \
+    SCOPE                                                            \
+    int khp_##NAME##_push(kheap_##NAME##_t *kh,                      \
+                          TYPE x)                                    \
+    {                                                                \
+        if (kh->n == kh->m &&                                        \
+            khp_##NAME##_reserve(kh, kh->m ? kh->m + 1U : 8U))       \
+        {                                                            \
+            return -1;                                               \
+        }                                                            \
+        kh->v[kh->n] = x;                                            \
+        khp_##NAME##_up(kh, kh->n++);                                \
+        return 0;                                                    \
+    }                                                                \
+                                                                     \
+    __NONNULL_ALL                                                    \
+    SCOPE                                                            \
+    int khp_##NAME##_pop(TYPE *dst,                                  \
+                         kheap_##NAME##_t *kh)                       \
+    {                                                                \
+        if (!kh->n)                                                  \
+        {                                                            \
+            return -1;                                               \
+        }                                                            \
+        *dst = *kh->v;                                               \
+        if (--kh->n)                                                 \
+        {                                                            \
+            *kh->v = kh->v[kh->n];                                   \
+            khp_##NAME##_down(kh, 0U);                               \
+        }                                                            \
+        return 0;                                                    \
+    }                                                                \
+                                                                     \
+    __NONNULL((1, 2))                                                \
+    SCOPE                                                            \
+    int khp_##NAME##_replace_top(TYPE *dst,                          \
+                                 kheap_##NAME##_t *kh,               \
+                                 TYPE x)                             \
+    {                                                                \
+        if (!kh->n)                                                  \
+        {                                                            \
+            return -1;                                               \
+        }                                                            \
+        *dst = *kh->v;                                               \
+        *kh->v = x;                                                  \
+        khp_##NAME##_down(kh, 0U);                                   \
+        return 0;                                                    \
+    }                                                                \
+                                                                     \
+    __NONNULL((1))                                                   \
+    SCOPE                                                            \
+    int khp_##NAME##_heapify(kheap_##NAME##_t *kh,                   \
+                             const TYPE *p,                          \
+                             size_t n)                               \
+    {                                                                \
+        if (khp_##NAME##_reserve(kh, n))                             \
+        {                                                            \
+            return -1;                                               \
+        }                                                            \
+        if (n)                                                       \
+        {                                                            \
+            (void)memcpy(kh->v, p, sizeof(TYPE) * n);                \
+        }                                                            \
+        kh->n = n;                                                   \
+        if ((ARITY) == 2)                                            \
+        {                                                            \
+            if (n > 1U)                                              \
+            {                                                        \
+                ksort_heap_make(TYPE, kh->v, n, CMP);                \
+            }                                                        \
+            return 0;                                                \
+        }                                                            \
+        for (size_t i = n > 1U ? (n - 2U) / (ARITY) + 1U : 0U; i--;) \
+        {                                                            \
+            khp_##NAME##_down(kh, i);                                \
+        }                                                            \
+        return 0;                                                    \
+    }
+
+#ifndef kheap_impl
+/*!
+ @brief          Heap function Initial Microprogram Loading
+ @details        It generates khp_##name##_init, clear, size, top, reserve,
+                 push, pop, replace_top and heapify.
+                 replace_top pops the top and pushes a new element at once,
+                 heapify builds the heap from an array in linear time.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of heap structure
+ @param[in]      type: type of heap data
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+ @param[in]      arity: number of children of a node, 2 or 4
+*/
+#define kheap_impl(scope, name, type, cmp, arity) \
+    __KHEAP_IMPL(scope, name, type, cmp, arity)
+#endif /* kheap_impl */
+
+/* __KHEAP_INIT */
+#undef __KHEAP_INIT
+#define __KHEAP_INIT(NAME, TYPE, CMP, ARITY)                       \
+    kheap_type(NAME, TYPE);                                        \
+    __KHEAP_IMPL(__STATIC_INLINE __UNUSED, NAME, TYPE, CMP, ARITY)
+
+#ifndef kheap_init
+/*!
+ @brief          Heap function Initial Microprogram Loading
+ @param[in]      name: identity name of heap structure
+ @param[in]      type: type of heap data
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+ @param[in]      arity: number of children of a node, 2 or 4
+*/
+#define kheap_init(name, type, cmp, arity) __KHEAP_INIT(name, type, cmp, arity)
+#endif /* kheap_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KHEAP_H__ */
+
+/* END OF FILE */
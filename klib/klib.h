@@ -178,6 +178,41 @@
 
 #endif /* __glibc_clang_prereq(3, 3) */
 
+/* attribute target clones, the best clone is chosen by cpu at runtime */
+#if __GNUC_PREREQ(6, 0) && !defined __clang__ &&     \
+    defined __x86_64__ && defined __gnu_linux__ &&     \
+    !defined __SANITIZE_THREAD__ && !defined KLIB_NO_CLONES
+
+#ifndef __TARGET_CLONES
+#define __TARGET_CLONES                                     \
+    __attribute__((__target_clones__("arch=skylake-avx512", \
+                                     "arch=haswell",        \
+                                     "default")))
+#endif /* __TARGET_CLONES */
+
+#else
+
+#ifndef __TARGET_CLONES
+#define __TARGET_CLONES
+#endif /* __TARGET_CLONES */
+
+#endif /* __GNUC_PREREQ(6, 0) */
+
+/* builtin prefetch, the address is going to be read */
+#if __GNUC_PREREQ(3, 1)
+
+#ifndef kprefetch
+#define kprefetch(p) __builtin_prefetch(p)
+#endif /* kprefetch */
+
+#else
+
+#ifndef kprefetch
+#define kprefetch(p) ((void)(p))
+#endif /* kprefetch */
+
+#endif /* __GNUC_PREREQ(3, 1) */
+
 /* static inline */
 #ifndef __STATIC_INLINE
 #define __STATIC_INLINE static inline
@@ -195,6 +230,88 @@
      ++(x) /**/)
 #endif /* kroundup32 */
 
+/* klib roundup x -> 2^*, x is 64 bits */
+#ifndef kroundup64
+#define kroundup64(x)  \
+    (/**/ --(x),       \
+     (x) |= (x) >> 1,  \
+     (x) |= (x) >> 2,  \
+     (x) |= (x) >> 4,  \
+     (x) |= (x) >> 8,  \
+     (x) |= (x) >> 16, \
+     (x) |= (x) >> 32, \
+     ++(x) /**/)
+#endif /* kroundup64 */
+
+/* klib roundup x -> 2^*, x is any unsigned type such as size_t, 0 if overflow */
+#ifndef kroundup
+#define kroundup(x)          \
+    (/**/ --(x),             \
+     (x) |= (x) >> 1,        \
+     (x) |= (x) >> 2,        \
+     (x) |= (x) >> 4,        \
+     (x) |= (x) >> 8,        \
+     (x) |= (x) >> 16,       \
+     (x) |= (x) >> 16 >> 16, \
+     ++(x) /**/)
+#endif /* kroundup */
+
+/* 1 if n * size is larger than any object, that is the half of size_t */
+#ifndef ksize_overflow
+#define ksize_overflow(n, size) \
+    ((size) && (n) > (~(size_t)0 >> 1) / (size))
+#endif /* ksize_overflow */
+
+/* n * size, or the maximum of size_t that no allocation can meet */
+#ifndef ksize_mul
+#define ksize_mul(n, size) \
+    (ksize_overflow(n, size) ? ~(size_t)0 : (size_t)(n) * (size))
+#endif /* ksize_mul */
+
+/* bit count of 64 bits, x of kctz64 and kclz64 must not be 0 */
+#if __GNUC_PREREQ(3, 4)
+
+#ifndef kpopcount64
+#define kpopcount64(x) ((unsigned int)__builtin_popcountll(x))
+#endif /* kpopcount64 */
+#ifndef kctz64
+#define kctz64(x) ((unsigned int)__builtin_ctzll(x))
+#endif /* kctz64 */
+#ifndef kclz64
+#define kclz64(x) ((unsigned int)__builtin_clzll(x))
+#endif /* kclz64 */
+
+#else
+
+__STATIC_INLINE
+unsigned int kpopcount64(unsigned long long x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+__STATIC_INLINE
+unsigned int kctz64(unsigned long long x)
+{
+    return kpopcount64((x & (0ULL - x)) - 1U);
+}
+
+__STATIC_INLINE
+unsigned int kclz64(unsigned long long x)
+{
+    x |= x >> 1;
+    x |= x >> 2;
+    x |= x >> 4;
+    x |= x >> 8;
+    x |= x >> 16;
+    x |= x >> 32;
+    return 64U - kpopcount64(x);
+}
+
+#endif /* __GNUC_PREREQ(3, 4) */
+
 /* pointer free */
 #ifndef pfree
 #define pfree(func, p) (/**/ (void)func(p), p = ((void *)0) /**/)
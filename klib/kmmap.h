@@ -0,0 +1,358 @@
+/*!
+ @file           kmmap.h
+ @brief          file mapped vector library
+ @details        The file starts with a small header that records the size of
+                 element, the number of elements and the size of real memory,
+                 the data of vector is followed at KVMM_HEAD bytes.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KMMAP_H__
+#define __KMMAP_H__
+
+#include "kvec.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* magic number of file mapped vector, "KVEC" */
+#ifndef KVMM_MAGIC
+#define KVMM_MAGIC 0x4345564BU
+#endif /* KVMM_MAGIC */
+
+/* offset of data in file mapped vector */
+#ifndef KVMM_HEAD
+#define KVMM_HEAD 64U
+#endif /* KVMM_HEAD */
+
+/*!
+ @brief          header of file mapped vector
+*/
+typedef struct kvmm_head_t
+{
+    uint64_t magic; /* magic number of file   */
+    uint64_t size;  /* size of element        */
+    uint64_t n;     /* number of elements     */
+    uint64_t m;     /* size of real memory    */
+} kvmm_head_t;
+
+/* kvec_mmap_type */
+#ifndef kvec_mmap_type
+/*!
+ @brief          Register type of file mapped vector structure
+ @details        The first three members are the same as kvec_type,
+                 so kv_v, kv_size, kv_max and kv_pop can be used on it.
+                 Do not use kv_push, kv_resize and kv_clear on it.
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data
+*/
+#define kvec_mmap_type(name, type)                \
+    typedef struct kvmm_##name##_t                \
+    {                                             \
+        size_t n;       /* number of elements  */ \
+        size_t m;       /* size of real memory */ \
+        type *v;        /* address of data     */ \
+        kvmm_head_t *h; /* address of header   */ \
+        size_t l;       /* length of mapping   */ \
+        int fd;         /* file descriptor     */ \
+        int rw;         /* mapping is writable */ \
+    } kvmm_##name##_t
+#endif /* kvec_mmap_type */
+
+/* kvec_mmap_t */
+#ifndef kvec_mmap_t
+/*!
+ @brief          typedef of file mapped vector registration
+ @param[in]      name: identity name of vector structure
+*/
+#define kvec_mmap_t(name) kvmm_##name##_t
+#endif /* kvec_mmap_t */
+
+/* __KVEC_MMAP_IMPL */
+#undef __KVEC_MMAP_IMPL
+#define __KVEC_MMAP_IMPL(SCOPE, NAME, TYPE)                                 \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    void kv_##NAME##_mmap_init(kvmm_##NAME##_t *kv)                         \
+    {                                                                       \
+        kv->n = 0U;                                                         \
+        kv->m = 0U;                                                         \
+        kv->v = NULL;                                                       \
+        kv->h = NULL;                                                       \
+        kv->l = 0U;                                                         \
+        kv->fd = -1;                                                        \
+        kv->rw = 0;                                                         \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int kv_##NAME##_mmap_open(kvmm_##NAME##_t *kv,                          \
+                              const char *path,                             \
+                              const char *mode)                             \
+    {                                                                       \
+        int flags = O_RDONLY;                                               \
+        struct stat st;                                                     \
+        void *p = NULL;                                                     \
+        kv_##NAME##_mmap_init(kv);                                          \
+        kv->rw = (strchr(mode, '+') != NULL) || (*mode != 'r');             \
+        if (kv->rw)                                                         \
+        {                                                                   \
+            flags = O_RDWR;                                                 \
+            if (*mode == 'w')                                               \
+            {                                                               \
+                flags |= O_CREAT | O_TRUNC;                                 \
+            }                                                               \
+            else if (*mode == 'a')                                          \
+            {                                                               \
+                flags |= O_CREAT;                                           \
+            }                                                               \
+        }                                                                   \
+        kv->fd = open(path, flags, 0644);                                   \
+        if (kv->fd < 0)                                                     \
+        {                                                                   \
+            return -1;                                                      \
+        }                                                                   \
+        if (fstat(kv->fd, &st))                                             \
+        {                                                                   \
+            goto fail;                                                      \
+        }                                                                   \
+        kv->l = (size_t)st.st_size;                                         \
+        if (kv->l == 0U)                                                    \
+        {                                                                   \
+            /* new file, write an empty header */                           \
+            if (!kv->rw || ftruncate(kv->fd, (off_t)KVMM_HEAD))             \
+            {                                                               \
+                goto fail;                                                  \
+            }                                                               \
+            kv->l = KVMM_HEAD;                                              \
+        }                                                                   \
+        else if (kv->l < KVMM_HEAD)                                         \
+        {                                                                   \
+            goto fail;                                                      \
+        }                                                                   \
+        p = mmap(NULL,                                                      \
+                 kv->l,                                                     \
+                 kv->rw ? PROT_READ | PROT_WRITE : PROT_READ,               \
+                 MAP_SHARED,                                                \
+                 kv->fd,                                                    \
+                 0);                                                        \
+        if (p == MAP_FAILED)                                                \
+        {                                                                   \
+            goto fail;                                                      \
+        }                                                                   \
+        kv->h = (kvmm_head_t *)p;                                           \
+        kv->v = (TYPE *)((char *)p + KVMM_HEAD);                            \
+        if (kv->h->magic == 0U && kv->l == KVMM_HEAD && kv->rw)             \
+        {                                                                   \
+            kv->h->magic = KVMM_MAGIC;                                      \
+            kv->h->size = sizeof(TYPE);                                     \
+            kv->h->n = 0U;                                                  \
+            kv->h->m = 0U;                                                  \
+        }                                                                   \
+        if (kv->h->magic != KVMM_MAGIC ||                                   \
+            kv->h->size != sizeof(TYPE) ||                                  \
+            kv->h->n > kv->h->m ||                                          \
+            kv->h->m > (kv->l - KVMM_HEAD) / sizeof(TYPE))                  \
+        {                                                                   \
+            (void)munmap(p, kv->l);                                         \
+            goto fail;                                                      \
+        }                                                                   \
+        kv->n = (size_t)kv->h->n;                                           \
+        kv->m = (size_t)kv->h->m;                                           \
+        return 0;                                                           \
+    fail:                                                                   \
+        (void)close(kv->fd);                                                \
+        kv_##NAME##_mmap_init(kv);                                          \
+        return -1;                                                          \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int kv_##NAME##_mmap_sync(kvmm_##NAME##_t *kv)                          \
+    {                                                                       \
+        if (!kv->rw)                                                        \
+        {                                                                   \
+            return 0;                                                       \
+        }                                                                   \
+        kv->h->n = kv->n;                                                   \
+        kv->h->m = kv->m;                                                   \
+        return msync(kv->h, kv->l, MS_SYNC) ? -1 : 0;                       \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int kv_##NAME##_mmap_close(kvmm_##NAME##_t *kv)                         \
+    {                                                                       \
+        int ret = 0;                                                        \
+        if (kv->h)                                                          \
+        {                                                                   \
+            if (kv->rw)                                                     \
+            {                                                               \
+                kv->h->n = kv->n;                                           \
+                kv->h->m = kv->m;                                           \
+            }                                                               \
+            ret |= munmap(kv->h, kv->l);                                    \
+        }                                                                   \
+        if (kv->fd >= 0)                                                    \
+        {                                                                   \
+            ret |= close(kv->fd);                                           \
+        }                                                                   \
+        kv_##NAME##_mmap_init(kv);                                          \
+        return ret ? -1 : 0;                                                \
+    }                                                                       \
+                                                                            \
+    __NONNULL((1))                                                          \
+    SCOPE                                                                   \
+    int kv_##NAME##_mmap_resize(kvmm_##NAME##_t *kv,                        \
+                                size_t m)                                   \
+    {                                                                       \
+        if (!kv->rw || m > (SIZE_MAX - KVMM_HEAD) / sizeof(TYPE))           \
+        {                                                                   \
+            return -1;                                                      \
+        }                                                                   \
+        size_t l = KVMM_HEAD + sizeof(TYPE) * m;                            \
+        /* grow the file before the mapping, shrink it after */             \
+        if (l > kv->l && ftruncate(kv->fd, (off_t)l))                       \
+        {                                                                   \
+            return -1;                                                      \
+        }                                                                   \
+        void *p = mmap(NULL, l, PROT_READ | PROT_WRITE,                     \
+                       MAP_SHARED, kv->fd, 0);                              \
+        if (p == MAP_FAILED)                                                \
+        {                                                                   \
+            if (l > kv->l)                                                  \
+            {                                                               \
+                (void)ftruncate(kv->fd, (off_t)kv->l);                      \
+            }                                                               \
+            return -1;                                                      \
+        }                                                                   \
+        (void)munmap(kv->h, kv->l);                                         \
+        if (l < kv->l)                                                      \
+        {                                                                   \
+            (void)ftruncate(kv->fd, (off_t)l);                              \
+        }                                                                   \
+        kv->h = (kvmm_head_t *)p;                                           \
+        kv->v = (TYPE *)((char *)p + KVMM_HEAD);                            \
+        kv->l = l;                                                          \
+        kv->m = m;                                                          \
+        if (kv->n > m)                                                      \
+        {                                                                   \
+            kv->n = m;                                                      \
+        }                                                                   \
+        kv->h->n = kv->n;                                                   \
+        kv->h->m = kv->m;                                                   \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __NONNULL((1))                                                          \
+    SCOPE                                                                   \
+    int kv_##NAME##_mmap_push(kvmm_##NAME##_t *kv,                          \
+                              TYPE v)                                       \
+    {                                                                       \
+        if (!kv->rw)                                                        \
+        {                                                                   \
+            return -1;                                                      \
+        }                                                                   \
+        if (kv->n == kv->m)                                                 \
+        {                                                                   \
+            if (kv_##NAME##_mmap_resize(kv, kv->m ? (kv->m << 1U) : 2U))    \
+            {                                                               \
+                return -1;                                                  \
+            }                                                               \
+        }                                                                   \
+        kv->v[kv->n++] = v;                                                 \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int kv_##NAME##_mmap_pop(TYPE *dst,                                     \
+                             kvmm_##NAME##_t *kv)                           \
+    {                                                                       \
+        if (kv->n && kv->rw)                                                \
+        {                                                                   \
+            *dst = kv->v[--kv->n];                                          \
+            return 0;                                                       \
+        }                                                                   \
+        return -1;                                                          \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int kv_##NAME##_mmap_copy(kvmm_##NAME##_t *kv1,                         \
+                              const kvec_##NAME##_t *kv0)                   \
+    {                                                                       \
+        if (!kv1->rw)                                                       \
+        {                                                                   \
+            return -1;                                                      \
+        }                                                                   \
+        if (kv1->m < kv0->n)                                                \
+        {                                                                   \
+            if (kv_##NAME##_mmap_resize(kv1, kv0->n))                       \
+            {                                                               \
+                return -1;                                                  \
+            }                                                               \
+        }                                                                   \
+        kv1->n = kv0->n;                                                    \
+        (void)memcpy(kv1->v, kv0->v, sizeof(*kv0->v) * kv0->n);             \
+        return 0;                                                           \
+    }
+
+#ifndef kvec_mmap_impl
+/*!
+ @brief          File mapped vector function Initial Microprogram Loading
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data
+*/
+#define kvec_mmap_impl(scope, name, type) __KVEC_MMAP_IMPL(scope, name, type)
+#endif /* kvec_mmap_impl */
+
+/* __KVEC_MMAP_INIT */
+#undef __KVEC_MMAP_INIT
+#define __KVEC_MMAP_INIT(NAME, TYPE) \
+    kvec_mmap_type(NAME, TYPE);      \
+    __KVEC_MMAP_IMPL(__STATIC_INLINE __UNUSED, NAME, TYPE)
+
+#ifndef kvec_mmap_init
+/*!
+ @brief          File mapped vector function Initial Microprogram Loading
+ @note           kvec_type(name, type) must be registered before,
+                 it is used by kv_##name##_mmap_copy.
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data
+*/
+#define kvec_mmap_init(name, type) __KVEC_MMAP_INIT(name, type)
+#endif /* kvec_mmap_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KMMAP_H__ */
+
+/* END OF FILE */
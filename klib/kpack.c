@@ -0,0 +1,441 @@
+/*!
+ @file           kpack.c
+ @brief          bit packed integer vector library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kpack.h"
+
+#if __GNUC_PREREQ(4, 8) || defined __clang__
+/* four lanes of block are decoded together */
+typedef uint32_t kvp_u32x4 __attribute__((__vector_size__(16)));
+#endif /* __GNUC_PREREQ(4, 8) */
+
+/* number of bits of x */
+static unsigned int kvp_bits(uint64_t x)
+{
+    return x ? 64U - kclz64(x) : 0U;
+}
+
+/* number of bits of block k */
+static unsigned int kvp_width(const kvec_packed_t *kp,
+                              size_t k)
+{
+    return (unsigned int)((kp->o[k + 1U] - kp->o[k]) >> 2);
+}
+
+/* reference of block k */
+static uint64_t kvp_ref(const kvec_packed_t *kp,
+                        size_t k)
+{
+    return kp->mode == KVP_FOR ? kp->r[k] : 0U;
+}
+
+/*
+ A plane of w bits is 4 lanes of 32 values, value j is in lane j % 4.
+ Word i of lane l is q[i * 4 + l], so the lanes are shifted together.
+*/
+
+/* value j of plane q */
+static uint32_t kvp_get_(const uint32_t *q,
+                         unsigned int w,
+                         size_t j)
+{
+    if (w == 0U)
+    {
+        return 0U;
+    }
+    size_t bit = (j >> 2) * w;
+    unsigned int off = (unsigned int)(bit & 31U);
+    q += ((bit >> 5) << 2) + (j & 3U);
+    uint32_t x = q[0] >> off;
+    if (off + w > 32U)
+    {
+        x |= q[4] << (32U - off);
+    }
+    return w < 32U ? x & ((1U << w) - 1U) : x;
+}
+
+/* decode 128 values of plane q and add r to them */
+__TARGET_CLONES
+static void kvp_unpack_(uint32_t *dst,
+                        const uint32_t *q,
+                        unsigned int w,
+                        uint32_t r)
+{
+    if (w == 0U)
+    {
+        for (size_t j = 0U; j != KVP_BLOCK; ++j)
+        {
+            dst[j] = r;
+        }
+        return;
+    }
+    uint32_t m = w < 32U ? (1U << w) - 1U : ~0U;
+    unsigned int off = 0U;
+#if __GNUC_PREREQ(4, 8) || defined __clang__
+    kvp_u32x4 mask = {m, m, m, m};
+    kvp_u32x4 ref = {r, r, r, r};
+    kvp_u32x4 cur;
+    (void)memcpy(&cur, q, sizeof(cur));
+    q += 4;
+    for (size_t j = 0U; j != 32U; ++j)
+    {
+        kvp_u32x4 x = cur >> off;
+        off += w;
+        /* the last word is used up at the last row */
+        if (off >= 32U && j != 31U)
+        {
+            off -= 32U;
+            (void)memcpy(&cur, q, sizeof(cur));
+            q += 4;
+            if (off)
+            {
+                x |= cur << (w - off);
+            }
+        }
+        x = (x & mask) + ref;
+        (void)memcpy(dst + (j << 2), &x, sizeof(x));
+    }
+#else
+    uint32_t cur[4];
+    (void)memcpy(cur, q, sizeof(cur));
+    q += 4;
+    for (size_t j = 0U; j != 32U; ++j)
+    {
+        uint32_t x[4];
+        for (size_t l = 0U; l != 4U; ++l)
+        {
+            x[l] = cur[l] >> off;
+        }
+        off += w;
+        if (off >= 32U && j != 31U)
+        {
+            off -= 32U;
+            (void)memcpy(cur, q, sizeof(cur));
+            q += 4;
+            for (size_t l = 0U; off && l != 4U; ++l)
+            {
+                x[l] |= cur[l] << (w - off);
+            }
+        }
+        for (size_t l = 0U; l != 4U; ++l)
+        {
+            dst[(j << 2) + l] = (x[l] & m) + r;
+        }
+    }
+#endif /* __GNUC_PREREQ(4, 8) */
+}
+
+/* encode 128 values to plane q, it is zero */
+static void kvp_pack_(uint32_t *q,
+                      const uint32_t *src,
+                      unsigned int w)
+{
+    for (size_t j = 0U; j != KVP_BLOCK; ++j)
+    {
+        size_t bit = (j >> 2) * w;
+        unsigned int off = (unsigned int)(bit & 31U);
+        uint32_t *p = q + ((bit >> 5) << 2) + (j & 3U);
+        p[0] |= src[j] << off;
+        if (off + w > 32U)
+        {
+            p[4] |= src[j] >> (32U - off);
+        }
+    }
+}
+
+/* pack the last block, it is full */
+static int kvp_flush(kvec_packed_t *kp)
+{
+    size_t k = kp->n / KVP_BLOCK - 1U;
+    uint64_t min = kp->t[0];
+    uint64_t max = kp->t[0];
+    for (size_t j = 1U; j != KVP_BLOCK; ++j)
+    {
+        min = kp->t[j] < min ? kp->t[j] : min;
+        max = kp->t[j] > max ? kp->t[j] : max;
+    }
+    uint64_t r = kp->mode == KVP_FOR ? min : 0U;
+    unsigned int w = kvp_bits(max - r);
+    size_t l = kp->l + 4U * w;
+    if (kp->lm < l || !kp->v)
+    {
+        size_t lm = kp->lm ? kp->lm : 64U;
+        while (lm < l)
+        {
+            lm <<= 1;
+        }
+        void *v = realloc(kp->v, sizeof(uint32_t) * lm);
+        if (!v)
+        {
+            return -1;
+        }
+        kp->v = (uint32_t *)v;
+        kp->lm = lm;
+    }
+    if (kp->m < k + 2U)
+    {
+        size_t m = kp->m ? kp->m << 1 : 4U;
+        void *o = realloc(kp->o, sizeof(size_t) * m);
+        if (!o)
+        {
+            return -1;
+        }
+        kp->o = (size_t *)o;
+        if (kp->mode == KVP_FOR)
+        {
+            void *p = realloc(kp->r, sizeof(uint64_t) * m);
+            if (!p)
+            {
+                return -1;
+            }
+            kp->r = (uint64_t *)p;
+        }
+        kp->m = m;
+    }
+    /* more than 32 bits are split into low and high planes */
+    uint32_t lo[KVP_BLOCK];
+    uint32_t hi[KVP_BLOCK];
+    for (size_t j = 0U; j != KVP_BLOCK; ++j)
+    {
+        uint64_t x = kp->t[j] - r;
+        lo[j] = (uint32_t)x;
+        hi[j] = (uint32_t)(x >> 32);
+    }
+    uint32_t *q = kp->v + kp->l;
+    (void)memset(q, 0, sizeof(uint32_t) * 4U * w);
+    if (w > 32U)
+    {
+        kvp_pack_(q, lo, 32U);
+        kvp_pack_(q + KVP_BLOCK, hi, w - 32U);
+    }
+    else if (w)
+    {
+        kvp_pack_(q, lo, w);
+    }
+    kp->o[0] = 0U;
+    kp->o[k + 1U] = l;
+    kp->l = l;
+    if (kp->mode == KVP_FOR)
+    {
+        kp->r[k] = r;
+    }
+    return 0;
+}
+
+void kvp_init(kvec_packed_t *kp,
+              int mode)
+{
+    (void)memset(kp, 0, sizeof(*kp));
+    kp->mode = mode;
+}
+
+void kvp_free(kvec_packed_t *kp)
+{
+    free(kp->v);
+    free(kp->o);
+    free(kp->r);
+    kvp_init(kp, kp->mode);
+}
+
+int kvp_shrink(kvec_packed_t *kp)
+{
+    size_t m = kp->n / KVP_BLOCK + 1U;
+    if (kp->l && kp->l < kp->lm)
+    {
+        void *v = realloc(kp->v, sizeof(uint32_t) * kp->l);
+        if (!v)
+        {
+            return -1;
+        }
+        kp->v = (uint32_t *)v;
+        kp->lm = kp->l;
+    }
+    if (kp->m > m)
+    {
+        void *o = realloc(kp->o, sizeof(size_t) * m);
+        if (!o)
+        {
+            return -1;
+        }
+        kp->o = (size_t *)o;
+        if (kp->mode == KVP_FOR)
+        {
+            void *r = realloc(kp->r, sizeof(uint64_t) * m);
+            if (!r)
+            {
+                return -1;
+            }
+            kp->r = (uint64_t *)r;
+        }
+        kp->m = m;
+    }
+    return 0;
+}
+
+size_t kvp_bytes(const kvec_packed_t *kp)
+{
+    size_t n = sizeof(*kp) + sizeof(uint32_t) * kp->lm;
+    n += sizeof(size_t) * kp->m;
+    if (kp->mode == KVP_FOR)
+    {
+        n += sizeof(uint64_t) * kp->m;
+    }
+    return n;
+}
+
+int kvp_push(kvec_packed_t *kp,
+             uint64_t x)
+{
+    kp->t[kp->n % KVP_BLOCK] = x;
+    if (++kp->n % KVP_BLOCK == 0U && kvp_flush(kp))
+    {
+        --kp->n;
+        return -1;
+    }
+    return 0;
+}
+
+int kvp_v(uint64_t *dst,
+          const kvec_packed_t *kp,
+          size_t i)
+{
+    if (i >= kp->n)
+    {
+        return -1;
+    }
+    size_t k = i / KVP_BLOCK;
+    size_t j = i % KVP_BLOCK;
+    if (k == kp->n / KVP_BLOCK)
+    {
+        *dst = kp->t[j];
+        return 0;
+    }
+    const uint32_t *q = kp->v + kp->o[k];
+    unsigned int w = kvp_width(kp, k);
+    uint64_t x = 0U;
+    if (w > 32U)
+    {
+        x = kvp_get_(q, 32U, j);
+        x |= (uint64_t)kvp_get_(q + KVP_BLOCK, w - 32U, j) << 32;
+    }
+    else
+    {
+        x = kvp_get_(q, w, j);
+    }
+    *dst = x + kvp_ref(kp, k);
+    return 0;
+}
+
+int kvp_decode(uint64_t *dst,
+               const kvec_packed_t *kp,
+               size_t i,
+               size_t n)
+{
+    if (i > kp->n || n > kp->n - i)
+    {
+        return -1;
+    }
+    size_t nb = kp->n / KVP_BLOCK;
+    uint32_t lo[KVP_BLOCK];
+    uint32_t hi[KVP_BLOCK];
+    while (n)
+    {
+        size_t k = i / KVP_BLOCK;
+        size_t j = i % KVP_BLOCK;
+        size_t c = KVP_BLOCK - j < n ? KVP_BLOCK - j : n;
+        if (k == nb)
+        {
+            (void)memcpy(dst, kp->t + j, sizeof(uint64_t) * c);
+        }
+        else
+        {
+            const uint32_t *q = kp->v + kp->o[k];
+            unsigned int w = kvp_width(kp, k);
+            uint64_t r = kvp_ref(kp, k);
+            kvp_unpack_(lo, q, w > 32U ? 32U : w, 0U);
+            if (w > 32U)
+            {
+                kvp_unpack_(hi, q + KVP_BLOCK, w - 32U, 0U);
+            }
+            else
+            {
+                (void)memset(hi, 0, sizeof(hi));
+            }
+            for (size_t e = 0U; e != c; ++e)
+            {
+                dst[e] = ((uint64_t)hi[j + e] << 32 | lo[j + e]) + r;
+            }
+        }
+        dst += c;
+        i += c;
+        n -= c;
+    }
+    return 0;
+}
+
+int kvp_decode32(uint32_t *dst,
+                 const kvec_packed_t *kp,
+                 size_t i,
+                 size_t n)
+{
+    if (i > kp->n || n > kp->n - i)
+    {
+        return -1;
+    }
+    size_t nb = kp->n / KVP_BLOCK;
+    uint32_t lo[KVP_BLOCK];
+    while (n)
+    {
+        size_t k = i / KVP_BLOCK;
+        size_t j = i % KVP_BLOCK;
+        size_t c = KVP_BLOCK - j < n ? KVP_BLOCK - j : n;
+        if (k == nb)
+        {
+            for (size_t e = 0U; e != c; ++e)
+            {
+                dst[e] = (uint32_t)kp->t[j + e];
+            }
+        }
+        else
+        {
+            unsigned int w = kvp_width(kp, k);
+            uint32_t r = (uint32_t)kvp_ref(kp, k);
+            /* a whole block is decoded in place */
+            uint32_t *p = c == KVP_BLOCK ? dst : lo;
+            kvp_unpack_(p, kp->v + kp->o[k], w > 32U ? 32U : w, r);
+            if (p != dst)
+            {
+                (void)memcpy(dst, p + j, sizeof(uint32_t) * c);
+            }
+        }
+        dst += c;
+        i += c;
+        n -= c;
+    }
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,249 @@
+/*!
+ @file           kpack.h
+ @brief          bit packed integer vector library
+ @details        Values are kept in blocks of 128, each block is packed with
+                 the bits of its largest value. In frame of reference mode the
+                 minimum of block is subtracted at first. A block of w bits
+                 takes 4 * w words of 32 bits, so any value is found without
+                 decoding. The values of a block are kept in four lanes, so
+                 the lanes are decoded together by one vector.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KPACK_H__
+#define __KPACK_H__
+
+#include "klib.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of values in a block, 32 rows of 4 lanes */
+#undef KVP_BLOCK
+#define KVP_BLOCK 128U
+
+/* the values are packed by bits of their largest value */
+#ifndef KVP_BITS
+#define KVP_BITS 0
+#endif /* KVP_BITS */
+/* the values are packed by bits of their range, frame of reference */
+#ifndef KVP_FOR
+#define KVP_FOR 1
+#endif /* KVP_FOR */
+
+/*!
+ @brief          bit packed vector of unsigned integer
+*/
+typedef struct kvec_packed_t
+{
+    size_t n;              /* number of values           */
+    size_t m;              /* number of blocks of memory */
+    size_t l;              /* number of words used       */
+    size_t lm;             /* number of words of memory  */
+    uint32_t *v;           /* packed words               */
+    size_t *o;             /* first word of each block   */
+    uint64_t *r;           /* reference of each block    */
+    int mode;              /* KVP_BITS or KVP_FOR        */
+    uint64_t t[KVP_BLOCK]; /* values of the last block   */
+} kvec_packed_t;
+
+__BEGIN_DECLS
+
+/*!
+ @brief          initialize a packed vector
+ @param[in,out]  kp: pointer of packed vector
+ @param[in]      mode: packing mode
+  @arg           KVP_BITS pack the values
+  @arg           KVP_FOR pack the values minus the minimum of block
+*/
+extern void kvp_init(kvec_packed_t *kp,
+                     int mode)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free the memory of packed vector
+ @param[in,out]  kp: pointer of packed vector
+*/
+extern void kvp_free(kvec_packed_t *kp)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free the memory that is not used by packed vector
+ @param[in,out]  kp: pointer of packed vector
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kvp_shrink(kvec_packed_t *kp)
+    __NONNULL_ALL;
+
+/*!
+ @brief          number of bytes that packed vector uses
+ @param[in]      kp: pointer of packed vector
+ @return         number of bytes
+*/
+extern size_t kvp_bytes(const kvec_packed_t *kp)
+    __NONNULL_ALL;
+
+/*!
+ @brief          append a value to packed vector
+ @param[in,out]  kp: pointer of packed vector
+ @param[in]      x: value
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kvp_push(kvec_packed_t *kp,
+                    uint64_t x)
+    __NONNULL((1));
+
+/*!
+ @brief          get a value of packed vector
+ @param[out]     dst: pointer of value
+ @param[in]      kp: pointer of packed vector
+ @param[in]      i: index of value
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kvp_v(uint64_t *dst,
+                 const kvec_packed_t *kp,
+                 size_t i)
+    __NONNULL((1, 2));
+
+/*!
+ @brief          decode values of packed vector
+ @details        each block is decoded by four lanes at a time
+ @param[out]     dst: address of n values
+ @param[in]      kp: pointer of packed vector
+ @param[in]      i: index of first value
+ @param[in]      n: number of values
+ @return         the execution state of the function
+  @retval        -1 failure, [i, i + n) is out of range
+  @retval        0  success
+*/
+extern int kvp_decode(uint64_t *dst,
+                      const kvec_packed_t *kp,
+                      size_t i,
+                      size_t n)
+    __NONNULL((1, 2));
+
+/*!
+ @brief          decode values of packed vector to 32 bits
+ @details        the high bits of values are dropped
+ @param[out]     dst: address of n values
+ @param[in]      kp: pointer of packed vector
+ @param[in]      i: index of first value
+ @param[in]      n: number of values
+ @return         the execution state of the function
+  @retval        -1 failure, [i, i + n) is out of range
+  @retval        0  success
+*/
+extern int kvp_decode32(uint32_t *dst,
+                        const kvec_packed_t *kp,
+                        size_t i,
+                        size_t n)
+    __NONNULL((1, 2));
+
+__END_DECLS
+
+/* number of values of packed vector */
+#ifndef kvp_size
+#define kvp_size(kp) ((kp).n)
+#endif /* kvp_size */
+
+/* __KVEC_PACKED_IMPL */
+#undef __KVEC_PACKED_IMPL
+#define __KVEC_PACKED_IMPL(SCOPE, NAME, TYPE)                            \
+                                                                         \
+    __NONNULL_ALL                                                        \
+    SCOPE                                                                \
+    int kv_##NAME##_pack(kvec_packed_t *dst,                             \
+                         const kvec_##NAME##_t *src)                     \
+    {                                                                    \
+        for (size_t i = 0U; i != src->n; ++i)                            \
+        {                                                                \
+            if (kvp_push(dst, (uint64_t)src->v[i]))                      \
+            {                                                            \
+                return -1;                                               \
+            }                                                            \
+        }                                                                \
+        return 0;                                                        \
+    }                                                                    \
+                                                                         \
+    __NONNULL_ALL                                                        \
+    SCOPE                                                                \
+    int kv_##NAME##_unpack(kvec_##NAME##_t *dst,                         \
+                           const kvec_packed_t *src)                     \
+    {                                                                    \
+        if (dst->m < src->n && kv_##NAME##_resize(dst, src->n))          \
+        {                                                                \
+            return -1;                                                   \
+        }                                                                \
+        uint64_t t[KVP_BLOCK];                                           \
+        for (size_t i = 0U; i != src->n;)                                \
+        {                                                                \
+            size_t n = src->n - i < KVP_BLOCK ? src->n - i : KVP_BLOCK;  \
+            (void)kvp_decode(t, src, i, n);                              \
+            for (size_t k = 0U; k != n; ++k)                             \
+            {                                                            \
+                dst->v[i + k] = (TYPE)t[k];                              \
+            }                                                            \
+            i += n;                                                      \
+        }                                                                \
+        dst->n = src->n;                                                 \
+        return 0;                                                        \
+    }
+
+#ifndef kvec_packed_impl
+/*!
+ @brief          Packed vector convert Initial Microprogram Loading
+ @details        kv_##name##_pack appends the values of vector to packed
+                 vector, kv_##name##_unpack decodes all values of packed
+                 vector to vector.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data, unsigned integer
+*/
+#define kvec_packed_impl(scope, name, type) \
+    __KVEC_PACKED_IMPL(scope, name, type)
+#endif /* kvec_packed_impl */
+
+#ifndef kvec_packed_init
+/*!
+ @brief          Packed vector convert Initial Microprogram Loading
+ @note           kvec_init(name, type) must be registered before.
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data, unsigned integer
+*/
+#define kvec_packed_init(name, type) \
+    __KVEC_PACKED_IMPL(__STATIC_INLINE __UNUSED, name, type)
+#endif /* kvec_packed_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KPACK_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,322 @@
+/*!
+ @file           kpage.h
+ @brief          paged sparse array
+ @details        Two levels of directories over fixed-size pages. A page and
+                 its directory are allocated on the first write into them,
+                 so the memory follows the pages touched rather than the
+                 largest index.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KPAGE_H__
+#define __KPAGE_H__
+
+#include "klib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* each directory has 2^KPAGE_DIR_BITS pages */
+#ifndef KPAGE_DIR_BITS
+#define KPAGE_DIR_BITS 9U
+#endif /* KPAGE_DIR_BITS */
+
+/* the indices are below 2^KPAGE_MAX_BITS whatever the size of page is */
+#ifndef KPAGE_MAX_BITS
+#define KPAGE_MAX_BITS 40U
+#endif /* KPAGE_MAX_BITS */
+
+/* kpage_type */
+#ifndef kpage_type
+/*!
+ @brief          Register type of paged sparse array structure
+ @param[in]      name: identity name of paged sparse array structure
+ @param[in]      type: type of array data
+*/
+#define kpage_type(name, type)                      \
+    typedef struct kpage_##name##_t                 \
+    {                                               \
+        size_t n;  /* one past the largest index */ \
+        size_t m;  /* number of slots of top     */ \
+        size_t c;  /* number of pages            */ \
+        type ***v; /* directories of pages       */ \
+    } kpage_##name##_t
+#endif /* kpage_type */
+
+/* kpage_t */
+#ifndef kpage_t
+/*!
+ @brief          typedef of paged sparse array registration
+ @param[in]      name: identity name of paged sparse array structure
+*/
+#define kpage_t(name) kpage_##name##_t
+#endif /* kpage_t */
+
+/* __KPAGE_IMPL */
+#undef __KPAGE_IMPL
+#define __KPAGE_IMPL(SCOPE, NAME, TYPE, BITS)                                  \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    void kpg_##NAME##_init(kpage_##NAME##_t *kp)                               \
+    {                                                                          \
+        kp->n = 0U;                                                            \
+        kp->m = 0U;                                                            \
+        kp->c = 0U;                                                            \
+        kp->v = NULL;                                                          \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    void kpg_##NAME##_clear(kpage_##NAME##_t *kp)                              \
+    {                                                                          \
+        for (size_t i = 0U; i != kp->m; ++i)                                   \
+        {                                                                      \
+            if (kp->v[i])                                                      \
+            {                                                                  \
+                for (size_t j = 0U; j >> KPAGE_DIR_BITS == 0U; ++j)            \
+                {                                                              \
+                    free(kp->v[i][j]);                                         \
+                }                                                              \
+                free(kp->v[i]);                                                \
+            }                                                                  \
+        }                                                                      \
+        free(kp->v);                                                           \
+        kpg_##NAME##_init(kp);                                                 \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    size_t kpg_##NAME##_size(const kpage_##NAME##_t *kp)                       \
+    {                                                                          \
+        return kp->n;                                                          \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    size_t kpg_##NAME##_pages(const kpage_##NAME##_t *kp)                      \
+    {                                                                          \
+        return kp->c;                                                          \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    size_t kpg_##NAME##_max(const kpage_##NAME##_t *kp)                        \
+    {                                                                          \
+        /* the top has 2^(KPAGE_MAX_BITS - bits - KPAGE_DIR_BITS) entries */   \
+        (void)kp;                                                              \
+        return KPAGE_MAX_BITS < sizeof(size_t) * 8U                            \
+                   ? (((size_t)1) << KPAGE_MAX_BITS) - 1U                      \
+                   : (size_t)-1;                                               \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    size_t kpg_##NAME##_bytes(const kpage_##NAME##_t *kp)                      \
+    {                                                                          \
+        size_t n = sizeof(*kp->v) * kp->m;                                     \
+        for (size_t i = 0U; i != kp->m; ++i)                                   \
+        {                                                                      \
+            n += kp->v[i] ? sizeof(**kp->v) << KPAGE_DIR_BITS : 0U;            \
+        }                                                                      \
+        return n + (sizeof(TYPE) << (BITS)) * kp->c;                           \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    TYPE *kpg_##NAME##_ptr(const kpage_##NAME##_t *kp,                         \
+                           size_t i)                                           \
+    {                                                                          \
+        size_t p = i >> (BITS);                                                \
+        size_t d = p >> KPAGE_DIR_BITS;                                        \
+        if (d >= kp->m || !kp->v[d])                                           \
+        {                                                                      \
+            return NULL;                                                       \
+        }                                                                      \
+        TYPE *page = kp->v[d][p & ((((size_t)1) << KPAGE_DIR_BITS) - 1U)];     \
+        if (!page)                                                             \
+        {                                                                      \
+            return NULL;                                                       \
+        }                                                                      \
+        return page + (i & ((((size_t)1) << (BITS)) - 1U));                    \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    TYPE kpg_##NAME##_get(const kpage_##NAME##_t *kp,                          \
+                          size_t i)                                            \
+    {                                                                          \
+        TYPE *x = kpg_##NAME##_ptr(kp, i);                                     \
+        if (x)                                                                 \
+        {                                                                      \
+            return *x;                                                         \
+        }                                                                      \
+        TYPE z;                                                                \
+        (void)memset(&z, 0, sizeof(z));                                        \
+        return z;                                                              \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    TYPE *kpg_##NAME##_at(kpage_##NAME##_t *kp,                                \
+                          size_t i)                                            \
+    {                                                                          \
+        if (i > kpg_##NAME##_max(kp))                                          \
+        {                                                                      \
+            return NULL;                                                       \
+        }                                                                      \
+        size_t p = i >> (BITS);                                                \
+        size_t d = p >> KPAGE_DIR_BITS;                                        \
+        if (d >= kp->m)                                                        \
+        {                                                                      \
+            size_t top = kpg_##NAME##_max(kp) >> (BITS) >> KPAGE_DIR_BITS;     \
+            size_t m = kp->m << 1 > d ? kp->m << 1 : d + 1U;                   \
+            m = m > top ? top + 1U : m;                                        \
+            if (m > (size_t)-1 / sizeof(*kp->v))                               \
+            {                                                                  \
+                return NULL;                                                   \
+            }                                                                  \
+            void *v = realloc(kp->v, sizeof(*kp->v) * m);                      \
+            if (!v)                                                            \
+            {                                                                  \
+                return NULL;                                                   \
+            }                                                                  \
+            kp->v = (TYPE ***)v;                                               \
+            (void)memset(kp->v + kp->m, 0,                                     \
+                         sizeof(*kp->v) * (m - kp->m));                        \
+            kp->m = m;                                                         \
+        }                                                                      \
+        if (!kp->v[d])                                                         \
+        {                                                                      \
+            kp->v[d] = (TYPE **)calloc(((size_t)1) << KPAGE_DIR_BITS,          \
+                                       sizeof(**kp->v));                       \
+            if (!kp->v[d])                                                     \
+            {                                                                  \
+                return NULL;                                                   \
+            }                                                                  \
+        }                                                                      \
+        TYPE **page = kp->v[d] + (p & ((((size_t)1) << KPAGE_DIR_BITS) - 1U)); \
+        if (!*page)                                                            \
+        {                                                                      \
+            *page = (TYPE *)calloc(((size_t)1) << (BITS), sizeof(TYPE));       \
+            if (!*page)                                                        \
+            {                                                                  \
+                return NULL;                                                   \
+            }                                                                  \
+            ++kp->c;                                                           \
+        }                                                                      \
+        if (kp->n <= i)                                                        \
+        {                                                                      \
+            kp->n = i + 1U;                                                    \
+        }                                                                      \
+        return *page + (i & ((((size_t)1) << (BITS)) - 1U));                   \
+    }                                                                          \
+                                                                               \
+    __NONNULL((1))                                                             \
+    SCOPE                                                                      \
+    int kpg_##NAME##_set(kpage_##NAME##_t *kp,                                 \
+                         size_t i,                                             \
+                         TYPE v)                                               \
+    {                                                                          \
+        TYPE *x = kpg_##NAME##_at(kp, i);                                      \
+        if (!x)                                                                \
+        {                                                                      \
+            return -1;                                                         \
+        }                                                                      \
+        *x = v;                                                                \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    __NONNULL_ALL                                                              \
+    SCOPE                                                                      \
+    int kpg_##NAME##_next(const kpage_##NAME##_t *kp,                          \
+                          size_t *i)                                           \
+    {                                                                          \
+        if (*i >= kp->n)                                                       \
+        {                                                                      \
+            return -1;                                                         \
+        }                                                                      \
+        size_t p = *i >> (BITS);                                               \
+        if (kpg_##NAME##_ptr(kp, *i))                                          \
+        {                                                                      \
+            return 0;                                                          \
+        }                                                                      \
+        /* skip the empty pages and the empty directories */                   \
+        for (++p; (p >> KPAGE_DIR_BITS) < kp->m; ++p)                          \
+        {                                                                      \
+            TYPE **dir = kp->v[p >> KPAGE_DIR_BITS];                           \
+            if (!dir)                                                          \
+            {                                                                  \
+                p |= (((size_t)1) << KPAGE_DIR_BITS) - 1U;                     \
+            }                                                                  \
+            else if (dir[p & ((((size_t)1) << KPAGE_DIR_BITS) - 1U)])          \
+            {                                                                  \
+                *i = p << (BITS);                                              \
+                return *i < kp->n ? 0 : -1;                                    \
+            }                                                                  \
+        }                                                                      \
+        return -1;                                                             \
+    }
+
+#ifndef kpage_impl
+/*!
+ @brief          Paged sparse array function Initial Microprogram Loading
+ @details        It generates kpg_##name##_init, clear, size, pages, max,
+                 bytes, ptr, get, at, set and next.
+                 ptr returns NULL and get returns zero for an untouched page,
+                 at and set allocate the page, next moves the index to the
+                 first touched page at or after it. max is the largest index,
+                 at returns NULL and set returns -1 above it.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of paged sparse array structure
+ @param[in]      type: type of array data
+ @param[in]      bits: each page has 2^bits elements
+*/
+#define kpage_impl(scope, name, type, bits) __KPAGE_IMPL(scope, name, type, bits)
+#endif /* kpage_impl */
+
+/* __KPAGE_INIT */
+#undef __KPAGE_INIT
+#define __KPAGE_INIT(NAME, TYPE, BITS)                       \
+    kpage_type(NAME, TYPE);                                  \
+    __KPAGE_IMPL(__STATIC_INLINE __UNUSED, NAME, TYPE, BITS)
+
+#ifndef kpage_init
+/*!
+ @brief          Paged sparse array function Initial Microprogram Loading
+ @details        The indices are below 2^KPAGE_MAX_BITS for any bits, or any
+                 size_t if it is not wider. The top grows to fit the largest
+                 index written.
+ @param[in]      name: identity name of paged sparse array structure
+ @param[in]      type: type of array data
+ @param[in]      bits: each page has 2^bits elements
+*/
+#define kpage_init(name, type, bits) __KPAGE_INIT(name, type, bits)
+#endif /* kpage_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KPAGE_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,141 @@
+/*!
+ @file           krecord.c
+ @brief          registry of the records of threads for reclamation of memory
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "krecord.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+krecord_t *krecord_join(krecord_t **list,
+                        size_t size,
+                        size_t offset,
+                        void (*func)(void),
+                        void *arg,
+                        int (*empty)(const krecord_t *r))
+{
+    /* the record left with the same func and arg is taken back first,
+       so it is not reclaimed by others while arg is used again */
+    krecord_t *r = __atomic_load_n(list, __ATOMIC_ACQUIRE);
+    for (; r; r = r->next)
+    {
+        if (__atomic_load_n(&r->func, __ATOMIC_RELAXED) != func ||
+            __atomic_load_n(&r->arg, __ATOMIC_RELAXED) != arg)
+        {
+            continue;
+        }
+        int used = 0;
+        while (!__atomic_compare_exchange_n(&r->used, &used, 1, 0,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            if (used == 1)
+            {
+                break;
+            }
+            /* another thread frees its nodes for a while */
+            used = 0;
+        }
+        if (used == 0)
+        {
+            if (r->func == func && r->arg == arg)
+            {
+                return r;
+            }
+            __atomic_store_n(&r->used, 0, __ATOMIC_RELEASE);
+        }
+    }
+    for (r = __atomic_load_n(list, __ATOMIC_ACQUIRE); r; r = r->next)
+    {
+        int used = 0;
+        if (__atomic_load_n(&r->used, __ATOMIC_RELAXED) ||
+            !__atomic_compare_exchange_n(&r->used, &used, 1, 0,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            continue;
+        }
+        /* the retired nodes are freed by the function they were given */
+        if (empty(r))
+        {
+            __atomic_store_n(&r->func, func, __ATOMIC_RELAXED);
+            __atomic_store_n(&r->arg, arg, __ATOMIC_RELAXED);
+            return r;
+        }
+        __atomic_store_n(&r->used, 0, __ATOMIC_RELEASE);
+    }
+    size = (size + KRECORD_LINE - 1U) / KRECORD_LINE * KRECORD_LINE;
+    void *mem = calloc(1U, size + KRECORD_LINE - 1U);
+    if (!mem)
+    {
+        return NULL;
+    }
+    uintptr_t p = ((uintptr_t)mem + KRECORD_LINE - 1U) / KRECORD_LINE * KRECORD_LINE;
+    r = (krecord_t *)(p + offset);
+    r->mem = mem;
+    r->used = 1;
+    r->func = func;
+    r->arg = arg;
+    /* a record pushed after a scan of hazard pointers has none of the nodes
+       unlinked before, so the push is ordered with the loads of the scan */
+    r->next = __atomic_load_n(list, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(list, &r->next, r, 1,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    {
+    }
+    return r;
+}
+
+int krecord_claim(krecord_t *r)
+{
+    int used = 0;
+    if (!__atomic_load_n(&r->used, __ATOMIC_RELAXED) &&
+        __atomic_compare_exchange_n(&r->used, &used, 2, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        return 0;
+    }
+    return -1;
+}
+
+void krecord_leave(krecord_t *r)
+{
+    __atomic_store_n(&r->used, 0, __ATOMIC_RELEASE);
+}
+
+void krecord_clear(krecord_t **list,
+                   void (*func)(krecord_t *r))
+{
+    krecord_t *r = *list;
+    while (r)
+    {
+        krecord_t *q = r->next;
+        func(r);
+        free(r->mem);
+        r = q;
+    }
+    *list = NULL;
+}
+
+/* END OF FILE */
@@ -0,0 +1,134 @@
+/*!
+ @file           krecord.h
+ @brief          registry of the records of threads for reclamation of memory
+ @details        A record is held by one thread between join and leave. The
+                 record left with its function and argument is joined again
+                 first, and a left record with no retired node is taken by
+                 another one. Any thread claims a left record for a while to
+                 free its retired nodes. The records are never unlinked, so
+                 a list of them is walked without lock. A scheme of
+                 reclamation embeds a krecord_t in its own record.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KRECORD_H__
+#define __KRECORD_H__
+
+#include "klib.h"
+
+#include <stddef.h>
+
+/* a record is on its own cache lines */
+#ifndef KRECORD_LINE
+#define KRECORD_LINE 64U
+#endif /* KRECORD_LINE */
+
+/* krecord_entry */
+#ifndef krecord_entry
+/*!
+ @brief          the structure that a krecord_t is the member of
+ @param[in]      p: pointer of krecord_t
+ @param[in]      type: type of structure
+ @param[in]      member: name of krecord_t member in structure
+*/
+#define krecord_entry(p, type, member) \
+    ((type *)(void *)((char *)(p)-offsetof(type, member)))
+#endif /* krecord_entry */
+
+/*!
+ @brief          record of a thread, it is a member of the record of module
+*/
+typedef struct krecord_t
+{
+    struct krecord_t *next; /* next record of list       */
+    int used;               /* 1 held, 2 freed by others */
+    void *arg;              /* argument of func          */
+    void *mem;              /* memory of record          */
+    /* function that frees a retired node, cast to its type by the module */
+    void (*func)(void);
+} krecord_t;
+
+__BEGIN_DECLS
+
+/*!
+ @brief          join a list of records
+ @details        the record left with the same func and arg is taken again,
+                 it waits while another thread frees the nodes of the record,
+                 else a left record that empty is true of is taken, else a
+                 zeroed record of size bytes is aligned to KRECORD_LINE and
+                 pushed to the list.
+                 func is called on the nodes of a left record by any thread,
+                 so arg is not shared by two threads when the func of their
+                 records is not thread safe.
+ @param[in,out]  list: first record of list
+ @param[in]      size: size of the record of module
+ @param[in]      offset: offset of krecord_t in the record of module
+ @param[in]      func: function that frees a retired node
+ @param[in]      arg: argument of func
+ @param[in]      empty: function that tells a record has no retired node
+ @return         record of the calling thread
+  @retval        NULL out of memory
+*/
+extern krecord_t *krecord_join(krecord_t **list,
+                               size_t size,
+                               size_t offset,
+                               void (*func)(void),
+                               void *arg,
+                               int (*empty)(const krecord_t *r))
+    __NONNULL((1, 4, 6)) __RESULT_USE_CHECK;
+
+/*!
+ @brief          claim a left record to free its retired nodes
+ @param[in,out]  r: record that is not held by the calling thread
+ @return         the record is claimed or not
+  @retval        0 it is claimed, krecord_leave gives it back
+  @retval        -1 another thread holds it
+*/
+extern int krecord_claim(krecord_t *r)
+    __NONNULL_ALL;
+
+/*!
+ @brief          leave a record that is joined or claimed
+ @param[in,out]  r: record of the calling thread
+*/
+extern void krecord_leave(krecord_t *r)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free all the records of list
+ @details        no thread holds a record when it is called.
+ @param[in,out]  list: first record of list
+ @param[in]      func: function that frees the retired nodes of a record
+*/
+extern void krecord_clear(krecord_t **list,
+                          void (*func)(krecord_t *r))
+    __NONNULL_ALL;
+
+__END_DECLS
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KRECORD_H__ */
+
+/* END OF FILE */
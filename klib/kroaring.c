@@ -0,0 +1,949 @@
+/*!
+ @file           kroaring.c
+ @brief          compressed bitmap library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kroaring.h"
+#include "ksort.h"
+
+/* number of words of bitmap container */
+#define KR_WORDS 1024U
+
+#define KR_OR     0
+#define KR_AND    1
+#define KR_ANDNOT 2
+
+#define KR_LT(a, b) ((a) < (b))
+
+kvec_impl(__STATIC_INLINE, kr_u16, uint16_t)
+kvec_impl(__STATIC_INLINE, kr_c, kroaring_c_t)
+
+static int kr_reserve(kvec_t(kr_u16) * a,
+                      size_t n)
+{
+    if (a->m >= n)
+    {
+        return 0;
+    }
+    return kv_kr_u16_resize(a, a->m << 1 > n ? a->m << 1 : n);
+}
+
+static void kr_c_init(kroaring_c_t *c,
+                      uint16_t k)
+{
+    (void)memset(c, 0, sizeof(*c));
+    c->k = k;
+    c->t = KR_ARRAY;
+}
+
+static void kr_c_free(kroaring_c_t *c)
+{
+    kv_kr_u16_clear(&c->a);
+    free(c->b);
+    kr_c_init(c, c->k);
+}
+
+/* the first index that is not less than x */
+static size_t kr_lower(const uint16_t *p,
+                       size_t n,
+                       uint16_t x)
+{
+    size_t i = 0U;
+    while (n)
+    {
+        size_t h = n >> 1;
+        if (p[i + h] < x)
+        {
+            i += h + 1U;
+            n -= h + 1U;
+        }
+        else
+        {
+            n = h;
+        }
+    }
+    return i;
+}
+
+/* number of runs that start before or at x */
+static size_t kr_run_upper(const uint16_t *p,
+                           size_t n,
+                           uint16_t x)
+{
+    size_t i = 0U;
+    while (n)
+    {
+        size_t h = n >> 1;
+        if (p[(i + h) << 1] <= x)
+        {
+            i += h + 1U;
+            n -= h + 1U;
+        }
+        else
+        {
+            n = h;
+        }
+    }
+    return i;
+}
+
+static int kr_c_contains(const kroaring_c_t *c,
+                         uint16_t x)
+{
+    if (c->t == KR_BITMAP)
+    {
+        return (int)(c->b[x >> 6] >> (x & 63U) & 1U);
+    }
+    if (c->t == KR_RUN)
+    {
+        size_t r = kr_run_upper(c->a.v, c->a.n >> 1, x);
+        return r && x <= c->a.v[(r << 1) - 1U];
+    }
+    size_t i = kr_lower(c->a.v, c->a.n, x);
+    return i < c->a.n && c->a.v[i] == x;
+}
+
+/* set bits [s, e] of words */
+static void kr_words_range(uint64_t *w,
+                           uint32_t s,
+                           uint32_t e)
+{
+    size_t i = s >> 6;
+    size_t j = e >> 6;
+    uint64_t fs = ~UINT64_C(0) << (s & 63U);
+    uint64_t fe = ~UINT64_C(0) >> (63U - (e & 63U));
+    if (i == j)
+    {
+        w[i] |= fs & fe;
+        return;
+    }
+    w[i] |= fs;
+    for (++i; i != j; ++i)
+    {
+        w[i] = ~UINT64_C(0);
+    }
+    w[j] |= fe;
+}
+
+/* the values of container as words of bitmap */
+static const uint64_t *kr_c_words(const kroaring_c_t *c,
+                                  uint64_t *w)
+{
+    if (c->t == KR_BITMAP)
+    {
+        return c->b;
+    }
+    (void)memset(w, 0, sizeof(uint64_t) * KR_WORDS);
+    if (c->t == KR_RUN)
+    {
+        for (size_t i = 0U; i != c->a.n; i += 2U)
+        {
+            kr_words_range(w, c->a.v[i], c->a.v[i + 1U]);
+        }
+    }
+    else
+    {
+        for (size_t i = 0U; i != c->a.n; ++i)
+        {
+            w[c->a.v[i] >> 6] |= UINT64_C(1) << (c->a.v[i] & 63U);
+        }
+    }
+    return w;
+}
+
+__TARGET_CLONES
+static uint32_t kr_words_count(const uint64_t *w)
+{
+    uint32_t n = 0U;
+    for (size_t i = 0U; i != KR_WORDS; ++i)
+    {
+        n += kpopcount64(w[i]);
+    }
+    return n;
+}
+
+__TARGET_CLONES
+static uint32_t kr_words_op(uint64_t *w,
+                            const uint64_t *p,
+                            const uint64_t *q,
+                            int op)
+{
+    if (op == KR_OR)
+    {
+        for (size_t i = 0U; i != KR_WORDS; ++i)
+        {
+            w[i] = p[i] | q[i];
+        }
+    }
+    else if (op == KR_AND)
+    {
+        for (size_t i = 0U; i != KR_WORDS; ++i)
+        {
+            w[i] = p[i] & q[i];
+        }
+    }
+    else
+    {
+        for (size_t i = 0U; i != KR_WORDS; ++i)
+        {
+            w[i] = p[i] & ~q[i];
+        }
+    }
+    return kr_words_count(w);
+}
+
+/* keep n values of words in container, w may be the bitmap of c */
+static int kr_c_set_words(kroaring_c_t *c,
+                          const uint64_t *w,
+                          uint32_t n)
+{
+    if (n > KR_ARRAY_MAX)
+    {
+        if (!c->b)
+        {
+            c->b = (uint64_t *)malloc(sizeof(uint64_t) * KR_WORDS);
+            if (!c->b)
+            {
+                return -1;
+            }
+        }
+        if (c->b != w)
+        {
+            (void)memcpy(c->b, w, sizeof(uint64_t) * KR_WORDS);
+        }
+        kv_kr_u16_clear(&c->a);
+        c->t = KR_BITMAP;
+        c->n = n;
+        return 0;
+    }
+    /* the container is left as it is if the array has no memory */
+    if (kr_reserve(&c->a, n))
+    {
+        return -1;
+    }
+    c->a.n = 0U;
+    for (size_t i = 0U; i != KR_WORDS; ++i)
+    {
+        for (uint64_t x = w[i]; x; x &= x - 1U)
+        {
+            c->a.v[c->a.n++] = (uint16_t)((i << 6) + kctz64(x));
+        }
+    }
+    free(c->b);
+    c->b = NULL;
+    c->t = KR_ARRAY;
+    c->n = n;
+    return 0;
+}
+
+/* change runs to array or bitmap */
+static int kr_c_unrun(kroaring_c_t *c)
+{
+    if (c->t != KR_RUN)
+    {
+        return 0;
+    }
+    uint64_t w[KR_WORDS];
+    (void)kr_c_words(c, w);
+    return kr_c_set_words(c, w, c->n);
+}
+
+/* 1 if x is added, 0 if x is in it */
+static int kr_c_add(kroaring_c_t *c,
+                    uint16_t x)
+{
+    if (kr_c_contains(c, x))
+    {
+        return 0;
+    }
+    if (kr_c_unrun(c))
+    {
+        return -1;
+    }
+    if (c->t == KR_BITMAP)
+    {
+        c->b[x >> 6] |= UINT64_C(1) << (x & 63U);
+        ++c->n;
+        return 1;
+    }
+    if (c->n == KR_ARRAY_MAX)
+    {
+        uint64_t w[KR_WORDS];
+        (void)kr_c_words(c, w);
+        w[x >> 6] |= UINT64_C(1) << (x & 63U);
+        return kr_c_set_words(c, w, c->n + 1U) ? -1 : 1;
+    }
+    if (kr_reserve(&c->a, c->a.n + 1U))
+    {
+        return -1;
+    }
+    size_t i = kr_lower(c->a.v, c->a.n, x);
+    (void)memmove(c->a.v + i + 1U, c->a.v + i,
+                  sizeof(uint16_t) * (c->a.n - i));
+    c->a.v[i] = x;
+    ++c->a.n;
+    ++c->n;
+    return 1;
+}
+
+/* 1 if x is removed, 0 if x is not in it */
+static int kr_c_remove(kroaring_c_t *c,
+                       uint16_t x)
+{
+    if (!kr_c_contains(c, x))
+    {
+        return 0;
+    }
+    if (kr_c_unrun(c))
+    {
+        return -1;
+    }
+    if (c->t == KR_BITMAP)
+    {
+        c->b[x >> 6] &= ~(UINT64_C(1) << (x & 63U));
+        --c->n;
+        return c->n > KR_ARRAY_MAX || !kr_c_set_words(c, c->b, c->n) ? 1 : -1;
+    }
+    size_t i = kr_lower(c->a.v, c->a.n, x);
+    --c->a.n;
+    (void)memmove(c->a.v + i, c->a.v + i + 1U,
+                  sizeof(uint16_t) * (c->a.n - i));
+    --c->n;
+    return 1;
+}
+
+static int kr_c_copy(kroaring_c_t *dst,
+                     const kroaring_c_t *src)
+{
+    kr_c_init(dst, src->k);
+    if (src->t == KR_BITMAP)
+    {
+        dst->b = (uint64_t *)malloc(sizeof(uint64_t) * KR_WORDS);
+        if (!dst->b)
+        {
+            return -1;
+        }
+        (void)memcpy(dst->b, src->b, sizeof(uint64_t) * KR_WORDS);
+    }
+    else if (src->a.n)
+    {
+        if (kr_reserve(&dst->a, src->a.n))
+        {
+            return -1;
+        }
+        (void)memcpy(dst->a.v, src->a.v, sizeof(uint16_t) * src->a.n);
+        dst->a.n = src->a.n;
+    }
+    dst->t = src->t;
+    dst->n = src->n;
+    return 0;
+}
+
+/* r = x op y, r is empty, s is 3 * KR_WORDS words */
+static int kr_c_op(kroaring_c_t *r,
+                   const kroaring_c_t *x,
+                   const kroaring_c_t *y,
+                   int op,
+                   uint64_t *s)
+{
+    if (op == KR_AND && y->t == KR_ARRAY && x->t != KR_ARRAY)
+    {
+        const kroaring_c_t *t = x;
+        x = y;
+        y = t;
+    }
+    /* intersect or subtract two arrays */
+    if (op != KR_OR && x->t == KR_ARRAY && y->t == KR_ARRAY)
+    {
+        if (kr_reserve(&r->a, x->a.n))
+        {
+            return -1;
+        }
+        const uint16_t *p = x->a.v;
+        const uint16_t *q = y->a.v;
+        size_t i = 0U, j = 0U, n = 0U;
+        int keep = op == KR_AND;
+        while (i != x->a.n && j != y->a.n)
+        {
+            uint16_t a = p[i];
+            uint16_t b = q[j];
+            r->a.v[n] = a;
+            n += (a == b) == keep && a <= b;
+            i += a <= b;
+            j += b <= a;
+        }
+        for (; !keep && i != x->a.n; ++i)
+        {
+            r->a.v[n++] = p[i];
+        }
+        r->a.n = n;
+        r->n = (uint32_t)n;
+        return 0;
+    }
+    /* filter the array by the other */
+    if (op != KR_OR && x->t == KR_ARRAY)
+    {
+        if (kr_reserve(&r->a, x->a.n))
+        {
+            return -1;
+        }
+        int keep = op == KR_AND;
+        for (size_t i = 0U; i != x->a.n; ++i)
+        {
+            r->a.v[r->a.n] = x->a.v[i];
+            r->a.n += kr_c_contains(y, x->a.v[i]) == keep;
+        }
+        r->n = (uint32_t)r->a.n;
+        return 0;
+    }
+    /* merge two arrays */
+    if (x->t == KR_ARRAY && y->t == KR_ARRAY && x->n + y->n <= KR_ARRAY_MAX)
+    {
+        if (kr_reserve(&r->a, x->a.n + y->a.n))
+        {
+            return -1;
+        }
+        const uint16_t *p = x->a.v;
+        const uint16_t *q = y->a.v;
+        size_t i = 0U, j = 0U, n = 0U;
+        while (i != x->a.n && j != y->a.n)
+        {
+            uint16_t a = p[i];
+            uint16_t b = q[j];
+            r->a.v[n++] = a < b ? a : b;
+            i += a <= b;
+            j += b <= a;
+        }
+        for (; i != x->a.n; ++i)
+        {
+            r->a.v[n++] = p[i];
+        }
+        for (; j != y->a.n; ++j)
+        {
+            r->a.v[n++] = q[j];
+        }
+        r->a.n = n;
+        r->n = (uint32_t)n;
+        return 0;
+    }
+    const uint64_t *p = kr_c_words(x, s);
+    const uint64_t *q = kr_c_words(y, s + KR_WORDS);
+    uint32_t n = kr_words_op(s + 2U * KR_WORDS, p, q, op);
+    return kr_c_set_words(r, s + 2U * KR_WORDS, n);
+}
+
+/* the first container whose key is not less than k */
+static size_t kr_find(const kroaring_t *kr,
+                      uint16_t k)
+{
+    const kroaring_c_t *c = kr->c.v;
+    size_t i = 0U;
+    size_t n = kr->c.n;
+    while (n)
+    {
+        size_t h = n >> 1;
+        if (c[i + h].k < k)
+        {
+            i += h + 1U;
+            n -= h + 1U;
+        }
+        else
+        {
+            n = h;
+        }
+    }
+    return i;
+}
+
+/* the container of key k, it is inserted if it is not found */
+static kroaring_c_t *kr_container(kroaring_t *kr,
+                                  uint16_t k)
+{
+    size_t i = kr_find(kr, k);
+    if (i < kr->c.n && kr->c.v[i].k == k)
+    {
+        return kr->c.v + i;
+    }
+    kroaring_c_t c;
+    kr_c_init(&c, k);
+    if (kv_kr_c_push(&kr->c, c))
+    {
+        return NULL;
+    }
+    (void)memmove(kr->c.v + i + 1U, kr->c.v + i,
+                  sizeof(kroaring_c_t) * (kr->c.n - 1U - i));
+    kr->c.v[i] = c;
+    return kr->c.v + i;
+}
+
+/* remove container c if it is empty */
+static void kr_prune(kroaring_t *kr,
+                     kroaring_c_t *c)
+{
+    if (c->n)
+    {
+        return;
+    }
+    size_t i = (size_t)(c - kr->c.v);
+    kr_c_free(c);
+    --kr->c.n;
+    (void)memmove(kr->c.v + i, kr->c.v + i + 1U,
+                  sizeof(kroaring_c_t) * (kr->c.n - i));
+}
+
+void kr_init(kroaring_t *kr)
+{
+    kv_kr_c_init(&kr->c);
+}
+
+void kr_free(kroaring_t *kr)
+{
+    for (size_t i = 0U; i != kr->c.n; ++i)
+    {
+        kr_c_free(kr->c.v + i);
+    }
+    kv_kr_c_clear(&kr->c);
+}
+
+int kr_add(kroaring_t *kr,
+           uint32_t x)
+{
+    kroaring_c_t *c = kr_container(kr, (uint16_t)(x >> 16));
+    if (!c)
+    {
+        return -1;
+    }
+    if (kr_c_add(c, (uint16_t)x) < 0)
+    {
+        kr_prune(kr, c);
+        return -1;
+    }
+    return 0;
+}
+
+int kr_add_many(kroaring_t *kr,
+                const uint32_t *v,
+                size_t n)
+{
+    if (!n)
+    {
+        return 0;
+    }
+    uint32_t *p = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    uint64_t *w = (uint64_t *)malloc(sizeof(uint64_t) * KR_WORDS);
+    if (!p || !w)
+    {
+        free(p);
+        free(w);
+        return -1;
+    }
+    (void)memcpy(p, v, sizeof(uint32_t) * n);
+    ksort_intro(uint32_t, p, n, KR_LT);
+    int ret = 0;
+    for (size_t i = 0U, j = 0U; i != n; i = j)
+    {
+        uint16_t k = (uint16_t)(p[i] >> 16);
+        for (j = i + 1U; j != n && p[j] >> 16 == k; ++j)
+        {
+        }
+        kroaring_c_t *c = kr_container(kr, k);
+        if (!c || kr_c_unrun(c))
+        {
+            ret = -1;
+            break;
+        }
+        /* merge the sorted values to array */
+        if (c->t == KR_ARRAY && c->n + (j - i) <= KR_ARRAY_MAX)
+        {
+            size_t m = c->a.n;
+            if (kr_reserve(&c->a, m + (j - i)))
+            {
+                kr_prune(kr, c);
+                ret = -1;
+                break;
+            }
+            uint16_t *a = c->a.v;
+            size_t l = m + (j - i);
+            size_t e = l;
+            size_t s = j;
+            /* from the back, the duplicates are dropped at last */
+            while (s != i)
+            {
+                uint16_t x = (uint16_t)p[s - 1U];
+                if (m && a[m - 1U] >= x)
+                {
+                    a[--e] = a[--m];
+                    if (a[e] == x)
+                    {
+                        --s;
+                    }
+                }
+                else
+                {
+                    a[--e] = x;
+                    --s;
+                }
+            }
+            /* m values at the head are left, remove the gap */
+            (void)memmove(a + m, a + e, sizeof(uint16_t) * (l - e));
+            l = m + l - e;
+            /* the values of p may be duplicate */
+            size_t u = 0U;
+            for (size_t q = 0U; q != l; ++q)
+            {
+                if (!u || a[u - 1U] != a[q])
+                {
+                    a[u++] = a[q];
+                }
+            }
+            c->a.n = u;
+            c->n = (uint32_t)u;
+            continue;
+        }
+        const uint64_t *b = kr_c_words(c, w);
+        if (b != w)
+        {
+            (void)memcpy(w, b, sizeof(uint64_t) * KR_WORDS);
+        }
+        for (size_t q = i; q != j; ++q)
+        {
+            w[(p[q] >> 6) & 1023U] |= UINT64_C(1) << (p[q] & 63U);
+        }
+        if (kr_c_set_words(c, w, kr_words_count(w)))
+        {
+            kr_prune(kr, c);
+            ret = -1;
+            break;
+        }
+    }
+    free(p);
+    free(w);
+    return ret;
+}
+
+int kr_remove(kroaring_t *kr,
+              uint32_t x)
+{
+    uint16_t k = (uint16_t)(x >> 16);
+    size_t i = kr_find(kr, k);
+    if (i == kr->c.n || kr->c.v[i].k != k)
+    {
+        return 0;
+    }
+    kroaring_c_t *c = kr->c.v + i;
+    if (kr_c_remove(c, (uint16_t)x) < 0)
+    {
+        return -1;
+    }
+    kr_prune(kr, c);
+    return 0;
+}
+
+int kr_contains(const kroaring_t *kr,
+                uint32_t x)
+{
+    uint16_t k = (uint16_t)(x >> 16);
+    size_t i = kr_find(kr, k);
+    if (i == kr->c.n || kr->c.v[i].k != k)
+    {
+        return 0;
+    }
+    return kr_c_contains(kr->c.v + i, (uint16_t)x);
+}
+
+uint64_t kr_card(const kroaring_t *kr)
+{
+    uint64_t n = 0U;
+    for (size_t i = 0U; i != kr->c.n; ++i)
+    {
+        n += kr->c.v[i].n;
+    }
+    return n;
+}
+
+size_t kr_bytes(const kroaring_t *kr)
+{
+    size_t n = sizeof(*kr) + sizeof(kroaring_c_t) * kr->c.m;
+    for (size_t i = 0U; i != kr->c.n; ++i)
+    {
+        n += sizeof(uint16_t) * kr->c.v[i].a.m;
+        n += kr->c.v[i].b ? sizeof(uint64_t) * KR_WORDS : 0U;
+    }
+    return n;
+}
+
+int kr_optimize(kroaring_t *kr)
+{
+    uint64_t w[KR_WORDS];
+    for (size_t i = 0U; i != kr->c.n; ++i)
+    {
+        kroaring_c_t *c = kr->c.v + i;
+        if (c->t == KR_RUN)
+        {
+            continue;
+        }
+        const uint64_t *b = kr_c_words(c, w);
+        /* a run starts at a one whose previous bit is zero */
+        size_t r = 0U;
+        uint64_t carry = 0U;
+        for (size_t j = 0U; j != KR_WORDS; ++j)
+        {
+            r += kpopcount64(b[j] & ~(b[j] << 1 | carry));
+            carry = b[j] >> 63;
+        }
+        size_t size = c->t == KR_BITMAP ? sizeof(uint64_t) * KR_WORDS
+                                        : sizeof(uint16_t) * c->n;
+        if (sizeof(uint16_t) * 2U * r >= size)
+        {
+            continue;
+        }
+        if (b != w)
+        {
+            (void)memcpy(w, b, sizeof(uint64_t) * KR_WORDS);
+        }
+        /* the container is left as it is if the runs have no memory */
+        if (kv_kr_u16_resize(&c->a, 2U * r))
+        {
+            return -1;
+        }
+        c->a.n = 0U;
+        for (uint32_t x = 0U; x != 0x10000U;)
+        {
+            uint64_t v = w[x >> 6] >> (x & 63U);
+            if (!(v & 1U))
+            {
+                /* skip the zeros */
+                if (v)
+                {
+                    x += kctz64(v);
+                }
+                else
+                {
+                    x = ((x >> 6) + 1U) << 6;
+                }
+                continue;
+            }
+            uint32_t s = x;
+            /* skip the ones */
+            v = ~v;
+            if (v && (x & 63U) + kctz64(v) < 64U)
+            {
+                x += kctz64(v);
+            }
+            else
+            {
+                x = ((x >> 6) + 1U) << 6;
+                while (x != 0x10000U && w[x >> 6] == ~UINT64_C(0))
+                {
+                    x += 64U;
+                }
+                if (x != 0x10000U)
+                {
+                    x += kctz64(~w[x >> 6]);
+                }
+            }
+            c->a.v[c->a.n++] = (uint16_t)s;
+            c->a.v[c->a.n++] = (uint16_t)(x - 1U);
+        }
+        free(c->b);
+        c->b = NULL;
+        c->t = KR_RUN;
+    }
+    return 0;
+}
+
+static int kr_op(kroaring_t *dst,
+                 const kroaring_t *a,
+                 const kroaring_t *b,
+                 int op)
+{
+    uint64_t *s = (uint64_t *)malloc(sizeof(uint64_t) * 3U * KR_WORDS);
+    if (!s)
+    {
+        return -1;
+    }
+    kroaring_t r;
+    kr_init(&r);
+    size_t i = 0U, j = 0U;
+    while (i != a->c.n || j != b->c.n)
+    {
+        uint32_t ka = i != a->c.n ? a->c.v[i].k : 0x10000U;
+        uint32_t kb = j != b->c.n ? b->c.v[j].k : 0x10000U;
+        kroaring_c_t c;
+        int e = 0;
+        if (ka == kb)
+        {
+            kr_c_init(&c, (uint16_t)ka);
+            e = kr_c_op(&c, a->c.v + i++, b->c.v + j++, op, s);
+        }
+        else if (ka < kb)
+        {
+            if (op == KR_AND)
+            {
+                ++i;
+                continue;
+            }
+            e = kr_c_copy(&c, a->c.v + i++);
+        }
+        else
+        {
+            if (op != KR_OR)
+            {
+                ++j;
+                continue;
+            }
+            e = kr_c_copy(&c, b->c.v + j++);
+        }
+        if (e || (c.n && kv_kr_c_push(&r.c, c)))
+        {
+            kr_c_free(&c);
+            kr_free(&r);
+            free(s);
+            return -1;
+        }
+        if (!c.n)
+        {
+            kr_c_free(&c);
+        }
+    }
+    free(s);
+    kr_free(dst);
+    *dst = r;
+    return 0;
+}
+
+int kr_or(kroaring_t *dst,
+          const kroaring_t *a,
+          const kroaring_t *b)
+{
+    return kr_op(dst, a, b, KR_OR);
+}
+
+int kr_and(kroaring_t *dst,
+           const kroaring_t *a,
+           const kroaring_t *b)
+{
+    return kr_op(dst, a, b, KR_AND);
+}
+
+int kr_andnot(kroaring_t *dst,
+              const kroaring_t *a,
+              const kroaring_t *b)
+{
+    return kr_op(dst, a, b, KR_ANDNOT);
+}
+
+int kr_next(const kroaring_t *kr,
+            kr_iter_t *it,
+            uint32_t *x)
+{
+    for (; it->c < kr->c.n; ++it->c, it->j = 0U, it->r = 0U)
+    {
+        const kroaring_c_t *c = kr->c.v + it->c;
+        uint32_t k = (uint32_t)c->k << 16;
+        if (c->t == KR_ARRAY)
+        {
+            if (it->j < c->a.n)
+            {
+                *x = k | c->a.v[it->j++];
+                return 1;
+            }
+        }
+        else if (c->t == KR_BITMAP)
+        {
+            if (it->j < 0x10000U)
+            {
+                size_t i = it->j >> 6;
+                uint64_t v = c->b[i] & (~UINT64_C(0) << (it->j & 63U));
+                while (!v && ++i != KR_WORDS)
+                {
+                    v = c->b[i];
+                }
+                if (v)
+                {
+                    it->j = (uint32_t)((i << 6) + kctz64(v));
+                    *x = k | it->j++;
+                    return 1;
+                }
+            }
+        }
+        else
+        {
+            for (; it->r < (c->a.n >> 1); ++it->r)
+            {
+                uint32_t s = c->a.v[it->r << 1];
+                uint32_t e = c->a.v[(it->r << 1) + 1U];
+                it->j = it->j < s ? s : it->j;
+                if (it->j <= e)
+                {
+                    *x = k | it->j++;
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+size_t kr_to_array(uint32_t *dst,
+                   const kroaring_t *kr)
+{
+    uint32_t *p = dst;
+    for (size_t i = 0U; i != kr->c.n; ++i)
+    {
+        const kroaring_c_t *c = kr->c.v + i;
+        uint32_t k = (uint32_t)c->k << 16;
+        if (c->t == KR_ARRAY)
+        {
+            for (size_t j = 0U; j != c->a.n; ++j)
+            {
+                *p++ = k | c->a.v[j];
+            }
+        }
+        else if (c->t == KR_BITMAP)
+        {
+            for (size_t j = 0U; j != KR_WORDS; ++j)
+            {
+                for (uint64_t v = c->b[j]; v; v &= v - 1U)
+                {
+                    *p++ = k | (uint32_t)((j << 6) + kctz64(v));
+                }
+            }
+        }
+        else
+        {
+            for (size_t j = 0U; j != c->a.n; j += 2U)
+            {
+                for (uint32_t x = c->a.v[j]; x <= c->a.v[j + 1U]; ++x)
+                {
+                    *p++ = k | x;
+                }
+            }
+        }
+    }
+    return (size_t)(p - dst);
+}
+
+/* END OF FILE */
@@ -0,0 +1,255 @@
+/*!
+ @file           kroaring.h
+ @brief          compressed bitmap library
+ @details        A set of 32 bits integers is split by the high 16 bits. The
+                 low 16 bits of each part are kept by a container: a sorted
+                 array when there are not more than 4096 values, a bitmap of
+                 65536 bits, or sorted runs that are made by kr_optimize.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KROARING_H__
+#define __KROARING_H__
+
+#include "klib.h"
+#include "kvec.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* container of sorted array */
+#ifndef KR_ARRAY
+#define KR_ARRAY 0
+#endif /* KR_ARRAY */
+/* container of bitmap */
+#ifndef KR_BITMAP
+#define KR_BITMAP 1
+#endif /* KR_BITMAP */
+/* container of runs, the first and the last value of each run */
+#ifndef KR_RUN
+#define KR_RUN 2
+#endif /* KR_RUN */
+
+/* largest number of values of array container */
+#undef KR_ARRAY_MAX
+#define KR_ARRAY_MAX 4096U
+
+kvec_type(kr_u16, uint16_t);
+
+/*!
+ @brief          container of low 16 bits
+*/
+typedef struct kroaring_c_t
+{
+    kvec_t(kr_u16) a; /* values of array, or runs         */
+    uint64_t *b;      /* 1024 words of bitmap             */
+    uint32_t n;       /* number of values                 */
+    uint16_t k;       /* high 16 bits of values           */
+    uint16_t t;       /* KR_ARRAY, KR_BITMAP or KR_RUN    */
+} kroaring_c_t;
+
+kvec_type(kr_c, kroaring_c_t);
+
+/*!
+ @brief          compressed bitmap
+*/
+typedef struct kroaring_t
+{
+    kvec_t(kr_c) c; /* containers sorted by high 16 bits */
+} kroaring_t;
+
+/*!
+ @brief          iterator of compressed bitmap
+*/
+typedef struct kr_iter_t
+{
+    size_t c;   /* index of container       */
+    uint32_t j; /* position in container    */
+    uint32_t r; /* index of run             */
+} kr_iter_t;
+
+__BEGIN_DECLS
+
+/*!
+ @brief          initialize a compressed bitmap
+ @param[in,out]  kr: pointer of compressed bitmap
+*/
+extern void kr_init(kroaring_t *kr)
+    __NONNULL_ALL;
+
+/*!
+ @brief          free the memory of compressed bitmap
+ @param[in,out]  kr: pointer of compressed bitmap
+*/
+extern void kr_free(kroaring_t *kr)
+    __NONNULL_ALL;
+
+/*!
+ @brief          add a value to compressed bitmap
+ @param[in,out]  kr: pointer of compressed bitmap
+ @param[in]      x: value
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kr_add(kroaring_t *kr,
+                  uint32_t x)
+    __NONNULL((1));
+
+/*!
+ @brief          add values to compressed bitmap
+ @details        the values are sorted by ksort at first, then each container
+                 is merged once
+ @param[in,out]  kr: pointer of compressed bitmap
+ @param[in]      v: address of values
+ @param[in]      n: number of values
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kr_add_many(kroaring_t *kr,
+                       const uint32_t *v,
+                       size_t n)
+    __NONNULL((1));
+
+/*!
+ @brief          remove a value from compressed bitmap
+ @param[in,out]  kr: pointer of compressed bitmap
+ @param[in]      x: value
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kr_remove(kroaring_t *kr,
+                     uint32_t x)
+    __NONNULL((1));
+
+/*!
+ @brief          test a value of compressed bitmap
+ @param[in]      kr: pointer of compressed bitmap
+ @param[in]      x: value
+ @return         1 if x is in it, otherwise 0
+*/
+extern int kr_contains(const kroaring_t *kr,
+                       uint32_t x)
+    __NONNULL((1));
+
+/*!
+ @brief          number of values in compressed bitmap
+ @param[in]      kr: pointer of compressed bitmap
+ @return         number of values
+*/
+extern uint64_t kr_card(const kroaring_t *kr)
+    __NONNULL_ALL;
+
+/*!
+ @brief          number of bytes that compressed bitmap uses
+ @param[in]      kr: pointer of compressed bitmap
+ @return         number of bytes
+*/
+extern size_t kr_bytes(const kroaring_t *kr)
+    __NONNULL_ALL;
+
+/*!
+ @brief          change the containers to runs if runs are smaller
+ @param[in,out]  kr: pointer of compressed bitmap
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kr_optimize(kroaring_t *kr)
+    __NONNULL_ALL;
+
+/*!
+ @brief          dst = a | b
+ @param[out]     dst: pointer of compressed bitmap, it may be a or b
+ @param[in]      a: pointer of compressed bitmap
+ @param[in]      b: pointer of compressed bitmap
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kr_or(kroaring_t *dst,
+                 const kroaring_t *a,
+                 const kroaring_t *b)
+    __NONNULL_ALL;
+
+/*!
+ @brief          dst = a & b
+ @param[out]     dst: pointer of compressed bitmap, it may be a or b
+ @param[in]      a: pointer of compressed bitmap
+ @param[in]      b: pointer of compressed bitmap
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kr_and(kroaring_t *dst,
+                  const kroaring_t *a,
+                  const kroaring_t *b)
+    __NONNULL_ALL;
+
+/*!
+ @brief          dst = a & ~b
+ @param[out]     dst: pointer of compressed bitmap, it may be a or b
+ @param[in]      a: pointer of compressed bitmap
+ @param[in]      b: pointer of compressed bitmap
+ @return         the execution state of the function
+  @retval        -1 failure
+  @retval        0  success
+*/
+extern int kr_andnot(kroaring_t *dst,
+                     const kroaring_t *a,
+                     const kroaring_t *b)
+    __NONNULL_ALL;
+
+/*!
+ @brief          take the next value of compressed bitmap
+ @param[in]      kr: pointer of compressed bitmap
+ @param[in,out]  it: pointer of iterator, it is 0 at first
+ @param[out]     x: pointer of value
+ @return         1 if a value is taken, 0 at the end
+*/
+extern int kr_next(const kroaring_t *kr,
+                   kr_iter_t *it,
+                   uint32_t *x)
+    __NONNULL_ALL;
+
+/*!
+ @brief          copy all values of compressed bitmap in order
+ @param[out]     dst: address of kr_card(kr) values
+ @param[in]      kr: pointer of compressed bitmap
+ @return         number of values
+*/
+extern size_t kr_to_array(uint32_t *dst,
+                          const kroaring_t *kr)
+    __NONNULL_ALL;
+
+__END_DECLS
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KROARING_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,173 @@
+/*!
+ @file           ksearch.h
+ @brief          search of sorted array
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KSEARCH_H__
+#define __KSEARCH_H__
+
+#include "klib.h"
+
+#include <stddef.h>
+
+/* number of nodes that are prefetched ahead, 16 is 4 levels of tree */
+#ifndef KSEARCH_AHEAD
+#define KSEARCH_AHEAD 16U
+#endif /* KSEARCH_AHEAD */
+
+/* lower bound */
+#ifndef ksearch_lower
+/*!
+ @brief          Lower bound of sorted array, branchless
+ @param[in]      t: type of data array
+ @param[out]     ret: return variable of macro, index of the first element
+                 that is not less than x, n if there is none
+ @param[in]      p: pointer of data array
+ @param[in]      n: length of data array
+ @param[in]      x: value of search
+ @param[in]      func: function of compare, func(a, b) is a < b
+*/
+#define ksearch_lower(t, ret, p, n, x, func)                  \
+    do                                                        \
+    {                                                         \
+        t const *_lower_p = (p);                              \
+        t _lower_x = (x);                                     \
+        size_t _lower_n = (n);                                \
+        if (_lower_n)                                         \
+        {                                                     \
+            while (_lower_n > 1U)                             \
+            {                                                 \
+                size_t _lower_h = _lower_n >> 1;              \
+                _lower_p = func(_lower_p[_lower_h], _lower_x) \
+                               ? _lower_p + _lower_h          \
+                               : _lower_p;                    \
+                _lower_n -= _lower_h;                         \
+            }                                                 \
+            ret = (size_t)(_lower_p - (p)) +                  \
+                  (func(*_lower_p, _lower_x) ? 1U : 0U);      \
+        }                                                     \
+        else                                                  \
+        {                                                     \
+            ret = 0U;                                         \
+        }                                                     \
+    } while (0)
+#endif /* ksearch_lower */
+
+/* eytzinger build */
+#ifndef ksearch_eytzinger_build
+/*!
+ @brief          Eytzinger layout of sorted array
+ @details        The sorted array is copied in breadth first order of a
+                 complete binary tree, the root is e[1] and the children of
+                 e[k] are e[2k] and e[2k+1]. The top levels of tree share
+                 few cache lines, the children of a node are in the same one.
+                 Align e to 64 bytes for the best prefetch.
+ @param[in]      t: type of data array
+ @param[out]     e: pointer of eytzinger array, length >= n + 1
+ @param[in]      p: pointer of sorted data array
+ @param[in]      n: length of data array
+*/
+#define ksearch_eytzinger_build(t, e, p, n)                     \
+    do                                                          \
+    {                                                           \
+        t const *_eytb_p = (p);                                 \
+        size_t _eytb_n = (n);                                   \
+        size_t _eytb_k = 1U;                                    \
+        if (!_eytb_n)                                           \
+        {                                                       \
+            break;                                              \
+        }                                                       \
+        /* in order walk of the tree, from the leftmost node */ \
+        while (_eytb_k << 1 <= _eytb_n)                         \
+        {                                                       \
+            _eytb_k <<= 1;                                      \
+        }                                                       \
+        for (;;)                                                \
+        {                                                       \
+            (e)[_eytb_k] = *_eytb_p++;                          \
+            if ((_eytb_k << 1 | 1U) <= _eytb_n)                 \
+            {                                                   \
+                _eytb_k = _eytb_k << 1 | 1U;                    \
+                while (_eytb_k << 1 <= _eytb_n)                 \
+                {                                               \
+                    _eytb_k <<= 1;                              \
+                }                                               \
+            }                                                   \
+            else                                                \
+            {                                                   \
+                /* up to the first parent from a left child */  \
+                while (_eytb_k & 1U)                            \
+                {                                               \
+                    _eytb_k >>= 1;                              \
+                }                                               \
+                _eytb_k >>= 1;                                  \
+                if (!_eytb_k)                                   \
+                {                                               \
+                    break;                                      \
+                }                                               \
+            }                                                   \
+        }                                                       \
+    } while (0)
+#endif /* ksearch_eytzinger_build */
+
+/* eytzinger lower bound */
+#ifndef ksearch_eytzinger_lower
+/*!
+ @brief          Lower bound of eytzinger array
+ @details        The loop has no branch but the end, and it prefetches the
+                 descendants of KSEARCH_AHEAD nodes ahead, so the misses of
+                 cache overlap.
+ @param[in]      t: type of data array
+ @param[out]     ret: return variable of macro, index of eytzinger array of
+                 the first element that is not less than x, 0 if there is none
+ @param[in]      e: pointer of eytzinger array
+ @param[in]      n: length of data array
+ @param[in]      x: value of search
+ @param[in]      func: function of compare, func(a, b) is a < b
+*/
+#define ksearch_eytzinger_lower(t, ret, e, n, x, func)             \
+    do                                                             \
+    {                                                              \
+        t const *_eytl_e = (e);                                    \
+        t _eytl_x = (x);                                           \
+        size_t _eytl_n = (n);                                      \
+        size_t _eytl_k = 1U;                                       \
+        while (_eytl_k <= _eytl_n)                                 \
+        {                                                          \
+            kprefetch(_eytl_e + _eytl_k * KSEARCH_AHEAD);          \
+            _eytl_k = _eytl_k << 1 |                               \
+                      (func(_eytl_e[_eytl_k], _eytl_x) ? 1U : 0U); \
+        }                                                          \
+        /* cancel the right turns after the last left turn */      \
+        _eytl_k >>= kctz64(~(unsigned long long)_eytl_k) + 1U;     \
+        ret = _eytl_k;                                             \
+    } while (0)
+#endif /* ksearch_eytzinger_lower */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KSEARCH_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,398 @@
+/*!
+ @file           kset.h
+ @brief          Robin Hood hash set of integer keys
+ @details        A key is inserted in front of the first key that is nearer to
+                 its home slot, so the probe lengths stay short and even up to
+                 9/10 of the slots used. A deleted key is filled by shifting
+                 the following keys back, no tombstone is left.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KSET_H__
+#define __KSET_H__
+
+#include "klib.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* largest distance + 1 of a key from its home, the table grows beyond it,
+   add fails if the hash still puts too many keys together */
+#undef KSET_DMAX
+#define KSET_DMAX 255U
+
+/* number of keys whose slots are prefetched ahead */
+#ifndef KSET_AHEAD
+#define KSET_AHEAD 16U
+#endif /* KSET_AHEAD */
+
+/* kset_type */
+#ifndef kset_type
+/*!
+ @brief          Register type of hash set structure
+ @param[in]      name: identity name of hash set structure
+ @param[in]      key_t: type of key, an integer
+*/
+#define kset_type(name, key_t)                     \
+    typedef struct kset_##name##_t                 \
+    {                                              \
+        size_t n;   /* number of keys           */ \
+        size_t m;   /* number of slots, 2^*     */ \
+        key_t *k;   /* keys                     */ \
+        uint8_t *d; /* distance + 1, 0 is empty */ \
+    } kset_##name##_t
+#endif /* kset_type */
+
+/* kset_t */
+#ifndef kset_t
+/*!
+ @brief          typedef of hash set registration
+ @param[in]      name: identity name of hash set structure
+*/
+#define kset_t(name) kset_##name##_t
+#endif /* kset_t */
+
+/* __KSET_IMPL */
+#undef __KSET_IMPL
+#define __KSET_IMPL(SCOPE, NAME, KEY, HASH)                                  \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    void kset_##NAME##_init(kset_##NAME##_t *ks)                             \
+    {                                                                        \
+        ks->n = 0U;                                                          \
+        ks->m = 0U;                                                          \
+        ks->k = NULL;                                                        \
+        ks->d = NULL;                                                        \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    void kset_##NAME##_clear(kset_##NAME##_t *ks)                            \
+    {                                                                        \
+        free(ks->k);                                                         \
+        free(ks->d);                                                         \
+        kset_##NAME##_init(ks);                                              \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    size_t kset_##NAME##_size(const kset_##NAME##_t *ks)                     \
+    {                                                                        \
+        return ks->n;                                                        \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_contains(const kset_##NAME##_t *ks,                    \
+                               KEY key)                                      \
+    {                                                                        \
+        if (!ks->n)                                                          \
+        {                                                                    \
+            return 0;                                                        \
+        }                                                                    \
+        size_t mask = ks->m - 1U;                                            \
+        size_t i = (size_t)(HASH(key)) & mask;                               \
+        /* a key farther from its home than the probe ends the search */     \
+        for (unsigned int d = 1U; ks->d[i] >= d; ++d)                        \
+        {                                                                    \
+            if (ks->k[i] == key)                                             \
+            {                                                                \
+                return 1;                                                    \
+            }                                                                \
+            i = (i + 1U) & mask;                                             \
+        }                                                                    \
+        return 0;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_put_(kset_##NAME##_t *ks,                              \
+                           KEY key,                                          \
+                           size_t h)                                         \
+    {                                                                        \
+        size_t mask = ks->m - 1U;                                            \
+        size_t i = h & mask;                                                 \
+        unsigned int d = 1U;                                                 \
+        for (; ks->d[i] >= d; ++d)                                           \
+        {                                                                    \
+            if (ks->k[i] == key)                                             \
+            {                                                                \
+                return 0;                                                    \
+            }                                                                \
+            i = (i + 1U) & mask;                                             \
+        }                                                                    \
+        if (d > KSET_DMAX)                                                   \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        /* the keys from i to the next empty slot move one slot right */     \
+        size_t j = i;                                                        \
+        for (; ks->d[j]; j = (j + 1U) & mask)                                \
+        {                                                                    \
+            if (ks->d[j] == KSET_DMAX)                                       \
+            {                                                                \
+                return -1;                                                   \
+            }                                                                \
+        }                                                                    \
+        for (; j != i; j = (j - 1U) & mask)                                  \
+        {                                                                    \
+            size_t l = (j - 1U) & mask;                                      \
+            ks->k[j] = ks->k[l];                                             \
+            ks->d[j] = (uint8_t)(ks->d[l] + 1U);                             \
+        }                                                                    \
+        ks->k[i] = key;                                                      \
+        ks->d[i] = (uint8_t)d;                                               \
+        ++ks->n;                                                             \
+        return 1;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_resize_(kset_##NAME##_t *ks,                           \
+                              size_t m)                                      \
+    {                                                                        \
+        /* a probe is too long, try larger tables, a few times at most */    \
+        size_t e = m << 4;                                                   \
+        for (; m && m != e && !ksize_overflow(m, sizeof(KEY)); m <<= 1)      \
+        {                                                                    \
+            kset_##NAME##_t t;                                               \
+            t.n = 0U;                                                        \
+            t.m = m;                                                         \
+            t.k = (KEY *)malloc(sizeof(KEY) * m);                            \
+            t.d = (uint8_t *)calloc(m, 1U);                                  \
+            if (!t.k || !t.d)                                                \
+            {                                                                \
+                free(t.k);                                                   \
+                free(t.d);                                                   \
+                return -1;                                                   \
+            }                                                                \
+            size_t i = 0U;                                                   \
+            for (; i != ks->m; ++i)                                          \
+            {                                                                \
+                if (ks->d[i] &&                                              \
+                    kset_##NAME##_put_(&t, ks->k[i],                         \
+                                       (size_t)(HASH(ks->k[i]))) < 0)        \
+                {                                                            \
+                    break;                                                   \
+                }                                                            \
+            }                                                                \
+            if (i == ks->m)                                                  \
+            {                                                                \
+                free(ks->k);                                                 \
+                free(ks->d);                                                 \
+                *ks = t;                                                     \
+                return 0;                                                    \
+            }                                                                \
+            free(t.k);                                                       \
+            free(t.d);                                                       \
+        }                                                                    \
+        return -1;                                                           \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_reserve(kset_##NAME##_t *ks,                           \
+                              size_t n)                                      \
+    {                                                                        \
+        /* at most 9/10 of slots are used */                                 \
+        if (n <= ks->m / 10U * 9U + ks->m % 10U * 9U / 10U && ks->m)         \
+        {                                                                    \
+            return 0;                                                        \
+        }                                                                    \
+        size_t m = n + n / 9U + 1U;                                          \
+        m = m < 16U ? 16U : m;                                               \
+        kroundup(m);                                                         \
+        return m ? kset_##NAME##_resize_(ks, m) : -1;                        \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_add(kset_##NAME##_t *ks,                               \
+                          KEY key)                                           \
+    {                                                                        \
+        if (kset_##NAME##_reserve(ks, ks->n + 1U))                           \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        size_t h = (size_t)(HASH(key));                                      \
+        int ret = kset_##NAME##_put_(ks, key, h);                            \
+        if (ret < 0)                                                         \
+        {                                                                    \
+            if (kset_##NAME##_resize_(ks, ks->m << 1))                       \
+            {                                                                \
+                return -1;                                                   \
+            }                                                                \
+            ret = kset_##NAME##_put_(ks, key, h);                            \
+        }                                                                    \
+        return ret;                                                          \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_add_many(kset_##NAME##_t *ks,                          \
+                               const KEY *p,                                 \
+                               size_t n)                                     \
+    {                                                                        \
+        size_t h[KSET_AHEAD];                                                \
+        for (size_t i = 0U; i < n; i += KSET_AHEAD)                          \
+        {                                                                    \
+            size_t c = n - i < KSET_AHEAD ? n - i : KSET_AHEAD;              \
+            if (kset_##NAME##_reserve(ks, ks->n + c))                        \
+            {                                                                \
+                return -1;                                                   \
+            }                                                                \
+            /* the home slots of a block are loaded at once */               \
+            for (size_t j = 0U; j != c; ++j)                                 \
+            {                                                                \
+                h[j] = (size_t)(HASH(p[i + j]));                             \
+                kprefetch(ks->d + (h[j] & (ks->m - 1U)));                    \
+                kprefetch(ks->k + (h[j] & (ks->m - 1U)));                    \
+            }                                                                \
+            for (size_t j = 0U; j != c; ++j)                                 \
+            {                                                                \
+                if (kset_##NAME##_put_(ks, p[i + j], h[j]) < 0 &&            \
+                    (kset_##NAME##_resize_(ks, ks->m << 1) ||                \
+                     kset_##NAME##_put_(ks, p[i + j], h[j]) < 0))            \
+                {                                                            \
+                    return -1;                                               \
+                }                                                            \
+            }                                                                \
+        }                                                                    \
+        return 0;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    size_t kset_##NAME##_contains_many(const kset_##NAME##_t *ks,            \
+                                       const KEY *p,                         \
+                                       size_t n,                             \
+                                       uint8_t *out)                         \
+    {                                                                        \
+        size_t c = 0U;                                                       \
+        if (!ks->n)                                                          \
+        {                                                                    \
+            (void)memset(out, 0, n);                                         \
+            return 0U;                                                       \
+        }                                                                    \
+        for (size_t i = 0U; i != n; ++i)                                     \
+        {                                                                    \
+            if (i + KSET_AHEAD < n)                                          \
+            {                                                                \
+                size_t h = (size_t)(HASH(p[i + KSET_AHEAD])) & (ks->m - 1U); \
+                kprefetch(ks->d + h);                                        \
+                kprefetch(ks->k + h);                                        \
+            }                                                                \
+            out[i] = (uint8_t)kset_##NAME##_contains(ks, p[i]);              \
+            c += out[i];                                                     \
+        }                                                                    \
+        return c;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_del(kset_##NAME##_t *ks,                               \
+                          KEY key)                                           \
+    {                                                                        \
+        if (!ks->n)                                                          \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        size_t mask = ks->m - 1U;                                            \
+        size_t i = (size_t)(HASH(key)) & mask;                               \
+        unsigned int d = 1U;                                                 \
+        for (; ks->d[i] >= d && ks->k[i] != key; ++d)                        \
+        {                                                                    \
+            i = (i + 1U) & mask;                                             \
+        }                                                                    \
+        if (ks->d[i] < d)                                                    \
+        {                                                                    \
+            return -1;                                                       \
+        }                                                                    \
+        /* the keys after it move one slot left until one is at home */      \
+        for (size_t j = (i + 1U) & mask; ks->d[j] > 1U; j = (j + 1U) & mask) \
+        {                                                                    \
+            ks->k[i] = ks->k[j];                                             \
+            ks->d[i] = (uint8_t)(ks->d[j] - 1U);                             \
+            i = j;                                                           \
+        }                                                                    \
+        ks->d[i] = 0U;                                                       \
+        --ks->n;                                                             \
+        return 0;                                                            \
+    }                                                                        \
+                                                                             \
+    __NONNULL_ALL                                                            \
+    SCOPE                                                                    \
+    int kset_##NAME##_next(const kset_##NAME##_t *ks,                        \
+                           size_t *i)                                        \
+    {                                                                        \
+        for (; *i < ks->m; ++*i)                                             \
+        {                                                                    \
+            if (ks->d[*i])                                                   \
+            {                                                                \
+                return 0;                                                    \
+            }                                                                \
+        }                                                                    \
+        return -1;                                                           \
+    }
+
+#ifndef kset_impl
+/*!
+ @brief          Hash set function Initial Microprogram Loading
+ @details        It generates kset_##name##_init, clear, size, reserve, add,
+                 add_many, contains, contains_many, del and next.
+                 add returns 1 if the key is new, 0 if it is in the set.
+                 add_many and contains_many prefetch the home slots of the
+                 keys KSET_AHEAD ahead.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of hash set structure
+ @param[in]      key_t: type of key, an integer
+ @param[in]      hash: function of hash, hash(key) of size_t
+*/
+#define kset_impl(scope, name, key_t, hash) \
+    __KSET_IMPL(scope, name, key_t, hash)
+#endif /* kset_impl */
+
+/* __KSET_INIT */
+#undef __KSET_INIT
+#define __KSET_INIT(NAME, KEY, HASH)                       \
+    kset_type(NAME, KEY);                                  \
+    __KSET_IMPL(__STATIC_INLINE __UNUSED, NAME, KEY, HASH)
+
+#ifndef kset_init
+/*!
+ @brief          Hash set function Initial Microprogram Loading
+ @param[in]      name: identity name of hash set structure
+ @param[in]      key_t: type of key, an integer
+ @param[in]      hash: function of hash, hash(key) of size_t
+*/
+#define kset_init(name, key_t, hash) __KSET_INIT(name, key_t, hash)
+#endif /* kset_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KSET_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,355 @@
+/*!
+ @file           kskiplist.h
+ @brief          skip list of ordered map
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KSKIPLIST_H__
+#define __KSKIPLIST_H__
+
+#include "klib.h"
+#include "klist.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* the most levels of skip list, enough for 4^31 nodes */
+#ifndef KSKIPLIST_MAX
+#define KSKIPLIST_MAX 32U
+#endif /* KSKIPLIST_MAX */
+
+/* the first state of random number of heights */
+#ifndef KSKIPLIST_SEED
+#define KSKIPLIST_SEED 0x9E3779B97F4A7C15U
+#endif /* KSKIPLIST_SEED */
+
+/* nothing to do for a node of memory pool */
+#undef KSKIPLIST_NOP
+#define KSKIPLIST_NOP(p) (void)(p)
+
+/* kskiplist_type */
+#ifndef kskiplist_type
+/*!
+ @brief          Register type of skip list structure
+ @details        a node of height h is linked in levels [0, h), and it is
+                 from the memory pool of height h, so nodes of a pool are
+                 of the same size.
+ @param[in]      name: identity name of skip list structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+*/
+#define kskiplist_type(name, key_t, val_t)                                          \
+    typedef struct kskiplist_##name##_n                                             \
+    {                                                                               \
+        key_t k;                             /* key                     */          \
+        val_t v;                             /* value                   */          \
+        unsigned int h;                      /* height of tower         */          \
+        struct kskiplist_##name##_n *next[]; /* next node of each level */          \
+    } kskiplist_##name##_n;                                                         \
+    kmempool_type(ksl_##name, kskiplist_##name##_n);                                \
+    typedef struct kskiplist_##name##_t                                             \
+    {                                                                               \
+        kskiplist_##name##_n *head[KSKIPLIST_MAX]; /* first node of each level   */ \
+        kmp_ksl_##name##_t kmp[KSKIPLIST_MAX];     /* memory pool of each height */ \
+        uint64_t r;                                /* state of random number     */ \
+        size_t n;                                  /* number of nodes            */ \
+        unsigned int h;                            /* number of levels in use    */ \
+    } kskiplist_##name##_t
+#endif /* kskiplist_type */
+
+/* kskiplist_t */
+#ifndef kskiplist_t
+/*!
+ @brief          typedef of skip list registration
+ @param[in]      name: identity name of skip list structure
+*/
+#define kskiplist_t(name) kskiplist_##name##_t
+#endif /* kskiplist_t */
+
+/* kskiplist_n */
+#ifndef kskiplist_n
+/*!
+ @brief          typedef of skip list node, it has members k and v
+ @param[in]      name: identity name of skip list structure
+*/
+#define kskiplist_n(name) kskiplist_##name##_n
+#endif /* kskiplist_n */
+
+/* __KSKIPLIST_IMPL */
+#undef __KSKIPLIST_IMPL
+#define __KSKIPLIST_IMPL(SCOPE, NAME, KEY, VAL, CMP)                             \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void ksl_##NAME##_init(kskiplist_##NAME##_t *kl)                             \
+    {                                                                            \
+        for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)                       \
+        {                                                                        \
+            kl->head[i] = NULL;                                                  \
+            kmp_init(kl->kmp[i]);                                                \
+        }                                                                        \
+        kl->r = KSKIPLIST_SEED;                                                  \
+        kl->n = 0U;                                                              \
+        kl->h = 0U;                                                              \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    void ksl_##NAME##_clear(kskiplist_##NAME##_t *kl)                            \
+    {                                                                            \
+        kskiplist_##NAME##_n *p = kl->head[0];                                   \
+        while (p)                                                                \
+        {                                                                        \
+            kskiplist_##NAME##_n *q = p->next[0];                                \
+            (void)kmp_free(kskiplist_##NAME##_n, kl->kmp[p->h - 1U], p);         \
+            p = q;                                                               \
+        }                                                                        \
+        for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)                       \
+        {                                                                        \
+            kmp_clear(KSKIPLIST_NOP, kl->kmp[i]);                                \
+        }                                                                        \
+        ksl_##NAME##_init(kl);                                                   \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    size_t ksl_##NAME##_size(const kskiplist_##NAME##_t *kl)                     \
+    {                                                                            \
+        return kl->n;                                                            \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    unsigned int ksl_##NAME##_height_(kskiplist_##NAME##_t *kl)                  \
+    {                                                                            \
+        /* xorshift64, each level up has a quarter of the nodes */               \
+        uint64_t r = kl->r;                                                      \
+        r ^= r << 13;                                                            \
+        r ^= r >> 7;                                                             \
+        r ^= r << 17;                                                            \
+        kl->r = r;                                                               \
+        return (kctz64(r | (uint64_t)1 << (2U * KSKIPLIST_MAX - 2U)) >> 1) + 1U; \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    kskiplist_##NAME##_n *ksl_##NAME##_node_(kskiplist_##NAME##_t *kl,           \
+                                             unsigned int h)                     \
+    {                                                                            \
+        kmp_ksl_##NAME##_t *kmp = kl->kmp + h - 1U;                              \
+        kskiplist_##NAME##_n *p;                                                 \
+        if (kmp->n)                                                              \
+        {                                                                        \
+            p = kmp->p[--kmp->n];                                                \
+        }                                                                        \
+        else                                                                     \
+        {                                                                        \
+            p = (kskiplist_##NAME##_n *)malloc(sizeof(*p) + sizeof(p) * h);      \
+            if (!p)                                                              \
+            {                                                                    \
+                return NULL;                                                     \
+            }                                                                    \
+        }                                                                        \
+        ++kmp->cnt;                                                              \
+        p->h = h;                                                                \
+        return p;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    kskiplist_##NAME##_n **ksl_##NAME##_pred_(const kskiplist_##NAME##_t *kl,    \
+                                              KEY key,                           \
+                                              kskiplist_##NAME##_n ***pred)      \
+    {                                                                            \
+        /* x is the array of next of a node, the head is the one before all */   \
+        kskiplist_##NAME##_n **x = (kskiplist_##NAME##_n **)kl->head;            \
+        for (unsigned int i = kl->h; i--;)                                       \
+        {                                                                        \
+            kskiplist_##NAME##_n *p;                                             \
+            while ((p = x[i]) && CMP(p->k, key))                                 \
+            {                                                                    \
+                x = p->next;                                                     \
+            }                                                                    \
+            if (pred)                                                            \
+            {                                                                    \
+                pred[i] = x;                                                     \
+            }                                                                    \
+        }                                                                        \
+        return x;                                                                \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    kskiplist_##NAME##_n *ksl_##NAME##_lower(const kskiplist_##NAME##_t *kl,     \
+                                             KEY key)                            \
+    {                                                                            \
+        return ksl_##NAME##_pred_(kl, key, NULL)[0];                             \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    kskiplist_##NAME##_n *ksl_##NAME##_begin(const kskiplist_##NAME##_t *kl)     \
+    {                                                                            \
+        return kl->head[0];                                                      \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    kskiplist_##NAME##_n *ksl_##NAME##_next(const kskiplist_##NAME##_n *p)       \
+    {                                                                            \
+        return p->next[0];                                                       \
+    }                                                                            \
+                                                                                 \
+    __NONNULL_ALL                                                                \
+    SCOPE                                                                        \
+    VAL *ksl_##NAME##_get(const kskiplist_##NAME##_t *kl,                        \
+                          KEY key)                                               \
+    {                                                                            \
+        kskiplist_##NAME##_n *p = ksl_##NAME##_lower(kl, key);                   \
+        return p && !CMP(key, p->k) ? &p->v : NULL;                              \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    VAL *ksl_##NAME##_put(kskiplist_##NAME##_t *kl,                              \
+                          KEY key,                                               \
+                          int *absent)                                           \
+    {                                                                            \
+        kskiplist_##NAME##_n **pred[KSKIPLIST_MAX];                              \
+        kskiplist_##NAME##_n *p = ksl_##NAME##_pred_(kl, key, pred)[0];          \
+        if (p && !CMP(key, p->k))                                                \
+        {                                                                        \
+            if (absent)                                                          \
+            {                                                                    \
+                *absent = 0;                                                     \
+            }                                                                    \
+            return &p->v;                                                        \
+        }                                                                        \
+        unsigned int h = ksl_##NAME##_height_(kl);                               \
+        p = ksl_##NAME##_node_(kl, h);                                           \
+        if (!p)                                                                  \
+        {                                                                        \
+            return NULL;                                                         \
+        }                                                                        \
+        for (; kl->h < h; ++kl->h)                                               \
+        {                                                                        \
+            pred[kl->h] = kl->head;                                              \
+        }                                                                        \
+        for (unsigned int i = 0U; i != h; ++i)                                   \
+        {                                                                        \
+            p->next[i] = pred[i][i];                                             \
+            pred[i][i] = p;                                                      \
+        }                                                                        \
+        p->k = key;                                                              \
+        ++kl->n;                                                                 \
+        if (absent)                                                              \
+        {                                                                        \
+            *absent = 1;                                                         \
+        }                                                                        \
+        return &p->v;                                                            \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int ksl_##NAME##_set(kskiplist_##NAME##_t *kl,                               \
+                         KEY key,                                                \
+                         VAL val)                                                \
+    {                                                                            \
+        int absent;                                                              \
+        VAL *v = ksl_##NAME##_put(kl, key, &absent);                             \
+        if (!v)                                                                  \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        *v = val;                                                                \
+        return absent;                                                           \
+    }                                                                            \
+                                                                                 \
+    __NONNULL((1))                                                               \
+    SCOPE                                                                        \
+    int ksl_##NAME##_del(kskiplist_##NAME##_t *kl,                               \
+                         KEY key)                                                \
+    {                                                                            \
+        kskiplist_##NAME##_n **pred[KSKIPLIST_MAX];                              \
+        kskiplist_##NAME##_n *p = ksl_##NAME##_pred_(kl, key, pred)[0];          \
+        if (!p || CMP(key, p->k))                                                \
+        {                                                                        \
+            return -1;                                                           \
+        }                                                                        \
+        for (unsigned int i = 0U; i != p->h; ++i)                                \
+        {                                                                        \
+            pred[i][i] = p->next[i];                                             \
+        }                                                                        \
+        while (kl->h && !kl->head[kl->h - 1U])                                   \
+        {                                                                        \
+            --kl->h;                                                             \
+        }                                                                        \
+        (void)kmp_free(kskiplist_##NAME##_n, kl->kmp[p->h - 1U], p);             \
+        --kl->n;                                                                 \
+        return 0;                                                                \
+    }
+
+#ifndef kskiplist_impl
+/*!
+ @brief          skip list function Initial Microprogram Loading
+ @details        It generates ksl_##name##_init, clear, size, get, put, set,
+                 del, lower, begin and next.
+                 the height of a new node is taken by xorshift64, a level
+                 has a quarter of the nodes of the level below.
+                 lower returns the first node not less than the key, begin
+                 returns the first node, next returns the node after it,
+                 and NULL is the end.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of skip list structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kskiplist_impl(scope, name, key_t, val_t, cmp) \
+    __KSKIPLIST_IMPL(scope, name, key_t, val_t, cmp)
+#endif /* kskiplist_impl */
+
+/* __KSKIPLIST_INIT */
+#undef __KSKIPLIST_INIT
+#define __KSKIPLIST_INIT(NAME, KEY, VAL, CMP)                       \
+    kskiplist_type(NAME, KEY, VAL);                                 \
+    __KSKIPLIST_IMPL(__STATIC_INLINE __UNUSED, NAME, KEY, VAL, CMP)
+
+#ifndef kskiplist_init
+/*!
+ @brief          skip list function Initial Microprogram Loading
+ @param[in]      name: identity name of skip list structure
+ @param[in]      key_t: type of key
+ @param[in]      val_t: type of value
+ @param[in]      cmp: function of compare, cmp(a, b) is a < b
+*/
+#define kskiplist_init(name, key_t, val_t, cmp) \
+    __KSKIPLIST_INIT(name, key_t, val_t, cmp)
+#endif /* kskiplist_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KSKIPLIST_H__ */
+
+/* END OF FILE */
@@ -0,0 +1,409 @@
+/*!
+ @file           ksoa.h
+ @brief          structure of arrays vector library
+ @details        Each field of record is stored in its own contiguous column,
+                 so loops over one column touch only the memory of that field.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KSOA_H__
+#define __KSOA_H__
+
+#include "klib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ A field is written as (type, name). The macros below apply f(x, field)
+ to each field of the variadic list, at most 16 fields are supported.
+*/
+
+#undef __KSOA_NARG
+#undef __KSOA_NARG_
+#define __KSOA_NARG(...) __KSOA_NARG_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define __KSOA_NARG_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+
+#undef __KSOA_CAT
+#undef __KSOA_CAT_
+#define __KSOA_CAT(a, b) __KSOA_CAT_(a, b)
+#define __KSOA_CAT_(a, b) a##b
+
+#undef __KSOA_CALL
+#define __KSOA_CALL(f, ...) f(__VA_ARGS__)
+
+/* type and name of field */
+#undef __KSOA_T
+#undef __KSOA_F
+#define __KSOA_T(t, f) t
+#define __KSOA_F(t, f) f
+
+#undef __KSOA_EACH
+#define __KSOA_EACH(f, x, ...) \
+    __KSOA_CAT(__KSOA_EACH_, __KSOA_NARG(__VA_ARGS__))(f, x, __VA_ARGS__)
+#undef __KSOA_EACH_1
+#undef __KSOA_EACH_2
+#undef __KSOA_EACH_3
+#undef __KSOA_EACH_4
+#undef __KSOA_EACH_5
+#undef __KSOA_EACH_6
+#undef __KSOA_EACH_7
+#undef __KSOA_EACH_8
+#undef __KSOA_EACH_9
+#undef __KSOA_EACH_10
+#undef __KSOA_EACH_11
+#undef __KSOA_EACH_12
+#undef __KSOA_EACH_13
+#undef __KSOA_EACH_14
+#undef __KSOA_EACH_15
+#undef __KSOA_EACH_16
+#define __KSOA_EACH_1(f, x, a) f(x, a)
+#define __KSOA_EACH_2(f, x, a, ...) f(x, a) __KSOA_EACH_1(f, x, __VA_ARGS__)
+#define __KSOA_EACH_3(f, x, a, ...) f(x, a) __KSOA_EACH_2(f, x, __VA_ARGS__)
+#define __KSOA_EACH_4(f, x, a, ...) f(x, a) __KSOA_EACH_3(f, x, __VA_ARGS__)
+#define __KSOA_EACH_5(f, x, a, ...) f(x, a) __KSOA_EACH_4(f, x, __VA_ARGS__)
+#define __KSOA_EACH_6(f, x, a, ...) f(x, a) __KSOA_EACH_5(f, x, __VA_ARGS__)
+#define __KSOA_EACH_7(f, x, a, ...) f(x, a) __KSOA_EACH_6(f, x, __VA_ARGS__)
+#define __KSOA_EACH_8(f, x, a, ...) f(x, a) __KSOA_EACH_7(f, x, __VA_ARGS__)
+#define __KSOA_EACH_9(f, x, a, ...) f(x, a) __KSOA_EACH_8(f, x, __VA_ARGS__)
+#define __KSOA_EACH_10(f, x, a, ...) f(x, a) __KSOA_EACH_9(f, x, __VA_ARGS__)
+#define __KSOA_EACH_11(f, x, a, ...) f(x, a) __KSOA_EACH_10(f, x, __VA_ARGS__)
+#define __KSOA_EACH_12(f, x, a, ...) f(x, a) __KSOA_EACH_11(f, x, __VA_ARGS__)
+#define __KSOA_EACH_13(f, x, a, ...) f(x, a) __KSOA_EACH_12(f, x, __VA_ARGS__)
+#define __KSOA_EACH_14(f, x, a, ...) f(x, a) __KSOA_EACH_13(f, x, __VA_ARGS__)
+#define __KSOA_EACH_15(f, x, a, ...) f(x, a) __KSOA_EACH_14(f, x, __VA_ARGS__)
+#define __KSOA_EACH_16(f, x, a, ...) f(x, a) __KSOA_EACH_15(f, x, __VA_ARGS__)
+
+/* member of column structure */
+#undef __KSOA_COLUMN
+#define __KSOA_COLUMN(x, f) __KSOA_T f *__KSOA_F f;
+
+/* member of row structure */
+#undef __KSOA_MEMBER
+#define __KSOA_MEMBER(x, f) __KSOA_T f __KSOA_F f;
+
+/* kvec_soa_type */
+#ifndef kvec_soa_type
+/*!
+ @brief          Register type of structure of arrays vector
+ @details        ksoa_##name##_t stores a column for each field,
+                 ksoa_##name##_row_t stores a record.
+ @param[in]      name: identity name of vector structure
+ @param[in]      ...: fields of record, written as (type, name)
+*/
+#define kvec_soa_type(name, ...)                                       \
+    typedef struct ksoa_##name##_row_t                                 \
+    {                                                                  \
+        __KSOA_EACH(__KSOA_MEMBER, _, __VA_ARGS__)                     \
+    } ksoa_##name##_row_t;                                             \
+    typedef struct ksoa_##name##_t                                     \
+    {                                                                  \
+        size_t n; /* number of elements  */                            \
+        size_t m; /* size of real memory */                            \
+        __KSOA_EACH(__KSOA_COLUMN, _, __VA_ARGS__)                     \
+    } ksoa_##name##_t
+#endif /* kvec_soa_type */
+
+/* kvec_soa_t */
+#ifndef kvec_soa_t
+/*!
+ @brief          typedef of structure of arrays vector registration
+ @param[in]      name: identity name of vector structure
+*/
+#define kvec_soa_t(name) ksoa_##name##_t
+#endif /* kvec_soa_t */
+
+/* kvec_soa_row_t */
+#ifndef kvec_soa_row_t
+/*!
+ @brief          typedef of record of structure of arrays vector
+ @param[in]      name: identity name of vector structure
+*/
+#define kvec_soa_row_t(name) ksoa_##name##_row_t
+#endif /* kvec_soa_row_t */
+
+/* ksoa_col */
+#ifndef ksoa_col
+/*!
+ @brief          column of field
+ @param[in]      kv: structure of arrays vector
+ @param[in]      f: name of field
+ @return         (kv).f
+*/
+#define ksoa_col(kv, f) (kv).f
+#endif /* ksoa_col */
+
+/* ksoa_v */
+#ifndef ksoa_v
+/*!
+ @brief          field of element whose index is i
+ @param[in]      kv: structure of arrays vector
+ @param[in]      f: name of field
+ @param[in]      i: index of element
+ @return         (kv).f[(i)]
+*/
+#define ksoa_v(kv, f, i) (kv).f[(i)]
+#endif /* ksoa_v */
+
+/* ksoa_size */
+#ifndef ksoa_size
+/*!
+ @brief          number of elements
+ @param[in]      kv: structure of arrays vector
+ @return         (kv).n
+*/
+#define ksoa_size(kv) (kv).n
+#endif /* ksoa_size */
+
+/* ksoa_max */
+#ifndef ksoa_max
+/*!
+ @brief          size of real memory
+ @param[in]      kv: structure of arrays vector
+ @return         (kv).m
+*/
+#define ksoa_max(kv) (kv).m
+#endif /* ksoa_max */
+
+/* statements of each field, x is the context */
+#undef __KSOA_INIT_F
+#define __KSOA_INIT_F(kv, f) (kv)->__KSOA_F f = NULL;
+
+#undef __KSOA_CLEAR_F
+#define __KSOA_CLEAR_F(kv, f) \
+    free((kv)->__KSOA_F f);   \
+    (kv)->__KSOA_F f = NULL;
+
+#undef __KSOA_RESIZE_F
+#undef __KSOA_RESIZE_
+#define __KSOA_RESIZE_F(kv, f) __KSOA_CALL(__KSOA_RESIZE_, kv, __KSOA_T f, __KSOA_F f)
+#define __KSOA_RESIZE_(kv, T, F)                         \
+    {                                                    \
+        void *p = ksize_overflow(n, sizeof(T))           \
+                      ? NULL                             \
+                      : realloc((kv)->F, sizeof(T) * n); \
+        if (p || !n)                                     \
+        {                                                \
+            (kv)->F = (T *)p;                            \
+        }                                                \
+        else                                             \
+        {                                                \
+            ret = -1;                                    \
+        }                                                \
+    }
+
+#undef __KSOA_SET_F
+#define __KSOA_SET_F(i, f) kv->__KSOA_F f[(i)] = r.__KSOA_F f;
+
+#undef __KSOA_GET_F
+#define __KSOA_GET_F(i, f) r->__KSOA_F f = kv->__KSOA_F f[(i)];
+
+#undef __KSOA_COPY_F
+#define __KSOA_COPY_F(n, f) \
+    (void)memcpy(kv1->__KSOA_F f, kv0->__KSOA_F f, sizeof(*kv0->__KSOA_F f) * (n));
+
+#undef __KSOA_ID
+#define __KSOA_ID(...) __VA_ARGS__
+
+#undef __KSOA_COL_F
+#undef __KSOA_COL_
+#define __KSOA_COL_F(x, f) __KSOA_CALL(__KSOA_COL_, __KSOA_ID x, __KSOA_T f, __KSOA_F f)
+#define __KSOA_COL_(SCOPE, NAME, T, F)                        \
+    __NONNULL_ALL                                             \
+    SCOPE                                                     \
+    T *ksoa_##NAME##_##F(const ksoa_##NAME##_t *kv)           \
+    {                                                         \
+        return kv->F;                                         \
+    }
+
+/* __KSOA_IMPL */
+#undef __KSOA_IMPL
+#define __KSOA_IMPL(SCOPE, NAME, ...)                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    void ksoa_##NAME##_init(ksoa_##NAME##_t *kv)                            \
+    {                                                                       \
+        kv->n = 0U;                                                         \
+        kv->m = 0U;                                                         \
+        __KSOA_EACH(__KSOA_INIT_F, kv, __VA_ARGS__)                         \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    void ksoa_##NAME##_clear(ksoa_##NAME##_t *kv)                           \
+    {                                                                       \
+        kv->n = 0U;                                                         \
+        kv->m = 0U;                                                         \
+        __KSOA_EACH(__KSOA_CLEAR_F, kv, __VA_ARGS__)                        \
+    }                                                                       \
+                                                                            \
+    __NONNULL((1))                                                          \
+    SCOPE                                                                   \
+    int ksoa_##NAME##_resize(ksoa_##NAME##_t *kv,                           \
+                             size_t n)                                      \
+    {                                                                       \
+        int ret = 0;                                                        \
+        __KSOA_EACH(__KSOA_RESIZE_F, kv, __VA_ARGS__)                       \
+        if (ret)                                                            \
+        {                                                                   \
+            /* the columns that failed keep the old memory */               \
+            kv->m = n < kv->m ? n : kv->m;                                  \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            kv->m = n;                                                      \
+        }                                                                   \
+        if (kv->n > kv->m)                                                  \
+        {                                                                   \
+            kv->n = kv->m;                                                  \
+        }                                                                   \
+        return ret;                                                         \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    size_t ksoa_##NAME##_size(const ksoa_##NAME##_t *kv)                    \
+    {                                                                       \
+        return kv->n;                                                       \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    size_t ksoa_##NAME##_max(const ksoa_##NAME##_t *kv)                     \
+    {                                                                       \
+        return kv->m;                                                       \
+    }                                                                       \
+                                                                            \
+    __NONNULL((1))                                                          \
+    SCOPE                                                                   \
+    int ksoa_##NAME##_push(ksoa_##NAME##_t *kv,                             \
+                           ksoa_##NAME##_row_t r)                           \
+    {                                                                       \
+        if (kv->n == kv->m)                                                 \
+        {                                                                   \
+            if (ksoa_##NAME##_resize(kv, kv->m ? (kv->m << 1U) : 2U))       \
+            {                                                               \
+                return -1;                                                  \
+            }                                                               \
+        }                                                                   \
+        __KSOA_EACH(__KSOA_SET_F, kv->n, __VA_ARGS__)                       \
+        ++kv->n;                                                            \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int ksoa_##NAME##_pop(ksoa_##NAME##_row_t *r,                           \
+                          ksoa_##NAME##_t *kv)                              \
+    {                                                                       \
+        if (kv->n)                                                          \
+        {                                                                   \
+            --kv->n;                                                        \
+            __KSOA_EACH(__KSOA_GET_F, kv->n, __VA_ARGS__)                   \
+            return 0;                                                       \
+        }                                                                   \
+        return -1;                                                          \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int ksoa_##NAME##_v(ksoa_##NAME##_row_t *r,                             \
+                        const ksoa_##NAME##_t *kv,                          \
+                        size_t i)                                           \
+    {                                                                       \
+        if (i < kv->n)                                                      \
+        {                                                                   \
+            __KSOA_EACH(__KSOA_GET_F, i, __VA_ARGS__)                       \
+            return 0;                                                       \
+        }                                                                   \
+        return -1;                                                          \
+    }                                                                       \
+                                                                            \
+    __NONNULL((1))                                                          \
+    SCOPE                                                                   \
+    int ksoa_##NAME##_set(ksoa_##NAME##_t *kv,                              \
+                          size_t i,                                         \
+                          ksoa_##NAME##_row_t r)                            \
+    {                                                                       \
+        if (i < kv->n)                                                      \
+        {                                                                   \
+            __KSOA_EACH(__KSOA_SET_F, i, __VA_ARGS__)                       \
+            return 0;                                                       \
+        }                                                                   \
+        return -1;                                                          \
+    }                                                                       \
+                                                                            \
+    __NONNULL_ALL                                                           \
+    SCOPE                                                                   \
+    int ksoa_##NAME##_copy(ksoa_##NAME##_t *kv1,                            \
+                           const ksoa_##NAME##_t *kv0)                      \
+    {                                                                       \
+        if (kv1->m < kv0->n)                                                \
+        {                                                                   \
+            if (ksoa_##NAME##_resize(kv1, kv0->n))                          \
+            {                                                               \
+                return -1;                                                  \
+            }                                                               \
+        }                                                                   \
+        kv1->n = kv0->n;                                                    \
+        __KSOA_EACH(__KSOA_COPY_F, kv0->n, __VA_ARGS__)                     \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __KSOA_EACH(__KSOA_COL_F, (SCOPE, NAME), __VA_ARGS__)
+
+#ifndef kvec_soa_impl
+/*!
+ @brief          Structure of arrays vector function Initial Microprogram Loading
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of vector structure
+ @param[in]      ...: fields of record, written as (type, name)
+*/
+#define kvec_soa_impl(scope, name, ...) __KSOA_IMPL(scope, name, __VA_ARGS__)
+#endif /* kvec_soa_impl */
+
+/* __KSOA_INIT */
+#undef __KSOA_INIT
+#define __KSOA_INIT(NAME, ...)             \
+    kvec_soa_type(NAME, __VA_ARGS__);      \
+    __KSOA_IMPL(__STATIC_INLINE __UNUSED, NAME, __VA_ARGS__)
+
+#ifndef kvec_soa_init
+/*!
+ @brief          Structure of arrays vector function Initial Microprogram Loading
+ @details        It generates ksoa_##name##_init, clear, resize, size, max,
+                 push, pop, v, set, copy and ksoa_##name##_##field
+                 that returns the column of field.
+ @param[in]      name: identity name of vector structure
+ @param[in]      ...: fields of record, written as (type, name)
+*/
+#define kvec_soa_init(name, ...) __KSOA_INIT(name, __VA_ARGS__)
+#endif /* kvec_soa_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KSOA_H__ */
+
+/* END OF FILE */
@@ -1,8 +1,9 @@
 /*!
  @file           ksort.h
  @brief          sort library
- @details        generic sort, including introsort, merge sort, heap sort,
-                 comb sort, Knuth shuffle and  k-small algorithm.
+ @details        generic sort, including introsort, pattern-defeating
+                 quicksort, merge sort, adaptive merge sort, heap sort, comb
+                 sort, LSD radix sort, Knuth shuffle and  k-small algorithm.
  @author         tqfx tqfx@foxmail.com
  @version        0
  @date           2021-05-31
@@ -33,6 +34,7 @@
 
 #include "klib.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -134,6 +136,372 @@
     } while (0)
 #endif /* ksort_merge */
 
+/* adaptive merge sort */
+
+/* a natural run shorter than it is extended by binary insertion */
+#ifndef KSORT_TIM_RUN
+#define KSORT_TIM_RUN 32U
+#endif /* KSORT_TIM_RUN */
+
+/* wins in a row of a run before merge gallops */
+#ifndef KSORT_TIM_GALLOP
+#define KSORT_TIM_GALLOP 7U
+#endif /* KSORT_TIM_GALLOP */
+
+/* first i in [0, n) that cond is false for, by exponential search */
+#undef __KSORT_GALLOP
+#define __KSORT_GALLOP(ret, n, i, cond)         \
+    do                                          \
+    {                                           \
+        size_t _g_n = (n);                      \
+        size_t _g_lo = 0U, _g_hi = 1U;          \
+        size_t i = 0U;                          \
+        if (!_g_n || !(cond))                   \
+        {                                       \
+            ret = 0U;                           \
+            break;                              \
+        }                                       \
+        while (_g_hi < _g_n)                    \
+        {                                       \
+            i = _g_hi;                          \
+            if (!(cond))                        \
+            {                                   \
+                break;                          \
+            }                                   \
+            _g_lo = _g_hi;                      \
+            _g_hi = (_g_hi << 1) + 1U;          \
+        }                                       \
+        _g_hi = _g_hi < _g_n ? _g_hi : _g_n;    \
+        for (++_g_lo; _g_lo < _g_hi;)           \
+        {                                       \
+            i = _g_lo + ((_g_hi - _g_lo) >> 1); \
+            if (cond)                           \
+            {                                   \
+                _g_lo = i + 1U;                 \
+            }                                   \
+            else                                \
+            {                                   \
+                _g_hi = i;                      \
+            }                                   \
+        }                                       \
+        ret = _g_lo;                            \
+    } while (0)
+
+/* p[0, s) is sorted, p[s, e) are inserted after their equal elements */
+#undef __KSORT_BINARY_INSERT
+#define __KSORT_BINARY_INSERT(t, p, s, e, func)                   \
+    do                                                            \
+    {                                                             \
+        for (size_t _bi_i = (s); _bi_i < (e); ++_bi_i)            \
+        {                                                         \
+            t _bi_x = (p)[_bi_i];                                 \
+            size_t _bi_lo = 0U, _bi_hi = _bi_i;                   \
+            while (_bi_lo < _bi_hi)                               \
+            {                                                     \
+                size_t _bi_m = _bi_lo + ((_bi_hi - _bi_lo) >> 1); \
+                if (func(_bi_x, (p)[_bi_m]))                      \
+                {                                                 \
+                    _bi_hi = _bi_m;                               \
+                }                                                 \
+                else                                              \
+                {                                                 \
+                    _bi_lo = _bi_m + 1U;                          \
+                }                                                 \
+            }                                                     \
+            (void)memmove((p) + _bi_lo + 1U, (p) + _bi_lo,        \
+                          sizeof(t) * (_bi_i - _bi_lo));          \
+            (p)[_bi_lo] = _bi_x;                                  \
+        }                                                         \
+    } while (0)
+
+/* a is copied to buffer and merged with b from the first */
+#undef __KSORT_MERGE_LO
+#define __KSORT_MERGE_LO(t, a, na, b, nb, buf, mg, func)                  \
+    do                                                                    \
+    {                                                                     \
+        t *_lo_d = (a);                                                   \
+        t *_lo_a = (buf);                                                 \
+        t *_lo_ae = (buf) + (na);                                         \
+        t *_lo_b = (b);                                                   \
+        t *_lo_be = (b) + (nb);                                           \
+        (void)memcpy(_lo_a, (a), sizeof(t) * (na));                       \
+        while (_lo_a != _lo_ae && _lo_b != _lo_be)                        \
+        {                                                                 \
+            size_t _lo_ca = 0U, _lo_cb = 0U;                              \
+            while (_lo_a != _lo_ae && _lo_b != _lo_be &&                  \
+                   _lo_ca < (mg) && _lo_cb < (mg))                        \
+            {                                                             \
+                if (func(*_lo_b, *_lo_a))                                 \
+                {                                                         \
+                    *_lo_d++ = *_lo_b++;                                  \
+                    ++_lo_cb;                                             \
+                    _lo_ca = 0U;                                          \
+                }                                                         \
+                else                                                      \
+                {                                                         \
+                    *_lo_d++ = *_lo_a++;                                  \
+                    ++_lo_ca;                                             \
+                    _lo_cb = 0U;                                          \
+                }                                                         \
+            }                                                             \
+            while (_lo_a != _lo_ae && _lo_b != _lo_be)                    \
+            {                                                             \
+                size_t _lo_k = 0U, _lo_j = 0U;                            \
+                __KSORT_GALLOP(_lo_k, (size_t)(_lo_ae - _lo_a), _lo_i,    \
+                               !func(*_lo_b, _lo_a[_lo_i]));              \
+                (void)memcpy(_lo_d, _lo_a, sizeof(t) * _lo_k);            \
+                _lo_d += _lo_k;                                           \
+                _lo_a += _lo_k;                                           \
+                if (_lo_a == _lo_ae)                                      \
+                {                                                         \
+                    break;                                                \
+                }                                                         \
+                __KSORT_GALLOP(_lo_j, (size_t)(_lo_be - _lo_b), _lo_i,    \
+                               func(_lo_b[_lo_i], *_lo_a));               \
+                (void)memmove(_lo_d, _lo_b, sizeof(t) * _lo_j);           \
+                _lo_d += _lo_j;                                           \
+                _lo_b += _lo_j;                                           \
+                if (_lo_k < KSORT_TIM_GALLOP && _lo_j < KSORT_TIM_GALLOP) \
+                {                                                         \
+                    ++(mg);                                               \
+                    break;                                                \
+                }                                                         \
+                (mg) -= (mg) > 1U ? 1U : 0U;                              \
+            }                                                             \
+        }                                                                 \
+        (void)memcpy(_lo_d, _lo_a, sizeof(t) * (size_t)(_lo_ae - _lo_a)); \
+    } while (0)
+
+/* b is copied to buffer and merged with a from the last */
+#undef __KSORT_MERGE_HI
+#define __KSORT_MERGE_HI(t, a, na, b, nb, buf, mg, func)                     \
+    do                                                                       \
+    {                                                                        \
+        t *_hi_d = (b) + (nb);                                               \
+        t *_hi_a = (b);                                                      \
+        t *_hi_as = (a);                                                     \
+        t *_hi_b = (buf) + (nb);                                             \
+        t *_hi_bs = (buf);                                                   \
+        (void)memcpy(_hi_bs, (b), sizeof(t) * (nb));                         \
+        while (_hi_a != _hi_as && _hi_b != _hi_bs)                           \
+        {                                                                    \
+            size_t _hi_ca = 0U, _hi_cb = 0U;                                 \
+            while (_hi_a != _hi_as && _hi_b != _hi_bs &&                     \
+                   _hi_ca < (mg) && _hi_cb < (mg))                           \
+            {                                                                \
+                if (func(*(_hi_b - 1U), *(_hi_a - 1U)))                      \
+                {                                                            \
+                    *--_hi_d = *--_hi_a;                                     \
+                    ++_hi_ca;                                                \
+                    _hi_cb = 0U;                                             \
+                }                                                            \
+                else                                                         \
+                {                                                            \
+                    *--_hi_d = *--_hi_b;                                     \
+                    ++_hi_cb;                                                \
+                    _hi_ca = 0U;                                             \
+                }                                                            \
+            }                                                                \
+            while (_hi_a != _hi_as && _hi_b != _hi_bs)                       \
+            {                                                                \
+                size_t _hi_k = 0U, _hi_j = 0U;                               \
+                __KSORT_GALLOP(_hi_k, (size_t)(_hi_a - _hi_as), _hi_i,       \
+                               func(*(_hi_b - 1U), *(_hi_a - 1U - _hi_i)));  \
+                _hi_d -= _hi_k;                                              \
+                _hi_a -= _hi_k;                                              \
+                (void)memmove(_hi_d, _hi_a, sizeof(t) * _hi_k);              \
+                if (_hi_a == _hi_as)                                         \
+                {                                                            \
+                    break;                                                   \
+                }                                                            \
+                __KSORT_GALLOP(_hi_j, (size_t)(_hi_b - _hi_bs), _hi_i,       \
+                               !func(*(_hi_b - 1U - _hi_i), *(_hi_a - 1U))); \
+                _hi_d -= _hi_j;                                              \
+                _hi_b -= _hi_j;                                              \
+                (void)memcpy(_hi_d, _hi_b, sizeof(t) * _hi_j);               \
+                if (_hi_k < KSORT_TIM_GALLOP && _hi_j < KSORT_TIM_GALLOP)    \
+                {                                                            \
+                    ++(mg);                                                  \
+                    break;                                                   \
+                }                                                            \
+                (mg) -= (mg) > 1U ? 1U : 0U;                                 \
+            }                                                                \
+        }                                                                    \
+        (void)memcpy(_hi_as, _hi_bs, sizeof(t) * (size_t)(_hi_b - _hi_bs));  \
+    } while (0)
+
+/* merge the sorted runs a[0, na) and a[na, na + nb) */
+#undef __KSORT_MERGE_RUN
+#define __KSORT_MERGE_RUN(t, a, na, nb, buf, mg, func)                         \
+    do                                                                         \
+    {                                                                          \
+        t *_mr_a = (a);                                                        \
+        size_t _mr_na = (na);                                                  \
+        t *_mr_b = _mr_a + _mr_na;                                             \
+        size_t _mr_nb = (nb);                                                  \
+        size_t _mr_k = 0U;                                                     \
+        /* the first elements of a not greater than b[0] are in place */       \
+        __KSORT_GALLOP(_mr_k, _mr_na, _mr_i, !func(*_mr_b, _mr_a[_mr_i]));     \
+        _mr_a += _mr_k;                                                        \
+        _mr_na -= _mr_k;                                                       \
+        if (_mr_na == 0U)                                                      \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+        /* the last elements of b not less than the last of a too */           \
+        __KSORT_GALLOP(_mr_k, _mr_nb, _mr_i,                                   \
+                       !func(_mr_b[_mr_nb - 1U - _mr_i], _mr_a[_mr_na - 1U])); \
+        _mr_nb -= _mr_k;                                                       \
+        /* the shorter run is copied to buffer */                              \
+        if (_mr_na <= _mr_nb)                                                  \
+        {                                                                      \
+            __KSORT_MERGE_LO(t, _mr_a, _mr_na, _mr_b, _mr_nb, buf, mg, func);  \
+        }                                                                      \
+        else                                                                   \
+        {                                                                      \
+            __KSORT_MERGE_HI(t, _mr_a, _mr_na, _mr_b, _mr_nb, buf, mg, func);  \
+        }                                                                      \
+    } while (0)
+
+/* powersort, power of the boundary of runs [s, s + n1) and [s + n1, s + n1 + n2) */
+#undef __KSORT_POWER
+#define __KSORT_POWER(ret, s, n1, n2, n)    \
+    do                                      \
+    {                                       \
+        size_t _pw_a = 2U * (s) + (n1);     \
+        size_t _pw_b = _pw_a + (n1) + (n2); \
+        ret = 0U;                           \
+        for (;;)                            \
+        {                                   \
+            ++ret;                          \
+            if (_pw_a >= (n))               \
+            {                               \
+                _pw_a -= (n);               \
+                _pw_b -= (n);               \
+            }                               \
+            else if (_pw_b >= (n))          \
+            {                               \
+                break;                      \
+            }                               \
+            _pw_a <<= 1;                    \
+            _pw_b <<= 1;                    \
+        }                                   \
+    } while (0)
+
+#ifndef ksort_tim
+/*!
+ @brief          Adaptive merge sort, stable
+ @details        Natural runs are found and a descending one is reversed,
+                 a run shorter than KSORT_TIM_RUN is extended by binary
+                 insertion. The runs are merged by the powersort policy,
+                 the merge gallops when one run wins many times in a row,
+                 and the elements in place at both ends are skipped.
+                 Sorted or nearly sorted data is in close to linear time.
+ @param[in]      t: type of data array
+ @param[in]      p: pointer of data array
+ @param[in]      n: length of data array
+ @param[in]      func: function of compare
+ @param[in]      a: pointer of buffer, length >= n / 2, it is allocated if NULL,
+                 the array is not sorted if it is out of memory
+*/
+#define ksort_tim(t, p, n, func, a)                                             \
+    do                                                                          \
+    {                                                                           \
+        size_t _tim_n = (n);                                                    \
+        if (_tim_n < 2U)                                                        \
+        {                                                                       \
+            break;                                                              \
+        }                                                                       \
+        t *_tim_p = (p);                                                        \
+        t *_tim_a = (a)                                                         \
+                        ? (a)                                                   \
+                        : (t *)malloc(sizeof(*(p)) * (_tim_n >> 1));            \
+        if (!_tim_a)                                                            \
+        {                                                                       \
+            /* out of memory, the array is left as it is */                     \
+            break;                                                              \
+        }                                                                       \
+        size_t _tim_rs[sizeof(size_t) * 8U + 1U];                               \
+        size_t _tim_rn[sizeof(size_t) * 8U + 1U];                               \
+        unsigned int _tim_rp[sizeof(size_t) * 8U + 1U];                         \
+        unsigned int _tim_top = 0U;                                             \
+        size_t _tim_mg = KSORT_TIM_GALLOP;                                      \
+        for (size_t _tim_s = 0U; _tim_s != _tim_n;)                             \
+        {                                                                       \
+            /* a natural run, a strictly descending one is reversed */          \
+            size_t _tim_e = _tim_s + 1U;                                        \
+            if (_tim_e != _tim_n)                                               \
+            {                                                                   \
+                if (func(_tim_p[_tim_e], _tim_p[_tim_s]))                       \
+                {                                                               \
+                    do                                                          \
+                    {                                                           \
+                        ++_tim_e;                                               \
+                    } while (_tim_e != _tim_n &&                                \
+                             func(_tim_p[_tim_e], _tim_p[_tim_e - 1U]));        \
+                    for (size_t _tim_i = _tim_s, _tim_j = _tim_e - 1U;          \
+                         _tim_i < _tim_j; ++_tim_i, --_tim_j)                   \
+                    {                                                           \
+                        ksort_swap(t, _tim_p[_tim_i], _tim_p[_tim_j]);          \
+                    }                                                           \
+                }                                                               \
+                else                                                            \
+                {                                                               \
+                    do                                                          \
+                    {                                                           \
+                        ++_tim_e;                                               \
+                    } while (_tim_e != _tim_n &&                                \
+                             !func(_tim_p[_tim_e], _tim_p[_tim_e - 1U]));       \
+                }                                                               \
+            }                                                                   \
+            /* a short run is extended by binary insertion */                   \
+            if (_tim_e - _tim_s < KSORT_TIM_RUN && _tim_e != _tim_n)            \
+            {                                                                   \
+                size_t _tim_r = _tim_n - _tim_s < KSORT_TIM_RUN                 \
+                                    ? _tim_n                                    \
+                                    : _tim_s + KSORT_TIM_RUN;                   \
+                __KSORT_BINARY_INSERT(t, _tim_p + _tim_s, _tim_e - _tim_s,      \
+                                      _tim_r - _tim_s, func);                   \
+                _tim_e = _tim_r;                                                \
+            }                                                                   \
+            /* the runs of higher power than the new boundary are merged */     \
+            if (_tim_top)                                                       \
+            {                                                                   \
+                unsigned int _tim_w = 0U;                                       \
+                __KSORT_POWER(_tim_w, _tim_rs[_tim_top - 1U],                   \
+                              _tim_rn[_tim_top - 1U], _tim_e - _tim_s, _tim_n); \
+                while (_tim_top > 1U && _tim_rp[_tim_top - 2U] > _tim_w)        \
+                {                                                               \
+                    __KSORT_MERGE_RUN(t, _tim_p + _tim_rs[_tim_top - 2U],       \
+                                      _tim_rn[_tim_top - 2U],                   \
+                                      _tim_rn[_tim_top - 1U],                   \
+                                      _tim_a, _tim_mg, func);                   \
+                    _tim_rn[_tim_top - 2U] += _tim_rn[_tim_top - 1U];           \
+                    --_tim_top;                                                 \
+                }                                                               \
+                _tim_rp[_tim_top - 1U] = _tim_w;                                \
+            }                                                                   \
+            _tim_rs[_tim_top] = _tim_s;                                         \
+            _tim_rn[_tim_top] = _tim_e - _tim_s;                                \
+            ++_tim_top;                                                         \
+            _tim_s = _tim_e;                                                    \
+        }                                                                       \
+        for (; _tim_top > 1U; --_tim_top)                                       \
+        {                                                                       \
+            __KSORT_MERGE_RUN(t, _tim_p + _tim_rs[_tim_top - 2U],               \
+                              _tim_rn[_tim_top - 2U],                           \
+                              _tim_rn[_tim_top - 1U],                           \
+                              _tim_a, _tim_mg, func);                           \
+            _tim_rn[_tim_top - 2U] += _tim_rn[_tim_top - 1U];                   \
+        }                                                                       \
+        if (!(a))                                                               \
+        {                                                                       \
+            free(_tim_a);                                                       \
+            _tim_a = NULL;                                                      \
+        }                                                                       \
+    } while (0)
+#endif /* ksort_tim */
+
 /* heap adjust */
 #ifndef ksort_heap_adjust
 /*!
@@ -430,6 +798,441 @@ typedef struct ksort_stack_t
     } while (0)
 #endif /* ksort_intro */
 
+/* pattern-defeating quicksort */
+
+/* a range shorter than it is sorted by insertion sort */
+#ifndef KSORT_PDQ_INSERT
+#define KSORT_PDQ_INSERT 24U
+#endif /* KSORT_PDQ_INSERT */
+
+/* the pivot is the ninther of a range longer than it */
+#ifndef KSORT_PDQ_NINTHER
+#define KSORT_PDQ_NINTHER 128U
+#endif /* KSORT_PDQ_NINTHER */
+
+/* elements of a block of branchless partition, at most 255 */
+#ifndef KSORT_PDQ_BLOCK
+#define KSORT_PDQ_BLOCK 64U
+#endif /* KSORT_PDQ_BLOCK */
+#if KSORT_PDQ_BLOCK > 255
+/* the offsets of a block and one past them are stored in unsigned char */
+#error KSORT_PDQ_BLOCK must be at most 255
+#endif /* KSORT_PDQ_BLOCK */
+
+/* moves of insertion sort on a partitioned range before it gives up */
+#ifndef KSORT_PDQ_PARTIAL
+#define KSORT_PDQ_PARTIAL 8U
+#endif /* KSORT_PDQ_PARTIAL */
+
+#undef __KSORT_SORT2
+#define __KSORT_SORT2(t, a, b, func)   \
+    do                                 \
+    {                                  \
+        if (func(*(b), *(a)))          \
+        {                              \
+            ksort_swap(t, *(a), *(b)); \
+        }                              \
+    } while (0)
+
+#undef __KSORT_SORT3
+#define __KSORT_SORT3(t, a, b, c, func) \
+    do                                  \
+    {                                   \
+        __KSORT_SORT2(t, a, b, func);   \
+        __KSORT_SORT2(t, b, c, func);   \
+        __KSORT_SORT2(t, a, b, func);   \
+    } while (0)
+
+#undef __KSORT_SWAP_OFFSETS
+#define __KSORT_SWAP_OFFSETS(t, i, j, l, r, m, swaps)                    \
+    do                                                                   \
+    {                                                                    \
+        if (swaps)                                                       \
+        {                                                                \
+            for (size_t _so_k = 0U; _so_k != (m); ++_so_k)               \
+            {                                                            \
+                ksort_swap(t, *((i) + (l)[_so_k]), *((j) - (r)[_so_k])); \
+            }                                                            \
+        }                                                                \
+        else if (m)                                                      \
+        {                                                                \
+            /* a cycle of moves instead of the swaps */                  \
+            t *_so_l = (i) + (l)[0U];                                    \
+            t *_so_r = (j) - (r)[0U];                                    \
+            t _so_x = *_so_l;                                            \
+            *_so_l = *_so_r;                                             \
+            for (size_t _so_k = 1U; _so_k != (m); ++_so_k)               \
+            {                                                            \
+                _so_l = (i) + (l)[_so_k];                                \
+                *_so_r = *_so_l;                                         \
+                _so_r = (j) - (r)[_so_k];                                \
+                *_so_l = *_so_r;                                         \
+            }                                                            \
+            *_so_r = _so_x;                                              \
+        }                                                                \
+    } while (0)
+
+/* offsets of the elements that are not less than x in the left block */
+#undef __KSORT_BLOCK_L
+#define __KSORT_BLOCK_L(t, o, c, i, m, x, func)        \
+    do                                                 \
+    {                                                  \
+        t *_bl_k = (i);                                \
+        for (size_t _bl_b = 0U; _bl_b != (m); ++_bl_b) \
+        {                                              \
+            (o)[c] = (unsigned char)_bl_b;             \
+            c += func(*_bl_k, x) ? 0U : 1U;            \
+            ++_bl_k;                                   \
+        }                                              \
+    } while (0)
+
+/* offsets of the elements that are less than x in the right block */
+#undef __KSORT_BLOCK_R
+#define __KSORT_BLOCK_R(t, o, c, j, m, x, func)        \
+    do                                                 \
+    {                                                  \
+        t *_br_k = (j);                                \
+        for (size_t _br_b = 0U; _br_b != (m); ++_br_b) \
+        {                                              \
+            (o)[c] = (unsigned char)(_br_b + 1U);      \
+            c += func(*--_br_k, x) ? 1U : 0U;          \
+        }                                              \
+    } while (0)
+
+/* insertion sort, ret is 0 if it gives up */
+#undef __KSORT_PARTIAL
+#define __KSORT_PARTIAL(t, ret, s, e, func)                                    \
+    do                                                                         \
+    {                                                                          \
+        t *_pi_s = (s);                                                        \
+        t *_pi_e = (e);                                                        \
+        size_t _pi_c = 0U;                                                     \
+        ret = 1;                                                               \
+        for (t *_pi_i = _pi_s + 1U; _pi_s != _pi_e && _pi_i != _pi_e; ++_pi_i) \
+        {                                                                      \
+            t *_pi_j = _pi_i;                                                  \
+            t *_pi_k = _pi_i - 1U;                                             \
+            if (func(*_pi_j, *_pi_k))                                          \
+            {                                                                  \
+                t _pi_x = *_pi_j;                                              \
+                do                                                             \
+                {                                                              \
+                    *_pi_j-- = *_pi_k;                                         \
+                } while (_pi_j != _pi_s && func(_pi_x, *--_pi_k));             \
+                *_pi_j = _pi_x;                                                \
+                _pi_c += (size_t)(_pi_i - _pi_j);                              \
+            }                                                                  \
+            if (_pi_c > KSORT_PDQ_PARTIAL)                                     \
+            {                                                                  \
+                ret = 0;                                                       \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+#ifndef ksort_pdq
+/*!
+ @brief          Pattern-defeating quicksort
+ @details        The pivot is the median of 3, or the ninther of a long
+                 range. Partition compares a block of elements at a time
+                 without branches, and a range whose pivot is equal to the
+                 one before it puts the equal elements together, so many
+                 duplicates are in linear time. A range that needed no swap
+                 is tried by insertion sort, sorted and reversed input are
+                 in linear time. After log(n) bad partitions heap sort is
+                 used, the worst case is O(n log n). It is not stable.
+ @param[in]      t: type of data array
+ @param[in]      p: pointer of data array
+ @param[in]      n: length of data array
+ @param[in]      func: function of compare
+*/
+#define ksort_pdq(t, p, n, func)                                                                \
+    do                                                                                          \
+    {                                                                                           \
+        ksort_stack_t _pdq_stack[sizeof(size_t) * 8U];                                          \
+        ksort_stack_t *_pdq_top = _pdq_stack;                                                   \
+        t *_pdq_s = (p);                                                                        \
+        t *_pdq_e = (p) + (n);                                                                  \
+        unsigned int _pdq_bad = 1U;                                                             \
+        while (((size_t)1 << _pdq_bad) < (size_t)(_pdq_e - _pdq_s))                             \
+        {                                                                                       \
+            ++_pdq_bad;                                                                         \
+        }                                                                                       \
+        for (;;)                                                                                \
+        {                                                                                       \
+            int _pdq_pop = 0;                                                                   \
+            size_t _pdq_n = (size_t)(_pdq_e - _pdq_s);                                          \
+            if (_pdq_n < KSORT_PDQ_INSERT)                                                      \
+            {                                                                                   \
+                if (_pdq_n > 1U)                                                                \
+                {                                                                               \
+                    ksort_insert(t, _pdq_s, _pdq_n, func);                                      \
+                }                                                                               \
+                _pdq_pop = 1;                                                                   \
+            }                                                                                   \
+            else                                                                                \
+            {                                                                                   \
+                /* the pivot is moved to the first */                                           \
+                size_t _pdq_h = _pdq_n >> 1;                                                    \
+                if (_pdq_n > KSORT_PDQ_NINTHER)                                                 \
+                {                                                                               \
+                    __KSORT_SORT3(t, _pdq_s, _pdq_s + _pdq_h, _pdq_e - 1U, func);               \
+                    __KSORT_SORT3(t, _pdq_s + 1U, _pdq_s + (_pdq_h - 1U), _pdq_e - 2U, func);   \
+                    __KSORT_SORT3(t, _pdq_s + 2U, _pdq_s + (_pdq_h + 1U), _pdq_e - 3U, func);   \
+                    __KSORT_SORT3(t, _pdq_s + (_pdq_h - 1U), _pdq_s + _pdq_h,                   \
+                                  _pdq_s + (_pdq_h + 1U), func);                                \
+                    ksort_swap(t, *_pdq_s, *(_pdq_s + _pdq_h));                                 \
+                }                                                                               \
+                else                                                                            \
+                {                                                                               \
+                    __KSORT_SORT3(t, _pdq_s + _pdq_h, _pdq_s, _pdq_e - 1U, func);               \
+                }                                                                               \
+                t _pdq_x = *_pdq_s;                                                             \
+                t *_pdq_i = _pdq_s;                                                             \
+                t *_pdq_j = _pdq_e;                                                             \
+                if (_pdq_s != (p) && !func(*(_pdq_s - 1U), _pdq_x))                             \
+                {                                                                               \
+                    /* the pivot is equal to the one before the range,                          \
+                       so the elements equal to it are put to the left */                       \
+                    while (func(_pdq_x, *--_pdq_j))                                             \
+                    {                                                                           \
+                    }                                                                           \
+                    if (_pdq_j + 1U == _pdq_e)                                                  \
+                    {                                                                           \
+                        while (_pdq_i < _pdq_j && !func(_pdq_x, *++_pdq_i))                     \
+                        {                                                                       \
+                        }                                                                       \
+                    }                                                                           \
+                    else                                                                        \
+                    {                                                                           \
+                        while (!func(_pdq_x, *++_pdq_i))                                        \
+                        {                                                                       \
+                        }                                                                       \
+                    }                                                                           \
+                    while (_pdq_i < _pdq_j)                                                     \
+                    {                                                                           \
+                        ksort_swap(t, *_pdq_i, *_pdq_j);                                        \
+                        while (func(_pdq_x, *--_pdq_j))                                         \
+                        {                                                                       \
+                        }                                                                       \
+                        while (!func(_pdq_x, *++_pdq_i))                                        \
+                        {                                                                       \
+                        }                                                                       \
+                    }                                                                           \
+                    *_pdq_s = *_pdq_j;                                                          \
+                    *_pdq_j = _pdq_x;                                                           \
+                    _pdq_s = _pdq_j + 1U;                                                       \
+                    continue;                                                                   \
+                }                                                                               \
+                while (func(*++_pdq_i, _pdq_x))                                                 \
+                {                                                                               \
+                }                                                                               \
+                if (_pdq_i - 1U == _pdq_s)                                                      \
+                {                                                                               \
+                    while (_pdq_i < _pdq_j && !func(*--_pdq_j, _pdq_x))                         \
+                    {                                                                           \
+                    }                                                                           \
+                }                                                                               \
+                else                                                                            \
+                {                                                                               \
+                    while (!func(*--_pdq_j, _pdq_x))                                            \
+                    {                                                                           \
+                    }                                                                           \
+                }                                                                               \
+                /* no swap is needed, the range may be sorted already */                        \
+                int _pdq_ok = _pdq_i >= _pdq_j;                                                 \
+                if (!_pdq_ok)                                                                   \
+                {                                                                               \
+                    /* the comparisons of a block are stored as offsets                         \
+                       without branches, then the elements are swapped */                       \
+                    unsigned char _pdq_ol[KSORT_PDQ_BLOCK];                                     \
+                    unsigned char _pdq_or[KSORT_PDQ_BLOCK];                                     \
+                    size_t _pdq_nl = 0U, _pdq_nr = 0U;                                          \
+                    size_t _pdq_sl = 0U, _pdq_sr = 0U;                                          \
+                    size_t _pdq_m = 0U;                                                         \
+                    ksort_swap(t, *_pdq_i, *_pdq_j);                                            \
+                    ++_pdq_i;                                                                   \
+                    while ((size_t)(_pdq_j - _pdq_i) > 2U * KSORT_PDQ_BLOCK)                    \
+                    {                                                                           \
+                        if (_pdq_nl == 0U)                                                      \
+                        {                                                                       \
+                            _pdq_sl = 0U;                                                       \
+                            __KSORT_BLOCK_L(t, _pdq_ol, _pdq_nl, _pdq_i,                        \
+                                            KSORT_PDQ_BLOCK, _pdq_x, func);                     \
+                        }                                                                       \
+                        if (_pdq_nr == 0U)                                                      \
+                        {                                                                       \
+                            _pdq_sr = 0U;                                                       \
+                            __KSORT_BLOCK_R(t, _pdq_or, _pdq_nr, _pdq_j,                        \
+                                            KSORT_PDQ_BLOCK, _pdq_x, func);                     \
+                        }                                                                       \
+                        _pdq_m = _pdq_nl < _pdq_nr ? _pdq_nl : _pdq_nr;                         \
+                        __KSORT_SWAP_OFFSETS(t, _pdq_i, _pdq_j,                                 \
+                                             _pdq_ol + _pdq_sl, _pdq_or + _pdq_sr,              \
+                                             _pdq_m, _pdq_nl == _pdq_nr);                       \
+                        _pdq_nl -= _pdq_m;                                                      \
+                        _pdq_nr -= _pdq_m;                                                      \
+                        _pdq_sl += _pdq_m;                                                      \
+                        _pdq_sr += _pdq_m;                                                      \
+                        if (_pdq_nl == 0U)                                                      \
+                        {                                                                       \
+                            _pdq_i += KSORT_PDQ_BLOCK;                                          \
+                        }                                                                       \
+                        if (_pdq_nr == 0U)                                                      \
+                        {                                                                       \
+                            _pdq_j -= KSORT_PDQ_BLOCK;                                          \
+                        }                                                                       \
+                    }                                                                           \
+                    /* the last blocks are shorter */                                           \
+                    size_t _pdq_u = (size_t)(_pdq_j - _pdq_i) -                                 \
+                                    (_pdq_nl || _pdq_nr ? KSORT_PDQ_BLOCK : 0U);                \
+                    size_t _pdq_ls = _pdq_u >> 1, _pdq_rs = _pdq_u - _pdq_ls;                   \
+                    if (_pdq_nr)                                                                \
+                    {                                                                           \
+                        _pdq_ls = _pdq_u;                                                       \
+                        _pdq_rs = KSORT_PDQ_BLOCK;                                              \
+                    }                                                                           \
+                    else if (_pdq_nl)                                                           \
+                    {                                                                           \
+                        _pdq_ls = KSORT_PDQ_BLOCK;                                              \
+                        _pdq_rs = _pdq_u;                                                       \
+                    }                                                                           \
+                    if (_pdq_u && _pdq_nl == 0U)                                                \
+                    {                                                                           \
+                        _pdq_sl = 0U;                                                           \
+                        __KSORT_BLOCK_L(t, _pdq_ol, _pdq_nl, _pdq_i,                            \
+                                        _pdq_ls, _pdq_x, func);                                 \
+                    }                                                                           \
+                    if (_pdq_u && _pdq_nr == 0U)                                                \
+                    {                                                                           \
+                        _pdq_sr = 0U;                                                           \
+                        __KSORT_BLOCK_R(t, _pdq_or, _pdq_nr, _pdq_j,                            \
+                                        _pdq_rs, _pdq_x, func);                                 \
+                    }                                                                           \
+                    _pdq_m = _pdq_nl < _pdq_nr ? _pdq_nl : _pdq_nr;                             \
+                    __KSORT_SWAP_OFFSETS(t, _pdq_i, _pdq_j,                                     \
+                                         _pdq_ol + _pdq_sl, _pdq_or + _pdq_sr,                  \
+                                         _pdq_m, _pdq_nl == _pdq_nr);                           \
+                    _pdq_nl -= _pdq_m;                                                          \
+                    _pdq_nr -= _pdq_m;                                                          \
+                    _pdq_sl += _pdq_m;                                                          \
+                    _pdq_sr += _pdq_m;                                                          \
+                    if (_pdq_nl == 0U)                                                          \
+                    {                                                                           \
+                        _pdq_i += _pdq_ls;                                                      \
+                    }                                                                           \
+                    if (_pdq_nr == 0U)                                                          \
+                    {                                                                           \
+                        _pdq_j -= _pdq_rs;                                                      \
+                    }                                                                           \
+                    /* the offsets left of one side */                                          \
+                    if (_pdq_nl)                                                                \
+                    {                                                                           \
+                        while (_pdq_nl--)                                                       \
+                        {                                                                       \
+                            --_pdq_j;                                                           \
+                            ksort_swap(t, *(_pdq_i + _pdq_ol[_pdq_sl + _pdq_nl]), *_pdq_j);     \
+                        }                                                                       \
+                        _pdq_i = _pdq_j;                                                        \
+                    }                                                                           \
+                    if (_pdq_nr)                                                                \
+                    {                                                                           \
+                        while (_pdq_nr--)                                                       \
+                        {                                                                       \
+                            ksort_swap(t, *(_pdq_j - _pdq_or[_pdq_sr + _pdq_nr]), *_pdq_i);     \
+                            ++_pdq_i;                                                           \
+                        }                                                                       \
+                        _pdq_j = _pdq_i;                                                        \
+                    }                                                                           \
+                }                                                                               \
+                t *_pdq_k = _pdq_i - 1U;                                                        \
+                *_pdq_s = *_pdq_k;                                                              \
+                *_pdq_k = _pdq_x;                                                               \
+                size_t _pdq_ln = (size_t)(_pdq_k - _pdq_s);                                     \
+                size_t _pdq_rn = (size_t)(_pdq_e - _pdq_k) - 1U;                                \
+                if (_pdq_ln < _pdq_n / 8U || _pdq_rn < _pdq_n / 8U)                             \
+                {                                                                               \
+                    if (--_pdq_bad == 0U)                                                       \
+                    {                                                                           \
+                        /* too many bad pivots, O(n log n) is kept */                           \
+                        ksort_heap_make(t, _pdq_s, _pdq_n, func);                               \
+                        ksort_heap(t, _pdq_s, _pdq_n, func);                                    \
+                        _pdq_pop = 1;                                                           \
+                    }                                                                           \
+                    else                                                                        \
+                    {                                                                           \
+                        /* some elements are swapped to break the pattern */                    \
+                        if (_pdq_ln >= KSORT_PDQ_INSERT)                                        \
+                        {                                                                       \
+                            ksort_swap(t, *_pdq_s, *(_pdq_s + _pdq_ln / 4U));                   \
+                            ksort_swap(t, *(_pdq_k - 1U), *(_pdq_k - _pdq_ln / 4U));            \
+                            if (_pdq_ln > KSORT_PDQ_NINTHER)                                    \
+                            {                                                                   \
+                                ksort_swap(t, *(_pdq_s + 1U), *(_pdq_s + (_pdq_ln / 4U + 1U))); \
+                                ksort_swap(t, *(_pdq_s + 2U), *(_pdq_s + (_pdq_ln / 4U + 2U))); \
+                                ksort_swap(t, *(_pdq_k - 2U), *(_pdq_k - (_pdq_ln / 4U + 1U))); \
+                                ksort_swap(t, *(_pdq_k - 3U), *(_pdq_k - (_pdq_ln / 4U + 2U))); \
+                            }                                                                   \
+                        }                                                                       \
+                        if (_pdq_rn >= KSORT_PDQ_INSERT)                                        \
+                        {                                                                       \
+                            ksort_swap(t, *(_pdq_k + 1U), *(_pdq_k + (1U + _pdq_rn / 4U)));     \
+                            ksort_swap(t, *(_pdq_e - 1U), *(_pdq_e - _pdq_rn / 4U));            \
+                            if (_pdq_rn > KSORT_PDQ_NINTHER)                                    \
+                            {                                                                   \
+                                ksort_swap(t, *(_pdq_k + 2U), *(_pdq_k + (2U + _pdq_rn / 4U))); \
+                                ksort_swap(t, *(_pdq_k + 3U), *(_pdq_k + (3U + _pdq_rn / 4U))); \
+                                ksort_swap(t, *(_pdq_e - 2U), *(_pdq_e - (1U + _pdq_rn / 4U))); \
+                                ksort_swap(t, *(_pdq_e - 3U), *(_pdq_e - (2U + _pdq_rn / 4U))); \
+                            }                                                                   \
+                        }                                                                       \
+                    }                                                                           \
+                }                                                                               \
+                else if (_pdq_ok)                                                               \
+                {                                                                               \
+                    /* a partitioned range is tried by insertion sort */                        \
+                    int _pdq_l = 0, _pdq_r = 0;                                                 \
+                    __KSORT_PARTIAL(t, _pdq_l, _pdq_s, _pdq_k, func);                           \
+                    if (_pdq_l)                                                                 \
+                    {                                                                           \
+                        __KSORT_PARTIAL(t, _pdq_r, _pdq_k + 1U, _pdq_e, func);                  \
+                    }                                                                           \
+                    _pdq_pop = _pdq_l && _pdq_r;                                                \
+                }                                                                               \
+                if (!_pdq_pop)                                                                  \
+                {                                                                               \
+                    /* the larger side is pushed, the stack is short */                         \
+                    if (_pdq_ln > _pdq_rn)                                                      \
+                    {                                                                           \
+                        _pdq_top->left = (void *)_pdq_s;                                        \
+                        _pdq_top->right = (void *)_pdq_k;                                       \
+                        _pdq_s = _pdq_k + 1U;                                                   \
+                    }                                                                           \
+                    else                                                                        \
+                    {                                                                           \
+                        _pdq_top->left = (void *)(_pdq_k + 1U);                                 \
+                        _pdq_top->right = (void *)_pdq_e;                                       \
+                        _pdq_e = _pdq_k;                                                        \
+                    }                                                                           \
+                    _pdq_top->depth = _pdq_bad;                                                 \
+                    ++_pdq_top;                                                                 \
+                }                                                                               \
+            }                                                                                   \
+            if (_pdq_pop)                                                                       \
+            {                                                                                   \
+                if (_pdq_top == _pdq_stack)                                                     \
+                {                                                                               \
+                    break;                                                                      \
+                }                                                                               \
+                --_pdq_top;                                                                     \
+                _pdq_s = (t *)_pdq_top->left;                                                   \
+                _pdq_e = (t *)_pdq_top->right;                                                  \
+                _pdq_bad = _pdq_top->depth;                                                     \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+#endif /* ksort_pdq */
+
 /* ksmall */
 #ifndef ksort_ksmall
 /*!
@@ -512,6 +1315,164 @@ typedef struct ksort_stack_t
     } while (0)
 #endif /* ksort_ksmall */
 
+/* key of radix sort, int32_t */
+#ifndef ksort_key_i32
+/*!
+ @brief          key of radix sort for int32_t, the order is kept
+ @param[in]      x: signed integer
+ @return         unsigned key, the sign bit is flipped
+*/
+#define ksort_key_i32(x) ((uint32_t)(x) ^ 0x80000000U)
+#endif /* ksort_key_i32 */
+
+/* key of radix sort, int64_t */
+#ifndef ksort_key_i64
+/*!
+ @brief          key of radix sort for int64_t, the order is kept
+ @param[in]      x: signed integer
+ @return         unsigned key, the sign bit is flipped
+*/
+#define ksort_key_i64(x) ((uint64_t)(x) ^ 0x8000000000000000U)
+#endif /* ksort_key_i64 */
+
+__STATIC_INLINE
+/*!
+ @brief          key of radix sort for float, the order is kept
+ @details        the sign bit of a positive number is flipped, and all the
+                 bits of a negative number are flipped. -0.0 is before 0.0,
+                 NaN with the sign bit is first and the others are last.
+ @param[in]      x: floating point number
+ @return         unsigned key
+*/
+uint32_t ksort_key_f32(float x)
+{
+    uint32_t u;
+    (void)memcpy(&u, &x, sizeof(u));
+    return u ^ ((0U - (u >> 31)) | 0x80000000U);
+}
+
+__STATIC_INLINE
+/*!
+ @brief          key of radix sort for double, the order is kept
+ @details        the same as ksort_key_f32.
+ @param[in]      x: floating point number
+ @return         unsigned key
+*/
+uint64_t ksort_key_f64(double x)
+{
+    uint64_t u;
+    (void)memcpy(&u, &x, sizeof(u));
+    return u ^ ((0U - (u >> 63)) | 0x8000000000000000U);
+}
+
+/* radix sort */
+#ifndef ksort_radix
+/*!
+ @brief          LSD radix sort, stable
+ @details        keyfn(x) is an unsigned integer of up to 64 bits, the order
+                 of elements is the order of their keys. Use ksort_key_i32,
+                 ksort_key_i64, ksort_key_f32 and ksort_key_f64 for signed
+                 and floating point keys. The digits are 11 bits for a long
+                 array of wide keys, else 8 bits. The histograms of all
+                 digits are counted in one pass, and the pass of a digit
+                 that is the same in all the keys is skipped.
+ @param[in]      t: type of data array
+ @param[in]      p: pointer of data array
+ @param[in]      n: length of data array
+ @param[in]      keyfn: function of key, it is called many times on an element
+ @param[in]      a: pointer of buffer, length >= n, it is allocated if NULL,
+                 the array is not sorted if it is out of memory
+*/
+#define ksort_radix(t, p, n, keyfn, a)                                           \
+    do                                                                           \
+    {                                                                            \
+        size_t _radix_n = (n);                                                   \
+        if (_radix_n < 2U)                                                       \
+        {                                                                        \
+            break;                                                               \
+        }                                                                        \
+        t *_radix_p[2U] = {                                                      \
+            (p),                                                                 \
+            (a)                                                                  \
+                ? (a)                                                            \
+                : (t *)malloc(sizeof(*(p)) * _radix_n),                          \
+        };                                                                       \
+        /* digits of 11 bits when the histograms are small to the array */       \
+        unsigned int _radix_b =                                                  \
+            sizeof(keyfn(*(p))) > 2U && _radix_n > 0xFFFFU ? 11U : 8U;           \
+        unsigned int _radix_m =                                                  \
+            (unsigned int)(sizeof(keyfn(*(p))) * 8U + _radix_b - 1U) / _radix_b; \
+        size_t _radix_mask = ((size_t)1 << _radix_b) - 1U;                       \
+        size_t *_radix_h = (size_t *)calloc((size_t)_radix_m << _radix_b,        \
+                                            sizeof(size_t));                     \
+        if (!_radix_p[1U] || !_radix_h)                                          \
+        {                                                                        \
+            /* out of memory, the array is left as it is */                      \
+            free(_radix_h);                                                      \
+            if (!(a))                                                            \
+            {                                                                    \
+                free(_radix_p[1U]);                                              \
+            }                                                                    \
+            break;                                                               \
+        }                                                                        \
+        /* the histograms of all digits in one pass */                           \
+        for (size_t _radix_i = 0U; _radix_i != _radix_n; ++_radix_i)             \
+        {                                                                        \
+            unsigned long long _radix_k =                                        \
+                (unsigned long long)keyfn(_radix_p[0U][_radix_i]);               \
+            size_t *_radix_c = _radix_h;                                         \
+            for (unsigned int _radix_d = 0U; _radix_d != _radix_m; ++_radix_d)   \
+            {                                                                    \
+                ++_radix_c[(size_t)_radix_k & _radix_mask];                      \
+                _radix_k >>= _radix_b;                                           \
+                _radix_c += _radix_mask + 1U;                                    \
+            }                                                                    \
+        }                                                                        \
+        unsigned long long _radix_k0 =                                           \
+            (unsigned long long)keyfn(_radix_p[0U][0U]);                         \
+        unsigned int _radix_site = 0U;                                           \
+        for (unsigned int _radix_d = 0U; _radix_d != _radix_m; ++_radix_d)       \
+        {                                                                        \
+            size_t *_radix_c = _radix_h + ((size_t)_radix_d << _radix_b);        \
+            unsigned int _radix_s = _radix_d * _radix_b;                         \
+            /* a digit that is the same in all the keys is skipped */            \
+            if (_radix_c[(size_t)(_radix_k0 >> _radix_s) & _radix_mask] ==       \
+                _radix_n)                                                        \
+            {                                                                    \
+                continue;                                                        \
+            }                                                                    \
+            size_t _radix_o = 0U;                                                \
+            for (size_t _radix_i = 0U; _radix_i <= _radix_mask; ++_radix_i)      \
+            {                                                                    \
+                size_t _radix_x = _radix_c[_radix_i];                            \
+                _radix_c[_radix_i] = _radix_o;                                   \
+                _radix_o += _radix_x;                                            \
+            }                                                                    \
+            t *_radix_a = _radix_p[_radix_site];                                 \
+            t *_radix_e = _radix_p[!_radix_site];                                \
+            for (size_t _radix_i = 0U; _radix_i != _radix_n; ++_radix_i)         \
+            {                                                                    \
+                unsigned long long _radix_k =                                    \
+                    (unsigned long long)keyfn(_radix_a[_radix_i]);               \
+                size_t _radix_j = (size_t)(_radix_k >> _radix_s) & _radix_mask;  \
+                _radix_e[_radix_c[_radix_j]++] = _radix_a[_radix_i];             \
+            }                                                                    \
+            _radix_site = !_radix_site;                                          \
+        }                                                                        \
+        if (_radix_site)                                                         \
+        {                                                                        \
+            (void)memcpy(_radix_p[0U], _radix_p[1U],                             \
+                         sizeof(*(p)) * _radix_n);                               \
+        }                                                                        \
+        free(_radix_h);                                                          \
+        if (!(a))                                                                \
+        {                                                                        \
+            free(_radix_p[1U]);                                                  \
+            _radix_p[1U] = NULL;                                                 \
+        }                                                                        \
+    } while (0)
+#endif /* ksort_radix */
+
 /* Enddef to prevent recursive inclusion */
 #endif /* __KSORT_H__ */
 
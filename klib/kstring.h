@@ -347,12 +347,19 @@ int ks_resize(kstring_t *ks,
 {
     if (ks->m < m)
     {
-        ks->m = m;
-        kroundup32(ks->m);
-        void *s = realloc(ks->s, ks->m);
+        size_t n = m;
+        kroundup(n);
+        /* the power of 2 overflows, take the exact size */
+        n = n ? n : m;
+        if (ksize_overflow(n, 1U))
+        {
+            return -1;
+        }
+        void *s = realloc(ks->s, n);
         if (s)
         {
             ks->s = (char *)s;
+            ks->m = n;
         }
         else
         {
@@ -375,12 +382,19 @@ __STATIC_INLINE
 int ks_resize_(kstring_t *ks,
                size_t m)
 {
-    ks->m = m;
-    kroundup32(ks->m);
-    void *s = realloc(ks->s, ks->m);
+    size_t n = m;
+    kroundup(n);
+    /* the power of 2 overflows, take the exact size */
+    n = n ? n : m;
+    if (ksize_overflow(n, 1U))
+    {
+        return -1;
+    }
+    void *s = realloc(ks->s, n);
     if (s)
     {
         ks->s = (char *)s;
+        ks->m = n;
     }
     else
     {
@@ -0,0 +1,226 @@
+/*!
+ @file           kthread.c
+ @brief          thread pool library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kthread.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct kthread_t
+{
+    pthread_mutex_t mtx; /* lock of pool            */
+    pthread_cond_t work; /* signal of new job       */
+    pthread_cond_t done; /* signal of finished job  */
+    pthread_t *tid;      /* address of workers      */
+    unsigned int n;      /* number of workers       */
+    unsigned int busy;   /* workers in the job      */
+    unsigned long gen;   /* generation of job       */
+    int quit;            /* workers should exit     */
+
+    void (*func)(void *, size_t, size_t, size_t);
+    void *data;  /* data of job              */
+    size_t size; /* number of elements       */
+    size_t grain;
+    size_t next; /* next chunk, atomic       */
+};
+
+/* take the index of next chunk */
+static size_t kt_next(kthread_t *kt)
+{
+#if defined __GNUC__
+    return __atomic_fetch_add(&kt->next, 1U, __ATOMIC_RELAXED);
+#else
+    pthread_mutex_lock(&kt->mtx);
+    size_t k = kt->next++;
+    pthread_mutex_unlock(&kt->mtx);
+    return k;
+#endif /* __GNUC__ */
+}
+
+/* run chunks until all of them are taken */
+static void kt_run(kthread_t *kt)
+{
+    size_t c = kt_chunk(kt->size, kt->grain);
+    for (size_t k = kt_next(kt); k < c; k = kt_next(kt))
+    {
+        size_t i = k * kt->grain;
+        size_t j = kt->size - i < kt->grain ? kt->size : i + kt->grain;
+        kt->func(kt->data, k, i, j);
+    }
+}
+
+static void *kt_worker(void *arg)
+{
+    kthread_t *kt = (kthread_t *)arg;
+    unsigned long gen = 0U;
+    pthread_mutex_lock(&kt->mtx);
+    for (;;)
+    {
+        while (!kt->quit && kt->gen == gen)
+        {
+            pthread_cond_wait(&kt->work, &kt->mtx);
+        }
+        if (kt->quit)
+        {
+            break;
+        }
+        gen = kt->gen;
+        pthread_mutex_unlock(&kt->mtx);
+        kt_run(kt);
+        pthread_mutex_lock(&kt->mtx);
+        if (--kt->busy == 0U)
+        {
+            pthread_cond_signal(&kt->done);
+        }
+    }
+    pthread_mutex_unlock(&kt->mtx);
+    return NULL;
+}
+
+kthread_t *kt_init(unsigned int n)
+{
+    if (n == 0U)
+    {
+        long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cpu > 0 ? (unsigned int)cpu : 1U;
+    }
+
+    kthread_t *kt = (kthread_t *)calloc(1U, sizeof(kthread_t));
+    if (!kt)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&kt->mtx, NULL);
+    pthread_cond_init(&kt->work, NULL);
+    pthread_cond_init(&kt->done, NULL);
+
+    /* the calling thread is one of threads */
+    if (n > 1U)
+    {
+        kt->tid = (pthread_t *)malloc(sizeof(pthread_t) * (n - 1U));
+        if (!kt->tid)
+        {
+            kt_free(kt);
+            return NULL;
+        }
+        for (; kt->n != n - 1U; ++kt->n)
+        {
+            if (pthread_create(kt->tid + kt->n, NULL, kt_worker, kt))
+            {
+                break;
+            }
+        }
+    }
+
+    return kt;
+}
+
+void kt_free(kthread_t *kt)
+{
+    if (!kt)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&kt->mtx);
+    kt->quit = 1;
+    pthread_cond_broadcast(&kt->work);
+    pthread_mutex_unlock(&kt->mtx);
+    for (unsigned int i = 0U; i != kt->n; ++i)
+    {
+        pthread_join(kt->tid[i], NULL);
+    }
+
+    pthread_cond_destroy(&kt->done);
+    pthread_cond_destroy(&kt->work);
+    pthread_mutex_destroy(&kt->mtx);
+    free(kt->tid);
+    free(kt);
+}
+
+unsigned int kt_size(const kthread_t *kt)
+{
+    assert(kt && "kt is null");
+
+    return kt->n + 1U;
+}
+
+size_t kt_grain(const kthread_t *kt,
+                size_t n,
+                size_t grain)
+{
+    assert(kt && "kt is null");
+
+    if (grain == 0U)
+    {
+        /* several chunks for each thread to balance the load */
+        grain = n / ((size_t)(kt->n + 1U) << 3U);
+    }
+
+    return grain ? grain : 1U;
+}
+
+void kt_for(kthread_t *kt,
+            void (*func)(void *data, size_t k, size_t i, size_t j),
+            void *data,
+            size_t n,
+            size_t grain)
+{
+    assert(kt && "kt is null");
+    assert(func && "func is null");
+
+    kt->func = func;
+    kt->data = data;
+    kt->size = n;
+    kt->grain = kt_grain(kt, n, grain);
+    kt->next = 0U;
+
+    if (kt->n == 0U || kt_chunk(n, kt->grain) < 2U)
+    {
+        kt_run(kt);
+        return;
+    }
+
+    pthread_mutex_lock(&kt->mtx);
+    kt->busy = kt->n;
+    ++kt->gen;
+    pthread_cond_broadcast(&kt->work);
+    pthread_mutex_unlock(&kt->mtx);
+
+    kt_run(kt);
+
+    pthread_mutex_lock(&kt->mtx);
+    while (kt->busy)
+    {
+        pthread_cond_wait(&kt->done, &kt->mtx);
+    }
+    pthread_mutex_unlock(&kt->mtx);
+}
+
+/* END OF FILE */
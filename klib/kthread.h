@@ -0,0 +1,465 @@
+/*!
+ @file           kthread.h
+ @brief          thread pool library
+ @details        A pool of worker threads runs a loop over chunks of index,
+                 the calling thread works as one of them.
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* Define to prevent recursive inclusion */
+#ifndef __KTHREAD_H__
+#define __KTHREAD_H__
+
+#include "klib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*!
+ @brief          thread pool, the members are private
+*/
+typedef struct kthread_t kthread_t;
+
+__BEGIN_DECLS
+
+/*!
+ @brief          create a thread pool
+ @param[in]      n: number of threads, including the calling thread
+  @arg           0 the number of online processors
+ @return         pointer of thread pool
+  @retval        NULL failure
+*/
+extern kthread_t *kt_init(unsigned int n)
+    __RESULT_USE_CHECK;
+
+/*!
+ @brief          stop the worker threads and free the thread pool
+ @param[in]      kt: pointer of thread pool
+*/
+extern void kt_free(kthread_t *kt);
+
+/*!
+ @brief          number of threads, including the calling thread
+ @param[in]      kt: pointer of thread pool
+ @return         number of threads
+*/
+extern unsigned int kt_size(const kthread_t *kt)
+    __NONNULL_ALL;
+
+/*!
+ @brief          size of chunk that is used for n elements
+ @param[in]      kt: pointer of thread pool
+ @param[in]      n: number of elements
+ @param[in]      grain: size of chunk
+  @arg           0 about eight chunks for each thread
+ @return         size of chunk, it is not 0
+*/
+extern size_t kt_grain(const kthread_t *kt,
+                       size_t n,
+                       size_t grain)
+    __NONNULL((1));
+
+/*!
+ @brief          run func for each chunk of [0, n) on the thread pool
+ @details        chunk k is [k * grain, min(n, (k + 1) * grain)), it returns
+                 after all chunks are finished. It should not be called
+                 by the threads of pool or by two threads at the same time.
+ @param[in]      kt: pointer of thread pool
+ @param[in]      func: function that is called for each chunk
+  @arg           data: data that is passed to kt_for
+  @arg           k: index of chunk
+  @arg           i: first index of chunk
+  @arg           j: end index of chunk
+ @param[in]      data: data that is passed to func
+ @param[in]      n: number of elements
+ @param[in]      grain: size of chunk, 0 is the same as kt_grain
+*/
+extern void kt_for(kthread_t *kt,
+                   void (*func)(void *data, size_t k, size_t i, size_t j),
+                   void *data,
+                   size_t n,
+                   size_t grain)
+    __NONNULL((1, 2));
+
+__END_DECLS
+
+__STATIC_INLINE
+/*!
+ @brief          number of chunks for n elements
+ @param[in]      n: number of elements
+ @param[in]      grain: size of chunk, it is not 0
+ @return         number of chunks
+*/
+size_t kt_chunk(size_t n,
+                size_t grain)
+{
+    return n / grain + (n % grain != 0U);
+}
+
+/* __KVEC_PARALLEL_IMPL */
+#undef __KVEC_PARALLEL_IMPL
+#define __KVEC_PARALLEL_IMPL(SCOPE, NAME, TYPE)                               \
+                                                                              \
+    typedef struct kv_##NAME##_parallel_t                                     \
+    {                                                                         \
+        TYPE *v;                                                              \
+        TYPE *t;                                                              \
+        size_t *c;                                                            \
+        size_t g;                                                             \
+        void *arg;                                                            \
+        void (*func)(TYPE *, size_t, void *);                                 \
+        TYPE (*op)(TYPE, TYPE);                                               \
+        int (*pred)(const TYPE *, void *);                                    \
+    } kv_##NAME##_parallel_t;                                                 \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kv_##NAME##_parallel_for_(void *data,                                \
+                                   size_t k,                                  \
+                                   size_t i,                                  \
+                                   size_t j)                                  \
+    {                                                                         \
+        kv_##NAME##_parallel_t *ctx = (kv_##NAME##_parallel_t *)data;         \
+        (void)k;                                                              \
+        ctx->func(ctx->v + i, j - i, ctx->arg);                               \
+    }                                                                         \
+                                                                              \
+    __NONNULL((1, 2, 3))                                                      \
+    SCOPE                                                                     \
+    void kv_##NAME##_parallel_for(kthread_t *kt,                              \
+                                  kvec_##NAME##_t *kv,                        \
+                                  void (*func)(TYPE *p, size_t n, void *arg), \
+                                  void *arg,                                  \
+                                  size_t grain)                               \
+    {                                                                         \
+        kv_##NAME##_parallel_t ctx;                                           \
+        memset(&ctx, 0, sizeof(ctx));                                         \
+        ctx.v = kv->v;                                                        \
+        ctx.func = func;                                                      \
+        ctx.arg = arg;                                                        \
+        kt_for(kt, kv_##NAME##_parallel_for_, &ctx, kv->n, grain);            \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kv_##NAME##_parallel_reduce_(void *data,                             \
+                                      size_t k,                               \
+                                      size_t i,                               \
+                                      size_t j)                               \
+    {                                                                         \
+        kv_##NAME##_parallel_t *ctx = (kv_##NAME##_parallel_t *)data;         \
+        TYPE r = ctx->v[i];                                                   \
+        while (++i != j)                                                      \
+        {                                                                     \
+            r = ctx->op(r, ctx->v[i]);                                        \
+        }                                                                     \
+        ctx->t[k] = r;                                                        \
+    }                                                                         \
+                                                                              \
+    __NONNULL((1, 2, 3, 5))                                                   \
+    SCOPE                                                                     \
+    int kv_##NAME##_parallel_reduce(TYPE *dst,                                \
+                                    kthread_t *kt,                            \
+                                    const kvec_##NAME##_t *kv,                \
+                                    TYPE init,                                \
+                                    TYPE (*op)(TYPE a, TYPE b),               \
+                                    size_t grain)                             \
+    {                                                                         \
+        kv_##NAME##_parallel_t ctx;                                           \
+        memset(&ctx, 0, sizeof(ctx));                                         \
+        ctx.g = kt_grain(kt, kv->n, grain);                                   \
+        size_t c = kt_chunk(kv->n, ctx.g);                                    \
+        ctx.t = (TYPE *)malloc(sizeof(TYPE) * (c ? c : 1U));                  \
+        if (!ctx.t)                                                           \
+        {                                                                     \
+            return -1;                                                        \
+        }                                                                     \
+        ctx.v = kv->v;                                                        \
+        ctx.op = op;                                                          \
+        kt_for(kt, kv_##NAME##_parallel_reduce_, &ctx, kv->n, ctx.g);         \
+        /* partial results are combined in order */                           \
+        for (size_t k = 0U; k != c; ++k)                                      \
+        {                                                                     \
+            init = op(init, ctx.t[k]);                                        \
+        }                                                                     \
+        *dst = init;                                                          \
+        free(ctx.t);                                                          \
+        return 0;                                                             \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kv_##NAME##_parallel_filter_(void *data,                             \
+                                      size_t k,                               \
+                                      size_t i,                               \
+                                      size_t j)                               \
+    {                                                                         \
+        kv_##NAME##_parallel_t *ctx = (kv_##NAME##_parallel_t *)data;         \
+        TYPE *p = ctx->t + i;                                                 \
+        for (; i != j; ++i)                                                   \
+        {                                                                     \
+            *p = ctx->v[i];                                                   \
+            p += ctx->pred(ctx->v + i, ctx->arg) != 0;                        \
+        }                                                                     \
+        ctx->c[k] = (size_t)(p - (ctx->t + k * ctx->g));                      \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kv_##NAME##_parallel_move_(void *data,                               \
+                                    size_t k,                                 \
+                                    size_t i,                                 \
+                                    size_t j)                                 \
+    {                                                                         \
+        kv_##NAME##_parallel_t *ctx = (kv_##NAME##_parallel_t *)data;         \
+        (void)j;                                                              \
+        (void)memcpy(ctx->v + ctx->c[k],                                      \
+                     ctx->t + i,                                              \
+                     sizeof(TYPE) * (ctx->c[k + 1U] - ctx->c[k]));            \
+    }                                                                         \
+                                                                              \
+    __NONNULL((1, 2, 3, 4))                                                   \
+    SCOPE                                                                     \
+    int kv_##NAME##_parallel_filter(kthread_t *kt,                            \
+                                    kvec_##NAME##_t *dst,                     \
+                                    const kvec_##NAME##_t *src,               \
+                                    int (*pred)(const TYPE *x, void *arg),    \
+                                    void *arg,                                \
+                                    size_t grain)                             \
+    {                                                                         \
+        kv_##NAME##_parallel_t ctx;                                           \
+        memset(&ctx, 0, sizeof(ctx));                                         \
+        ctx.g = kt_grain(kt, src->n, grain);                                  \
+        size_t c = kt_chunk(src->n, ctx.g);                                   \
+        ctx.c = (size_t *)malloc(sizeof(size_t) * (c + 1U));                  \
+        ctx.t = (TYPE *)malloc(sizeof(TYPE) * (src->n ? src->n : 1U));        \
+        if (!ctx.c || !ctx.t)                                                 \
+        {                                                                     \
+            free(ctx.c);                                                      \
+            free(ctx.t);                                                      \
+            return -1;                                                        \
+        }                                                                     \
+        ctx.v = src->v;                                                       \
+        ctx.pred = pred;                                                      \
+        ctx.arg = arg;                                                        \
+        /* each chunk keeps its elements at the head of its own range */      \
+        kt_for(kt, kv_##NAME##_parallel_filter_, &ctx, src->n, ctx.g);        \
+        /* exclusive prefix sum of the counts is the offset of chunk */       \
+        size_t s = 0U;                                                        \
+        for (size_t k = 0U; k != c; ++k)                                      \
+        {                                                                     \
+            size_t n = ctx.c[k];                                              \
+            ctx.c[k] = s;                                                     \
+            s += n;                                                           \
+        }                                                                     \
+        ctx.c[c] = s;                                                         \
+        if (dst->m < s && kv_##NAME##_resize(dst, s))                         \
+        {                                                                     \
+            free(ctx.c);                                                      \
+            free(ctx.t);                                                      \
+            return -1;                                                        \
+        }                                                                     \
+        ctx.v = dst->v;                                                       \
+        kt_for(kt, kv_##NAME##_parallel_move_, &ctx, src->n, ctx.g);          \
+        dst->n = s;                                                           \
+        free(ctx.c);                                                          \
+        free(ctx.t);                                                          \
+        return 0;                                                             \
+    }
+
+#ifndef kvec_parallel_impl
+/*!
+ @brief          Parallel vector function Initial Microprogram Loading
+ @details        kv_##name##_parallel_for calls func for each chunk of vector.
+                 kv_##name##_parallel_reduce combines the elements with op,
+                 op must be associative, the order of elements is kept.
+                 kv_##name##_parallel_filter copies the elements that pred
+                 returns nonzero to dst and keeps their order, it filters
+                 each chunk then moves them by prefix sum of the counts.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data
+*/
+#define kvec_parallel_impl(scope, name, type) \
+    __KVEC_PARALLEL_IMPL(scope, name, type)
+#endif /* kvec_parallel_impl */
+
+#ifndef kvec_parallel_init
+/*!
+ @brief          Parallel vector function Initial Microprogram Loading
+ @note           kvec_init(name, type) must be registered before.
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data
+*/
+#define kvec_parallel_init(name, type) \
+    __KVEC_PARALLEL_IMPL(__STATIC_INLINE __UNUSED, name, type)
+#endif /* kvec_parallel_init */
+
+/* __KVEC_PARALLEL_SCAN_IMPL */
+#undef __KVEC_PARALLEL_SCAN_IMPL
+#define __KVEC_PARALLEL_SCAN_IMPL(SCOPE, NAME, TYPE)                          \
+                                                                              \
+    typedef struct kv_##NAME##_parallel_scan_t                                \
+    {                                                                         \
+        TYPE *v;                                                              \
+        const TYPE *u;                                                        \
+        TYPE *t;                                                              \
+        int ex;                                                               \
+    } kv_##NAME##_parallel_scan_t;                                            \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kv_##NAME##_parallel_sum_(void *data,                                \
+                                   size_t k,                                  \
+                                   size_t i,                                  \
+                                   size_t j)                                  \
+    {                                                                         \
+        kv_##NAME##_parallel_scan_t *ctx;                                     \
+        ctx = (kv_##NAME##_parallel_scan_t *)data;                            \
+        kvec_##NAME##_t kv;                                                   \
+        kv.n = j - i;                                                         \
+        kv.m = j - i;                                                         \
+        kv.v = (TYPE *)(ctx->u + i);                                          \
+        ctx->t[k] = kv_##NAME##_sum(&kv);                                     \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    void kv_##NAME##_parallel_scan_(void *data,                               \
+                                    size_t k,                                 \
+                                    size_t i,                                 \
+                                    size_t j)                                 \
+    {                                                                         \
+        kv_##NAME##_parallel_scan_t *ctx;                                     \
+        ctx = (kv_##NAME##_parallel_scan_t *)data;                            \
+        if (ctx->ex)                                                          \
+        {                                                                     \
+            (void)kv_##NAME##_scan_exclusive_(ctx->v + i, ctx->u + i,         \
+                                              j - i, ctx->t[k]);              \
+        }                                                                     \
+        else                                                                  \
+        {                                                                     \
+            (void)kv_##NAME##_scan_inclusive_(ctx->v + i, ctx->u + i,         \
+                                              j - i, ctx->t[k]);              \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    int kv_##NAME##_parallel_scan(kthread_t *kt,                              \
+                                  kvec_##NAME##_t *dst,                       \
+                                  const kvec_##NAME##_t *src,                 \
+                                  size_t grain,                               \
+                                  int ex)                                     \
+    {                                                                         \
+        size_t g = kt_grain(kt, src->n, grain);                               \
+        size_t c = kt_chunk(src->n, g);                                       \
+        if (c < 2U || kt_size(kt) < 2U)                                       \
+        {                                                                     \
+            return ex ? kv_##NAME##_scan_exclusive(dst, src)                  \
+                      : kv_##NAME##_scan_inclusive(dst, src);                 \
+        }                                                                     \
+        if (dst->m < src->n && kv_##NAME##_resize(dst, src->n))               \
+        {                                                                     \
+            return -1;                                                        \
+        }                                                                     \
+        kv_##NAME##_parallel_scan_t ctx;                                      \
+        ctx.t = (TYPE *)malloc(sizeof(TYPE) * c);                             \
+        if (!ctx.t)                                                           \
+        {                                                                     \
+            return -1;                                                        \
+        }                                                                     \
+        ctx.v = dst->v;                                                       \
+        ctx.u = src->v;                                                       \
+        ctx.ex = ex;                                                          \
+        /* sum of each chunk, then the offset of each chunk */                \
+        kt_for(kt, kv_##NAME##_parallel_sum_, &ctx, src->n, g);               \
+        TYPE s = (TYPE)0;                                                     \
+        for (size_t k = 0U; k != c; ++k)                                      \
+        {                                                                     \
+            TYPE x = ctx.t[k];                                                \
+            ctx.t[k] = s;                                                     \
+            s += x;                                                           \
+        }                                                                     \
+        kt_for(kt, kv_##NAME##_parallel_scan_, &ctx, src->n, g);              \
+        dst->n = src->n;                                                      \
+        free(ctx.t);                                                          \
+        return 0;                                                             \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    int kv_##NAME##_parallel_scan_inclusive(kthread_t *kt,                    \
+                                            kvec_##NAME##_t *dst,             \
+                                            const kvec_##NAME##_t *src,       \
+                                            size_t grain)                     \
+    {                                                                         \
+        return kv_##NAME##_parallel_scan(kt, dst, src, grain, 0);             \
+    }                                                                         \
+                                                                              \
+    __NONNULL_ALL                                                             \
+    SCOPE                                                                     \
+    int kv_##NAME##_parallel_scan_exclusive(kthread_t *kt,                    \
+                                            kvec_##NAME##_t *dst,             \
+                                            const kvec_##NAME##_t *src,       \
+                                            size_t grain)                     \
+    {                                                                         \
+        return kv_##NAME##_parallel_scan(kt, dst, src, grain, 1);             \
+    }
+
+#ifndef kvec_parallel_scan_impl
+/*!
+ @brief          Parallel prefix sum Initial Microprogram Loading
+ @details        kv_##name##_parallel_scan_inclusive and
+                 kv_##name##_parallel_scan_exclusive write the prefix sum to
+                 dst, dst may be src. Each chunk is summed at first, then each
+                 chunk is scanned from its offset. It is the same as
+                 kv_##name##_scan_inclusive or kv_##name##_scan_exclusive if
+                 there is only one thread or one chunk.
+                 Floating point sums are added by chunk, so the result may be
+                 a little different from the serial one.
+ @param[in]      scope: scope of function
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data, integer or floating point
+*/
+#define kvec_parallel_scan_impl(scope, name, type) \
+    __KVEC_PARALLEL_SCAN_IMPL(scope, name, type)
+#endif /* kvec_parallel_scan_impl */
+
+#ifndef kvec_parallel_scan_init
+/*!
+ @brief          Parallel prefix sum Initial Microprogram Loading
+ @note           kvec_init(name, type) and kvec_math_init(name, type)
+                 must be registered before.
+ @param[in]      name: identity name of vector structure
+ @param[in]      type: type of vector data, integer or floating point
+*/
+#define kvec_parallel_scan_init(name, type) \
+    __KVEC_PARALLEL_SCAN_IMPL(__STATIC_INLINE __UNUSED, name, type)
+#endif /* kvec_parallel_scan_init */
+
+/* Enddef to prevent recursive inclusion */
+#endif /* __KTHREAD_H__ */
+
+/* END OF FILE */
@@ -127,7 +127,7 @@
 #define kv_resize(type, kv, n) \
     (/**/                      \
      (kv).m = (n),             \
-     (kv).v = (type *)realloc((kv).v, sizeof(*(kv).v) * (n)) /**/)
+     (kv).v = (type *)realloc((kv).v, ksize_mul(n, sizeof(type))) /**/)
 #endif /* kv_resize */
 
 /* kv_presize */
@@ -274,8 +274,9 @@
          ? ((kv).m = ((kv).m                               \
                           ? ((kv).m << 1U) /* m != 0 */    \
                           : 2U),           /* m == 0 */    \
-            (kv).v = (type *)                              \
-                realloc((kv).v, sizeof(*(kv).v) * (kv).m), \
+            (kv).v = (type *)realloc(                      \
+                (kv).v,                                    \
+                ksize_mul((kv).m, sizeof(type))),          \
             0)                                             \
          : (/* n != m */ 0),                               \
      (kv).v[(kv).n++] = (x) /**/)
@@ -308,8 +309,9 @@
              (kv).m = ((kv).m                               \
                            ? ((kv).m << 1U)                 \
                            : 2U),                           \
-             (kv).v = (type *)                              \
-                 realloc((kv).v, sizeof(*(kv).v) * (kv).m), \
+             (kv).v = (type *)realloc(                      \
+                 (kv).v,                                    \
+                 ksize_mul((kv).m, sizeof(type))),          \
              0)                                             \
           : (/* n != m */ 0),                               \
       /**/ 0),                                              \
@@ -331,6 +333,8 @@
 #ifndef kv_vi
 /*!
  @brief        element whose index is i. dynamic
+ @note         It reallocs up to kroundup(i + 1) elements and leaves the gap
+               uninitialized, use kpage.h for large or sparse indices.
  @param[in]    type: type of vector data
  @param[in]    kv: vector structure
  @param[in]    i: index of element
@@ -342,9 +346,11 @@
      (kv).m <= (i)                                         \
          ? (/*m <= i*/                                     \
             (kv).m = (kv).n = (i) + 1U,                    \
-            kroundup32((kv).m), /* m = n = i + 1 */        \
-            (kv).v = (type *)                              \
-                realloc((kv).v, sizeof(*(kv).v) * (kv).m), \
+            kroundup((kv).m), /* m = n = i + 1 */          \
+            (kv).m = (kv).m ? (kv).m : (kv).n,             \
+            (kv).v = (type *)realloc(                      \
+                (kv).v,                                    \
+                ksize_mul((kv).m, sizeof(type))),          \
             0)                                             \
          : (/*m > i*/                                      \
             (kv).n <= (i)                                  \
@@ -421,6 +427,10 @@
     int kv_##NAME##_resize(kvec_##NAME##_t *kv,                 \
                            size_t n)                            \
     {                                                           \
+        if (ksize_overflow(n, sizeof(*kv->v)))                  \
+        {                                                       \
+            return -1;                                          \
+        }                                                       \
         void *p = realloc(kv->v, sizeof(*kv->v) * n);           \
         if (p || !n)                                            \
         {                                                       \
@@ -497,6 +507,10 @@
     {                                                           \
         if (kv->n == kv->m)                                     \
         {                                                       \
+            if (ksize_overflow(kv->m, sizeof(*kv->v) << 1U))    \
+            {                                                   \
+                return -1;                                      \
+            }                                                   \
             kv->m = (kv->m ? (kv->m << 1U) : 2U);               \
             void *p = realloc(kv->v, sizeof(*kv->v) * kv->m);   \
             if (p)                                              \
@@ -523,7 +537,13 @@
         if (kv->m <= i)                                         \
         {                                                       \
             size_t m = i + 1U;                                  \
-            kroundup32(m);                                      \
+            kroundup(m);                                        \
+            /* the power of 2 overflows, take the exact size */ \
+            m = m ? m : i + 1U;                                 \
+            if (!m || ksize_overflow(m, sizeof(*kv->v)))        \
+            {                                                   \
+                return -1;                                      \
+            }                                                   \
             void *p = realloc(kv->v, sizeof(*kv->v) * m);       \
             if (p)                                              \
             {                                                   \
@@ -570,6 +590,243 @@
 #define kvec_init(name, type) __KVEC_INIT(name, type)
 #endif /* kvec_init */
 
+/* __KVEC_MATH_IMPL */
+#undef __KVEC_MATH_IMPL
+#define __KVEC_MATH_IMPL(SCOPE, NAME, TYPE)                            \
+                                                                       \
+    __NONNULL_ALL                                                      \
+    __TARGET_CLONES                                                    \
+    SCOPE                                                              \
+    size_t kv_##NAME##_find(const kvec_##NAME##_t *kv,                 \
+                            TYPE x)                                    \
+    {                                                                  \
+        const TYPE *p = kv->v;                                         \
+        size_t i = 0U;                                                 \
+        /* test a block without branch, then locate in the block */    \
+        for (; i + 32U <= kv->n; i += 32U)                             \
+        {                                                              \
+            int hit = 0;                                               \
+            for (size_t j = 0U; j != 32U; ++j)                         \
+            {                                                          \
+                hit |= (p[i + j] == x);                                \
+            }                                                          \
+            if (hit)                                                   \
+            {                                                          \
+                break;                                                 \
+            }                                                          \
+        }                                                              \
+        for (; i != kv->n; ++i)                                        \
+        {                                                              \
+            if (p[i] == x)                                             \
+            {                                                          \
+                return i;                                              \
+            }                                                          \
+        }                                                              \
+        return kv->n;                                                  \
+    }                                                                  \
+                                                                       \
+    __NONNULL_ALL                                                      \
+    __TARGET_CLONES                                                    \
+    SCOPE                                                              \
+    size_t kv_##NAME##_count(const kvec_##NAME##_t *kv,                \
+                             TYPE x)                                   \
+    {                                                                  \
+        const TYPE *p = kv->v;                                         \
+        size_t c = 0U;                                                 \
+        for (size_t i = 0U; i != kv->n; ++i)                           \
+        {                                                              \
+            c += (p[i] == x);                                          \
+        }                                                              \
+        return c;                                                      \
+    }                                                                  \
+                                                                       \
+    __NONNULL_ALL                                                      \
+    __TARGET_CLONES                                                    \
+    SCOPE                                                              \
+    int kv_##NAME##_vmin(TYPE *dst,                                    \
+                         const kvec_##NAME##_t *kv)                    \
+    {                                                                  \
+        if (!kv->n)                                                    \
+        {                                                              \
+            return -1;                                                 \
+        }                                                              \
+        const TYPE *p = kv->v;                                         \
+        TYPE r[8U];                                                    \
+        size_t i = 0U;                                                 \
+        for (size_t k = 0U; k != 8U; ++k)                              \
+        {                                                              \
+            r[k] = *p;                                                 \
+        }                                                              \
+        for (; i + 8U <= kv->n; i += 8U)                               \
+        {                                                              \
+            for (size_t k = 0U; k != 8U; ++k)                          \
+            {                                                          \
+                r[k] = p[i + k] < r[k] ? p[i + k] : r[k];              \
+            }                                                          \
+        }                                                              \
+        for (; i != kv->n; ++i)                                        \
+        {                                                              \
+            *r = p[i] < *r ? p[i] : *r;                                \
+        }                                                              \
+        for (size_t k = 1U; k != 8U; ++k)                              \
+        {                                                              \
+            *r = r[k] < *r ? r[k] : *r;                                \
+        }                                                              \
+        *dst = *r;                                                     \
+        return 0;                                                      \
+    }                                                                  \
+                                                                       \
+    __NONNULL_ALL                                                      \
+    __TARGET_CLONES                                                    \
+    SCOPE                                                              \
+    int kv_##NAME##_vmax(TYPE *dst,                                    \
+                         const kvec_##NAME##_t *kv)                    \
+    {                                                                  \
+        if (!kv->n)                                                    \
+        {                                                              \
+            return -1;                                                 \
+        }                                                              \
+        const TYPE *p = kv->v;                                         \
+        TYPE r[8U];                                                    \
+        size_t i = 0U;                                                 \
+        for (size_t k = 0U; k != 8U; ++k)                              \
+        {                                                              \
+            r[k] = *p;                                                 \
+        }                                                              \
+        for (; i + 8U <= kv->n; i += 8U)                               \
+        {                                                              \
+            for (size_t k = 0U; k != 8U; ++k)                          \
+            {                                                          \
+                r[k] = r[k] < p[i + k] ? p[i + k] : r[k];              \
+            }                                                          \
+        }                                                              \
+        for (; i != kv->n; ++i)                                        \
+        {                                                              \
+            *r = *r < p[i] ? p[i] : *r;                                \
+        }                                                              \
+        for (size_t k = 1U; k != 8U; ++k)                              \
+        {                                                              \
+            *r = *r < r[k] ? r[k] : *r;                                \
+        }                                                              \
+        *dst = *r;                                                     \
+        return 0;                                                      \
+    }                                                                  \
+                                                                       \
+    __NONNULL_ALL                                                      \
+    __TARGET_CLONES                                                    \
+    SCOPE                                                              \
+    TYPE kv_##NAME##_sum(const kvec_##NAME##_t *kv)                    \
+    {                                                                  \
+        const TYPE *p = kv->v;                                         \
+        TYPE r[8U] = {0};                                              \
+        size_t i = 0U;                                                 \
+        /* eight partial sums, so floating point adds vectorize too */ \
+        for (; i + 8U <= kv->n; i += 8U)                               \
+        {                                                              \
+            for (size_t k = 0U; k != 8U; ++k)                          \
+            {                                                          \
+                r[k] += p[i + k];                                      \
+            }                                                          \
+        }                                                              \
+        for (; i != kv->n; ++i)                                        \
+        {                                                              \
+            *r += p[i];                                                \
+        }                                                              \
+        for (size_t k = 1U; k != 8U; ++k)                              \
+        {                                                              \
+            *r += r[k];                                                \
+        }                                                              \
+        return *r;                                                     \
+    }                                                                  \
+                                                                       \
+    SCOPE                                                              \
+    TYPE kv_##NAME##_scan_inclusive_(TYPE *q,                          \
+                                     const TYPE *p,                    \
+                                     size_t n,                         \
+                                     TYPE s)                           \
+    {                                                                  \
+        for (size_t i = 0U; i != n; ++i)                               \
+        {                                                              \
+            s += p[i];                                                 \
+            q[i] = s;                                                  \
+        }                                                              \
+        return s;                                                      \
+    }                                                                  \
+                                                                       \
+    SCOPE                                                              \
+    TYPE kv_##NAME##_scan_exclusive_(TYPE *q,                          \
+                                     const TYPE *p,                    \
+                                     size_t n,                         \
+                                     TYPE s)                           \
+    {                                                                  \
+        for (size_t i = 0U; i != n; ++i)                               \
+        {                                                              \
+            TYPE x = p[i];                                             \
+            q[i] = s;                                                  \
+            s += x;                                                    \
+        }                                                              \
+        return s;                                                      \
+    }                                                                  \
+                                                                       \
+    __NONNULL_ALL                                                      \
+    SCOPE                                                              \
+    int kv_##NAME##_scan_inclusive(kvec_##NAME##_t *dst,               \
+                                   const kvec_##NAME##_t *src)         \
+    {                                                                  \
+        if (dst->m < src->n && kv_##NAME##_resize(dst, src->n))        \
+        {                                                              \
+            return -1;                                                 \
+        }                                                              \
+        (void)kv_##NAME##_scan_inclusive_(dst->v, src->v,              \
+                                          src->n, (TYPE)0);            \
+        dst->n = src->n;                                               \
+        return 0;                                                      \
+    }                                                                  \
+                                                                       \
+    __NONNULL_ALL                                                      \
+    SCOPE                                                              \
+    int kv_##NAME##_scan_exclusive(kvec_##NAME##_t *dst,               \
+                                   const kvec_##NAME##_t *src)         \
+    {                                                                  \
+        if (dst->m < src->n && kv_##NAME##_resize(dst, src->n))        \
+        {                                                              \
+            return -1;                                                 \
+        }                                                              \
+        (void)kv_##NAME##_scan_exclusive_(dst->v, src->v,              \
+                                          src->n, (TYPE)0);            \
+        dst->n = src->n;                                               \
+        return 0;                                                      \
+    }
+
+#ifndef kvec_math_impl
+/*!
+ @brief        Vector search and reduction Initial Microprogram Loading
+ @details      kv_##name##_find returns the index of first element equal to x,
+               or the number of elements when it is not found.
+               kv_##name##_count, kv_##name##_vmin, kv_##name##_vmax and
+               kv_##name##_sum are the others. The loops are written to be
+               vectorized, and they are compiled for several cpus and chosen
+               at runtime when __TARGET_CLONES is supported.
+               kv_##name##_scan_inclusive and kv_##name##_scan_exclusive write
+               the prefix sum to dst, dst may be src.
+ @param[in]    scope: scope of function
+ @param[in]    name: identity name of vector structure
+ @param[in]    type: type of vector data, integer or floating point
+*/
+#define kvec_math_impl(scope, name, type) __KVEC_MATH_IMPL(scope, name, type)
+#endif /* kvec_math_impl */
+
+#ifndef kvec_math_init
+/*!
+ @brief        Vector search and reduction Initial Microprogram Loading
+ @note         kvec_init(name, type) must be registered before.
+ @param[in]    name: identity name of vector structure
+ @param[in]    type: type of vector data, integer or floating point
+*/
+#define kvec_math_init(name, type) \
+    __KVEC_MATH_IMPL(__STATIC_INLINE __UNUSED, name, type)
+#endif /* kvec_math_init */
+
 /* Enddef to prevent recursive inclusion */
 #endif /* __KVEC_H__ */
 
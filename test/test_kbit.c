@@ -0,0 +1,215 @@
+/*!
+ @file           test_kbit.c
+ @brief          test bit vector library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kbit.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/* one of every d bits is set */
+void test1(size_t n, unsigned int d)
+{
+    uint64_t s = 88172645463325252U;
+    kbitvec_t bv;
+    kbv_init(&bv);
+    kbv_resize(&bv, n);
+    size_t *one = (size_t *)malloc(sizeof(size_t) * (n + 1U));
+    size_t c = 0U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        if (rnd(&s) % d == 0U)
+        {
+            kbv_set(&bv, i);
+            one[c++] = i;
+        }
+    }
+    size_t r = 0U;
+    if (kbv_rank(&r, &bv, 0U) == 0 || kbv_count(&bv) != c)
+    {
+        fprintf(stderr, "Bug in kbv_count!\n");
+        exit(EXIT_FAILURE);
+    }
+    kbv_build(&bv);
+    for (size_t i = 0U, k = 0U; i <= n; ++i)
+    {
+        if (kbv_rank(&r, &bv, i) || r != k)
+        {
+            fprintf(stderr, "Bug in kbv_rank!\n");
+            exit(EXIT_FAILURE);
+        }
+        k += kbv_test(&bv, i);
+    }
+    for (size_t k = 0U; k != c; ++k)
+    {
+        if (kbv_select(&r, &bv, k) || r != one[k])
+        {
+            fprintf(stderr, "Bug in kbv_select!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (kbv_select(&r, &bv, c) == 0 || kbv_rank(&r, &bv, n + 1U) == 0)
+    {
+        fprintf(stderr, "Bug in kbitvec range!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (n && (kbv_clear(&bv, n - 1U) || kbv_rank(&r, &bv, 0U) == 0))
+    {
+        fprintf(stderr, "Bug in kbitvec build!\n");
+        exit(EXIT_FAILURE);
+    }
+    free(one);
+    kbv_free(&bv);
+}
+
+void test2(void)
+{
+    kbitvec_t a, b, c;
+    kbv_init(&a);
+    kbv_init(&b);
+    kbv_init(&c);
+    for (unsigned int i = 0U; i != 1000U; ++i)
+    {
+        kbv_push(&a, i % 2U == 0U);
+        kbv_push(&b, i % 3U == 0U);
+    }
+    size_t n[4];
+    kbv_and(&c, &a, &b);
+    n[0] = kbv_count(&c);
+    kbv_or(&c, &a, &b);
+    n[1] = kbv_count(&c);
+    kbv_xor(&c, &a, &b);
+    n[2] = kbv_count(&c);
+    kbv_andnot(&a, &a, &b);
+    n[3] = kbv_count(&a);
+    printf("and %zu or %zu xor %zu andnot %zu\n", n[0], n[1], n[2], n[3]);
+    if (n[0] != 167U || n[1] != 667U || n[2] != 500U || n[3] != 333U)
+    {
+        fprintf(stderr, "Bug in kbitvec operator!\n");
+        exit(EXIT_FAILURE);
+    }
+    kbv_resize(&b, 999U);
+    if (kbv_and(&c, &a, &b) == 0)
+    {
+        fprintf(stderr, "Bug in kbitvec operator!\n");
+        exit(EXIT_FAILURE);
+    }
+    /* shrink and grow again, the bits that are dropped are 0 */
+    kbv_resize(&b, 3U);
+    kbv_resize(&b, 1000U);
+    if (kbv_count(&b) != 1U)
+    {
+        fprintf(stderr, "Bug in kbv_resize!\n");
+        exit(EXIT_FAILURE);
+    }
+    kbv_free(&a);
+    kbv_free(&b);
+    kbv_free(&c);
+}
+
+void test3(void)
+{
+    size_t N = 1U << 24;
+    unsigned int M = 20U;
+    uint64_t s = 88172645463325252U;
+    uint64_t *w = (uint64_t *)malloc(sizeof(uint64_t) * (N >> 6));
+    for (size_t i = 0U; i != N >> 6; ++i)
+    {
+        w[i] = rnd(&s);
+    }
+    kbitvec_t a, b;
+    kbv_init(&a);
+    kbv_init(&b);
+    kbv_load(&a, w, N);
+    kbv_load(&b, w + 1, N - 64U);
+    kbv_resize(&b, N);
+
+    clock_t t = clock();
+    size_t c = 0U;
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        for (size_t i = 0U; i != N; ++i)
+        {
+            c += kbv_test(&a, i) & kbv_test(&b, i);
+        }
+    }
+    printf("bit loop: %.3f sec\n", (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    t = clock();
+    size_t c2 = 0U;
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        kbitvec_t d;
+        kbv_init(&d);
+        kbv_and(&d, &a, &b);
+        c2 += kbv_count(&d);
+        kbv_free(&d);
+    }
+    printf("kbv_and and kbv_count: %.3f sec\n",
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    kbv_build(&a);
+    t = clock();
+    size_t r = 0U, x = 0U;
+    for (size_t i = 0U; i < N; i += 7U)
+    {
+        kbv_rank(&r, &a, i);
+        x += r;
+        kbv_select(&r, &a, r >> 1);
+        x += r;
+    }
+    printf("rank and select: %.3f sec\n",
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    if (c != c2 || x == 0U)
+    {
+        fprintf(stderr, "Bug in kbitvec!\n");
+        exit(EXIT_FAILURE);
+    }
+    free(w);
+    kbv_free(&a);
+    kbv_free(&b);
+}
+
+int main(void)
+{
+    test1(0U, 2U);
+    test1(1U, 1U);
+    test1(64U, 1U);
+    test1(100000U, 2U);
+    test1(100000U, 1U);
+    test1(100000U, 1000U);
+    test1(512U * 9U + 5U, 3U);
+
+    test2();
+
+    test3();
+
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,372 @@
+/*!
+ @file           test_kbtree.c
+ @brief          test B+ tree of ordered map
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kbtree.h"
+#include "kflatmap.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define LT(a, b)     ((a) < (b))
+#define STR_LT(a, b) (strcmp(a, b) < 0)
+
+kbtree_init(u32, uint32_t, uint32_t, LT)
+kbtree_init(str, const char *, size_t, STR_LT)
+kflatmap_init(u32, uint32_t, uint32_t, LT)
+
+/* keys of p are in [lo, hi), the depth of leaves is the same */
+static size_t check1(const kbtree_u32_n *p, uint64_t lo, uint64_t hi,
+                     unsigned int d, unsigned int *leaf)
+{
+    const unsigned int o = kbtree_order(uint32_t, uint32_t);
+    if (!p->n || p->n > o)
+    {
+        fail("number of keys");
+    }
+    for (unsigned int i = 0U; i != p->n; ++i)
+    {
+        if (p->k[i] < lo || p->k[i] >= hi || (i && p->k[i - 1U] >= p->k[i]))
+        {
+            fail("order of keys");
+        }
+    }
+    if (p->leaf)
+    {
+        if (*leaf != d && *leaf != ~0U)
+        {
+            fail("depth of leaves");
+        }
+        *leaf = d;
+        return p->n;
+    }
+    size_t n = 0U;
+    for (unsigned int i = 0U; i <= p->n; ++i)
+    {
+        n += check1(p->u.c[i], i ? p->k[i - 1U] : lo, i < p->n ? p->k[i] : hi, d + 1U, leaf);
+    }
+    return n;
+}
+
+static void check(const kbtree_t(u32) * kb)
+{
+    unsigned int leaf = ~0U;
+    size_t n = kb->root ? check1(kb->root, 0U, (uint64_t)1 << 32, 0U, &leaf) : 0U;
+    if (n != kb->n)
+    {
+        fail("number of tree");
+    }
+}
+
+/* random set, del, get and lower against a direct array */
+void test1(void)
+{
+    const size_t u = 1U << 14;
+    uint32_t *ref = (uint32_t *)calloc(u, sizeof(uint32_t));
+    kbtree_t(u32) kb;
+    kb_u32_init(&kb);
+    size_t n = 0U;
+    uint64_t s = 1U;
+    for (size_t i = 0U; i != 1000000U; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % u);
+        /* grow first, then shrink and grow again */
+        uint32_t r = (uint32_t)(rnd(&s) % 8U) + (i / 250000U & 1U ? 2U : 0U);
+        if (r < 5U)
+        {
+            uint32_t v = (uint32_t)i | 1U;
+            int absent = kb_u32_set(&kb, x, v);
+            if (absent != !ref[x])
+            {
+                fail("set");
+            }
+            n += (size_t)absent;
+            ref[x] = v;
+        }
+        else if (r < 8U)
+        {
+            if (kb_u32_del(&kb, x) != (ref[x] ? 0 : -1))
+            {
+                fail("del");
+            }
+            n -= ref[x] ? 1U : 0U;
+            ref[x] = 0U;
+        }
+        else if (i & 1U)
+        {
+            uint32_t *v = kb_u32_get(&kb, x);
+            if (ref[x] ? !v || *v != ref[x] : v != NULL)
+            {
+                fail("get");
+            }
+        }
+        else
+        {
+            kbtree_i(u32) it;
+            uint32_t y = x;
+            while (y != u && !ref[y])
+            {
+                ++y;
+            }
+            if (kb_u32_lower(&kb, x, &it) ? y != u : y == u || kb_key(it) != y || kb_val(it) != ref[y])
+            {
+                fail("lower");
+            }
+        }
+        if (kb_u32_size(&kb) != n)
+        {
+            fail("size");
+        }
+        if (i % 50000U == 0U)
+        {
+            check(&kb);
+        }
+    }
+    check(&kb);
+    /* nodes are back to the pool, and the pool is not freed before clear */
+    if (kb.kmp.cnt + kb.kmp.n == 0U)
+    {
+        fail("memory pool");
+    }
+    kbtree_i(u32) it;
+    uint32_t x = 0U;
+    for (int e = kb_u32_begin(&kb, &it); !e; e = kb_u32_next(&it))
+    {
+        while (!ref[x])
+        {
+            ++x;
+        }
+        if (kb_key(it) != x || kb_val(it) != ref[x])
+        {
+            fail("order");
+        }
+        ++x;
+    }
+    while (x != u && !ref[x])
+    {
+        ++x;
+    }
+    if (x != u)
+    {
+        fail("iteration");
+    }
+    for (x = 0U; x != u; ++x)
+    {
+        if (ref[x] && kb_u32_del(&kb, x))
+        {
+            fail("del all");
+        }
+    }
+    if (kb_u32_size(&kb) || kb.root || kb.kmp.cnt)
+    {
+        fail("empty");
+    }
+    kb_u32_clear(&kb);
+    free(ref);
+}
+
+/* bulk loading of sorted, unsorted and duplicated keys */
+void test2(void)
+{
+    kbtree_t(u32) kb;
+    kb_u32_init(&kb);
+    uint64_t s = 4U;
+    for (size_t n = 0U; n < 100000U; n = n * 3U + 1U)
+    {
+        for (unsigned int c = 0U; c != 3U; ++c)
+        {
+            kbtree_u32_e *e = (kbtree_u32_e *)malloc(sizeof(kbtree_u32_e) * (n + 1U));
+            for (size_t i = 0U; i != n; ++i)
+            {
+                e[i].k = c == 0U ? (uint32_t)i * 2U : (uint32_t)(rnd(&s) % (c == 1U ? ~0U : n + 1U));
+                e[i].v = e[i].k + 1U;
+            }
+            if (kb_u32_build(&kb, e, n))
+            {
+                fail("build");
+            }
+            check(&kb);
+            size_t m = 0U;
+            kbtree_i(u32) it;
+            for (int r = kb_u32_begin(&kb, &it); !r; r = kb_u32_next(&it), ++m)
+            {
+                if (m && e[m - 1U].k >= kb_key(it))
+                {
+                    fail("build order");
+                }
+                if (e[m].k != kb_key(it) || kb_val(it) != kb_key(it) + 1U)
+                {
+                    fail("build keys");
+                }
+            }
+            if (m != kb_u32_size(&kb))
+            {
+                fail("build size");
+            }
+            /* the tree goes on after build */
+            (void)kb_u32_set(&kb, 1U, 2U);
+            (void)kb_u32_del(&kb, 0U);
+            check(&kb);
+            free(e);
+        }
+    }
+    kb_u32_clear(&kb);
+}
+
+/* keys of c strings */
+void test3(void)
+{
+    static const char *const s[] = {"pear", "apple", "fig", "kiwi", "apple", "date"};
+    kbtree_t(str) kb;
+    kb_str_init(&kb);
+    for (size_t i = 0U; i != sizeof(s) / sizeof(*s); ++i)
+    {
+        int absent = 0;
+        size_t *v = kb_str_put(&kb, s[i], &absent);
+        *v = absent ? 1U : *v + 1U;
+    }
+    kbtree_i(str) it;
+    for (int e = kb_str_begin(&kb, &it); !e; e = kb_str_next(&it))
+    {
+        printf("%s:%zu ", kb_key(it), kb_val(it));
+    }
+    putchar('\n');
+    if (kb_str_size(&kb) != 5U || *kb_str_get(&kb, "apple") != 2U ||
+        kb_str_lower(&kb, "e", &it) || strcmp(kb_key(it), "fig"))
+    {
+        fail("string keys");
+    }
+    kb_str_clear(&kb);
+}
+
+void test4(size_t n)
+{
+    kbtree_t(u32) kb;
+    kflatmap_t(u32) kf;
+    kb_u32_init(&kb);
+    kfm_u32_init(&kf);
+    printf("order %u, node %zu bytes\n", (unsigned int)kbtree_order(uint32_t, uint32_t), sizeof(kbtree_u32_n));
+    uint64_t s = 2U;
+    double t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        (void)kb_u32_set(&kb, (uint32_t)rnd(&s), (uint32_t)i);
+    }
+    printf("kbtree set      %zu: %.3f sec\n", n, now() - t);
+    s = 2U;
+    t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        (void)kfm_u32_set(&kf, (uint32_t)rnd(&s), (uint32_t)i);
+    }
+    (void)kfm_u32_flush(&kf);
+    printf("kflatmap set    %zu: %.3f sec\n", n, now() - t);
+
+    size_t c = 0U;
+    s = 3U;
+    t = now();
+    for (size_t i = 0U; i != 4000000U; ++i)
+    {
+        c += kb_u32_get(&kb, (uint32_t)rnd(&s)) != NULL;
+    }
+    printf("kbtree get      : %.3f sec\n", now() - t);
+    s = 3U;
+    t = now();
+    for (size_t i = 0U; i != 4000000U; ++i)
+    {
+        c -= kfm_u32_get(&kf, (uint32_t)rnd(&s)) != NULL;
+    }
+    printf("kflatmap get    : %.3f sec\n", now() - t);
+    if (c)
+    {
+        fail("get");
+    }
+
+    /* scans of 100 keys from random places */
+    uint64_t sum = 0U;
+    s = 5U;
+    t = now();
+    for (size_t i = 0U; i != 100000U; ++i)
+    {
+        kbtree_i(u32) it;
+        int e = kb_u32_lower(&kb, (uint32_t)rnd(&s), &it);
+        for (unsigned int j = 0U; !e && j != 100U; ++j, e = kb_u32_next(&it))
+        {
+            sum += kb_val(it);
+        }
+    }
+    printf("kbtree scan     : %.3f sec\n", now() - t);
+    s = 5U;
+    t = now();
+    for (size_t i = 0U; i != 100000U; ++i)
+    {
+        size_t l = kfm_u32_lower(&kf, (uint32_t)rnd(&s));
+        for (size_t j = l; j != kf.s && j != l + 100U; ++j)
+        {
+            sum -= kf.v.v[j];
+        }
+    }
+    printf("kflatmap scan   : %.3f sec\n", now() - t);
+    if (sum)
+    {
+        fail("scan");
+    }
+
+    kbtree_u32_e *e = (kbtree_u32_e *)malloc(sizeof(kbtree_u32_e) * n);
+    s = 2U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        e[i].k = (uint32_t)rnd(&s);
+        e[i].v = (uint32_t)i;
+    }
+    t = now();
+    (void)kb_u32_build(&kb, e, n);
+    printf("kbtree build    %zu: %.3f sec\n", n, now() - t);
+    t = now();
+    (void)kb_u32_build(&kb, e, n);
+    printf("kbtree build sorted: %.3f sec\n", now() - t);
+    if (kb_u32_size(&kb) != kfm_u32_size(&kf))
+    {
+        fail("build");
+    }
+    free(e);
+    kb_u32_clear(&kb);
+    kfm_u32_clear(&kf);
+}
+
+int main(void)
+{
+    test1();
+    test2();
+    test3();
+    test4(100000U);
+    test4(4000000U);
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,435 @@
+/*!
+ @file           test_kcskiplist.c
+ @brief          test lock-free skip list of ordered map
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kcskiplist.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define LT(a, b) ((a) < (b))
+
+kcskiplist_init(u32, uint32_t, uint32_t, LT)
+kskiplist_init(u32, uint32_t, uint32_t, LT)
+
+/* nothing is marked or unordered when no thread is running */
+static size_t check(const kcskiplist_t(u32) * kl)
+{
+    size_t n = 0U;
+    for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)
+    {
+        for (const kcskiplist_u32_n *p = kl->head[i]; p; p = p->next[i])
+        {
+            if (KCSKIPLIST_MARKED(p->next[i]) || p->h <= i || i >= kl->lv ||
+                (p->next[i] && !LT(p->k, p->next[i]->k)))
+            {
+                fail("order of level");
+            }
+            n += i ? 0U : 1U;
+        }
+    }
+    return n;
+}
+
+/* random add, del, get and lower of one thread against a direct array */
+void test1(void)
+{
+    const size_t u = 1U << 14;
+    uint32_t *ref = (uint32_t *)calloc(u, sizeof(uint32_t));
+    kcskiplist_t(u32) kl;
+    kcsl_u32_init(&kl);
+    kcskiplist_h(u32) *h = kcsl_u32_join(&kl);
+    size_t n = 0U;
+    uint64_t s = 1U;
+    for (size_t i = 0U; i != 1000000U; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % u);
+        uint32_t r = (uint32_t)(rnd(&s) % 8U) + (i / 250000U & 1U ? 2U : 0U);
+        uint32_t k = 0U, v = 0U;
+        if (r < 5U)
+        {
+            int ok = kcsl_u32_add(h, x, (uint32_t)i | 1U);
+            if (ok != !ref[x])
+            {
+                fail("add");
+            }
+            n += (size_t)ok;
+            ref[x] = ref[x] ? ref[x] : (uint32_t)i | 1U;
+        }
+        else if (r < 8U)
+        {
+            if (kcsl_u32_del(h, x) != (ref[x] ? 0 : -1))
+            {
+                fail("del");
+            }
+            n -= ref[x] ? 1U : 0U;
+            ref[x] = 0U;
+        }
+        else if (i & 1U)
+        {
+            if (ref[x] ? kcsl_u32_get(h, x, &v) || v != ref[x] : !kcsl_u32_get(h, x, &v))
+            {
+                fail("get");
+            }
+        }
+        else
+        {
+            uint32_t y = x;
+            while (y != u && !ref[y])
+            {
+                ++y;
+            }
+            int e = kcsl_u32_lower(h, x, &k, &v);
+            if (e ? y != u : y == u || k != y || v != ref[y])
+            {
+                fail("lower");
+            }
+        }
+        if (kcsl_u32_size(&kl) != n)
+        {
+            fail("size");
+        }
+    }
+    if (check(&kl) != n)
+    {
+        fail("number of list");
+    }
+    kcsl_u32_leave(h);
+    /* the handle is joined again */
+    if (kcsl_u32_join(&kl) != h)
+    {
+        fail("join");
+    }
+    kcsl_u32_clear(&kl);
+    free(ref);
+}
+
+typedef struct
+{
+    kcskiplist_t(u32) * kl;
+    pthread_rwlock_t *lock;
+    kskiplist_t(u32) * sl;
+    uint64_t seed;
+    size_t ops;
+    uint32_t range;
+    unsigned int id;
+    unsigned int nt;
+    unsigned int read;
+    long added;
+} task_t;
+
+/* all threads on a small range of keys, counts of added and deleted */
+static void *shared(void *arg)
+{
+    task_t *t = (task_t *)arg;
+    kcskiplist_h(u32) *h = kcsl_u32_join(t->kl);
+    uint64_t s = t->seed;
+    for (size_t i = 0U; i != t->ops; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % t->range), v = 0U;
+        switch (rnd(&s) % 4U)
+        {
+        case 0:
+        case 1:
+            t->added += kcsl_u32_add(h, x, x * 2U + 1U);
+            break;
+        case 2:
+            t->added -= kcsl_u32_del(h, x) ? 0 : 1;
+            break;
+        default:
+            if (!kcsl_u32_get(h, x, &v) && v != x * 2U + 1U)
+            {
+                fail("value");
+            }
+        }
+        if (i % 10000U == 0U)
+        {
+            /* a thread leaves and joins again */
+            kcsl_u32_leave(h);
+            h = kcsl_u32_join(t->kl);
+        }
+    }
+    kcsl_u32_leave(h);
+    return NULL;
+}
+
+/* each thread has its own keys, the last state of each key is known */
+static void *owned(void *arg)
+{
+    task_t *t = (task_t *)arg;
+    kcskiplist_h(u32) *h = kcsl_u32_join(t->kl);
+    uint64_t s = t->seed;
+    for (size_t i = 0U; i != t->ops; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % t->range) * t->nt + t->id;
+        if (rnd(&s) & 1U)
+        {
+            (void)kcsl_u32_add(h, x, x);
+        }
+        else
+        {
+            (void)kcsl_u32_del(h, x);
+        }
+    }
+    kcsl_u32_leave(h);
+    return NULL;
+}
+
+/* all threads add and delete the same two keys, the nodes of one key
+   are linked in front of the deleted ones that are not unlinked yet */
+static void *same(void *arg)
+{
+    task_t *t = (task_t *)arg;
+    kcskiplist_h(u32) *h = kcsl_u32_join(t->kl);
+    uint64_t s = t->seed;
+    for (size_t i = 0U; i != t->ops; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) & 1U) + 1U, k = 0U, v = 0U;
+        switch (rnd(&s) % 3U)
+        {
+        case 0:
+            t->added += kcsl_u32_add(h, x, x * 2U + 1U);
+            break;
+        case 1:
+            t->added -= kcsl_u32_del(h, x) ? 0 : 1;
+            break;
+        default:
+            if (!kcsl_u32_lower(h, 0U, &k, &v) && (k - 1U > 1U || v != k * 2U + 1U))
+            {
+                fail("same key");
+            }
+        }
+    }
+    kcsl_u32_leave(h);
+    return NULL;
+}
+
+void test2(unsigned int nt)
+{
+    kcskiplist_t(u32) kl;
+    kcsl_u32_init(&kl);
+    pthread_t tid[16];
+    task_t task[16];
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        memset(task + i, 0, sizeof(*task));
+        task[i].kl = &kl;
+        task[i].seed = i + 1U;
+        task[i].ops = 200000U;
+        task[i].range = 512U;
+        (void)pthread_create(tid + i, NULL, shared, task + i);
+    }
+    long added = 0;
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_join(tid[i], NULL);
+        added += task[i].added;
+    }
+    if (check(&kl) != (size_t)added || kcsl_u32_size(&kl) != (size_t)added)
+    {
+        fail("shared keys");
+    }
+    kcsl_u32_clear(&kl);
+
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        task[i].added = 0;
+        (void)pthread_create(tid + i, NULL, same, task + i);
+    }
+    added = 0;
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_join(tid[i], NULL);
+        added += task[i].added;
+    }
+    if (check(&kl) != (size_t)added || kcsl_u32_size(&kl) != (size_t)added)
+    {
+        fail("same keys");
+    }
+    kcsl_u32_clear(&kl);
+
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        task[i].id = i;
+        task[i].nt = nt;
+        (void)pthread_create(tid + i, NULL, owned, task + i);
+    }
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_join(tid[i], NULL);
+    }
+    /* the same ops again on one thread give the last state of keys */
+    kcskiplist_h(u32) *h = kcsl_u32_join(&kl);
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        uint64_t s = task[i].seed;
+        uint8_t in[512];
+        memset(in, 0, sizeof(in));
+        for (size_t j = 0U; j != task[i].ops; ++j)
+        {
+            uint32_t x = (uint32_t)(rnd(&s) % task[i].range);
+            in[x] = (uint8_t)(rnd(&s) & 1U);
+        }
+        for (uint32_t x = 0U; x != task[i].range; ++x)
+        {
+            if (kcsl_u32_get(h, x * nt + i, NULL) != (in[x] ? 0 : -1))
+            {
+                fail("owned keys");
+            }
+        }
+    }
+    if (check(&kl) != kcsl_u32_size(&kl))
+    {
+        fail("size");
+    }
+    kcsl_u32_clear(&kl);
+    printf("%u threads: passed\n", nt);
+}
+
+static void *bench(void *arg)
+{
+    task_t *t = (task_t *)arg;
+    kcskiplist_h(u32) *h = t->kl ? kcsl_u32_join(t->kl) : NULL;
+    uint64_t s = t->seed;
+    for (size_t i = 0U; i != t->ops; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % t->range);
+        uint32_t r = (uint32_t)(rnd(&s) % 100U);
+        if (h)
+        {
+            if (r < t->read)
+            {
+                (void)kcsl_u32_get(h, x, NULL);
+            }
+            else if (r & 1U)
+            {
+                (void)kcsl_u32_add(h, x, x);
+            }
+            else
+            {
+                (void)kcsl_u32_del(h, x);
+            }
+        }
+        else if (r < t->read)
+        {
+            pthread_rwlock_rdlock(t->lock);
+            (void)ksl_u32_get(t->sl, x);
+            pthread_rwlock_unlock(t->lock);
+        }
+        else
+        {
+            pthread_rwlock_wrlock(t->lock);
+            if (r & 1U)
+            {
+                (void)ksl_u32_set(t->sl, x, x);
+            }
+            else
+            {
+                (void)ksl_u32_del(t->sl, x);
+            }
+            pthread_rwlock_unlock(t->lock);
+        }
+    }
+    if (h)
+    {
+        kcsl_u32_leave(h);
+    }
+    return NULL;
+}
+
+/* read-heavy and write-heavy mixes against a skip list under rwlock */
+void test3(unsigned int read)
+{
+    const uint32_t range = 1U << 18;
+    for (unsigned int nt = 1U; nt <= 16U; nt <<= 1)
+    {
+        double tt[2];
+        for (unsigned int c = 0U; c != 2U; ++c)
+        {
+            kcskiplist_t(u32) kl;
+            kskiplist_t(u32) sl;
+            pthread_rwlock_t lock;
+            kcsl_u32_init(&kl);
+            ksl_u32_init(&sl);
+            pthread_rwlock_init(&lock, NULL);
+            kcskiplist_h(u32) *h = kcsl_u32_join(&kl);
+            uint64_t s = 7U;
+            for (uint32_t i = 0U; i != range >> 1; ++i)
+            {
+                uint32_t x = (uint32_t)(rnd(&s) % range);
+                if (c)
+                {
+                    (void)ksl_u32_set(&sl, x, x);
+                }
+                else
+                {
+                    (void)kcsl_u32_add(h, x, x);
+                }
+            }
+            kcsl_u32_leave(h);
+            pthread_t tid[16];
+            task_t task[16];
+            double t = now();
+            for (unsigned int i = 0U; i != nt; ++i)
+            {
+                memset(task + i, 0, sizeof(*task));
+                task[i].kl = c ? NULL : &kl;
+                task[i].sl = &sl;
+                task[i].lock = &lock;
+                task[i].seed = i + 11U;
+                task[i].ops = 400000U / nt;
+                task[i].range = range;
+                task[i].read = read;
+                (void)pthread_create(tid + i, NULL, bench, task + i);
+            }
+            for (unsigned int i = 0U; i != nt; ++i)
+            {
+                (void)pthread_join(tid[i], NULL);
+            }
+            tt[c] = now() - t;
+            pthread_rwlock_destroy(&lock);
+            ksl_u32_clear(&sl);
+            kcsl_u32_clear(&kl);
+        }
+        printf("%u%% read, %2u threads: lock-free %.3f sec, rwlock %.3f sec\n", read, nt, tt[0], tt[1]);
+    }
+}
+
+int main(void)
+{
+    test1();
+    test2(2U);
+    test2(8U);
+    test2(16U);
+    test3(90U);
+    test3(50U);
+    return 0;
+}
+
+/* END OF FILE */
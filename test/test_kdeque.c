@@ -0,0 +1,168 @@
+/*!
+ @file           test_kdeque.c
+ @brief          test double-ended queue library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kdeque.h"
+#include "klist.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define test_free(x) (void)(x)
+
+kdeque_init(i64, int64_t)
+klist_init(i64, int64_t, test_free)
+
+/* random operations at both ends against an array in the middle */
+void test1(void)
+{
+    size_t c = 1U << 20;
+    int64_t *ref = (int64_t *)malloc(sizeof(int64_t) * 2U * c);
+    size_t lo = c, hi = c;
+    uint64_t s = 88172645463325252U;
+    kdeque_t(i64) kq;
+    kdq_i64_init(&kq);
+    for (size_t k = 0U; k != 1000000U; ++k)
+    {
+        uint64_t r = rnd(&s);
+        int64_t x = (int64_t)(r >> 8);
+        int64_t y = 0;
+        switch (r & 3U)
+        {
+        case 0U:
+            kdq_i64_push(&kq, x);
+            ref[hi++] = x;
+            break;
+        case 1U:
+            kdq_i64_unshift(&kq, x);
+            ref[--lo] = x;
+            break;
+        case 2U:
+            if (kdq_i64_pop(&y, &kq) != (lo == hi ? -1 : 0) ||
+                (lo != hi && y != ref[--hi]))
+            {
+                fprintf(stderr, "Bug in kdq_i64_pop!\n");
+                exit(EXIT_FAILURE);
+            }
+            break;
+        default:
+            if (kdq_i64_shift(&y, &kq) != (lo == hi ? -1 : 0) ||
+                (lo != hi && y != ref[lo++]))
+            {
+                fprintf(stderr, "Bug in kdq_i64_shift!\n");
+                exit(EXIT_FAILURE);
+            }
+            break;
+        }
+        if (kdq_i64_size(&kq) != hi - lo)
+        {
+            fprintf(stderr, "Bug in kdq_i64_size!\n");
+            exit(EXIT_FAILURE);
+        }
+        if ((k & 1023U) == 0U)
+        {
+            for (size_t i = lo; i != hi; ++i)
+            {
+                if (*kdq_i64_at(&kq, i - lo) != ref[i] ||
+                    kdq_v(kq, i - lo) != ref[i])
+                {
+                    fprintf(stderr, "Bug in kdq_i64_at!\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            if (kdq_i64_at(&kq, hi - lo) ||
+                (lo != hi && (*kdq_i64_front(&kq) != ref[lo] ||
+                              *kdq_i64_back(&kq) != ref[hi - 1U])))
+            {
+                fprintf(stderr, "Bug in kdq_i64_front!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    kdq_i64_clear(&kq);
+    free(ref);
+}
+
+/* sliding window sum of w elements */
+void test2(size_t n, size_t w)
+{
+    uint64_t s = 88172645463325252U;
+    kdeque_t(i64) kq;
+    kdq_i64_init(&kq);
+    double t = now();
+    int64_t a = 0, sum = 0, x = 0;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        x = (int64_t)(rnd(&s) & 0xFFFFU);
+        kdq_i64_push(&kq, x);
+        sum += x;
+        if (kdq_i64_size(&kq) > w)
+        {
+            kdq_i64_shift(&x, &kq);
+            sum -= x;
+        }
+        a += sum;
+    }
+    printf("kdeque window: %.3f sec\n", now() - t);
+    kdq_i64_clear(&kq);
+
+    s = 88172645463325252U;
+    kl_i64_t *kl = kl_i64_initp();
+    t = now();
+    int64_t b = 0;
+    sum = 0;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        x = (int64_t)(rnd(&s) & 0xFFFFU);
+        kl_i64_push(kl, x);
+        sum += x;
+        if (kl->size > w)
+        {
+            kl_i64_shift(kl, &x);
+            sum -= x;
+        }
+        b += sum;
+    }
+    printf("klist  window: %.3f sec\n", now() - t);
+    kl_i64_pclear(&kl);
+
+    if (a != b)
+    {
+        fprintf(stderr, "Bug in kdq_i64_shift!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(void)
+{
+    test1();
+    test2(10000000U, 1000U);
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,304 @@
+/*!
+ @file           test_kebr.c
+ @brief          test epoch based reclamation of memory
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kebr.h"
+#include "klist.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define LIVE 0x1DEA5EEDU
+#define DEAD 0xDEADBEEFU
+
+typedef struct
+{
+    kebr_node_t r;
+    unsigned int magic;
+    unsigned int x;
+} obj_t;
+
+kmempool_type(obj, obj_t);
+
+typedef struct
+{
+    kmp_obj_t kmp;
+    size_t retired;
+    size_t freed;
+    kebr_t *d;
+    obj_t **slot;
+    uint64_t seed;
+    size_t ops;
+    int writer;
+} ctx_t;
+
+/* the memory is poisoned before it is back to the pool */
+static void obj_free(void *arg, kebr_node_t *r)
+{
+    ctx_t *c = (ctx_t *)arg;
+    obj_t *p = kebr_entry(r, obj_t, r);
+    if (p->magic != LIVE)
+    {
+        fail("double free");
+    }
+    p->magic = DEAD;
+    ++c->freed;
+    (void)kmp_free(obj_t, c->kmp, p);
+}
+
+static obj_t *obj_new(ctx_t *c, unsigned int x)
+{
+    obj_t *p = kmp_alloc(obj_t, c->kmp);
+    p->magic = LIVE;
+    p->x = x;
+    return p;
+}
+
+static void ctx_clear(ctx_t *c)
+{
+    kmp_clear((void), c->kmp);
+}
+
+/* a thread in critical section holds the epoch back */
+void test1(void)
+{
+    kebr_t d;
+    ctx_t c;
+    memset(&c, 0, sizeof(c));
+    kmp_init(c.kmp);
+    kebr_init(&d);
+    kebr_thread_t *a = kebr_join(&d, obj_free, &c);
+    kebr_thread_t *b = kebr_join(&d, obj_free, &c);
+    if (!a || !b || a == b || (uintptr_t)a % KEBR_LINE || (uintptr_t)b % KEBR_LINE)
+    {
+        fail("join");
+    }
+    kebr_enter(b);
+    for (unsigned int i = 0U; i != 10U; ++i)
+    {
+        kebr_enter(a);
+        kebr_retire(a, &obj_new(&c, i)->r);
+        kebr_exit(a);
+    }
+    if (kebr_advance(a) || !kebr_advance(a) || !kebr_advance(a) || c.freed)
+    {
+        fail("stalled thread");
+    }
+    kebr_exit(b);
+    if (kebr_advance(a) || c.freed != 10U)
+    {
+        fail("grace period");
+    }
+
+    /* the nodes of a record that is left are freed by others */
+    kebr_retire(a, &obj_new(&c, 10U)->r);
+    kebr_leave(a);
+    (void)kebr_advance(b);
+    (void)kebr_advance(b);
+    if (c.freed != 11U)
+    {
+        fail("left record");
+    }
+
+    /* a record with nodes of another function is not taken */
+    kebr_thread_t *e = kebr_join(&d, obj_free, &c);
+    kebr_retire(e, &obj_new(&c, 11U)->r);
+    kebr_leave(e);
+    ctx_t o;
+    memset(&o, 0, sizeof(o));
+    kebr_thread_t *f = kebr_join(&d, obj_free, &o);
+    if (f == e)
+    {
+        fail("reuse of record");
+    }
+    kebr_leave(f);
+    kebr_leave(b);
+    kebr_clear(&d);
+    if (c.freed != 12U || o.freed)
+    {
+        fail("clear");
+    }
+    ctx_clear(&c);
+}
+
+/* readers check the objects that writers replace and retire */
+static void *task(void *arg)
+{
+    ctx_t *c = (ctx_t *)arg;
+    kebr_thread_t *t = kebr_join(c->d, obj_free, c);
+    uint64_t s = c->seed;
+    for (size_t i = 0U; i != c->ops; ++i)
+    {
+        obj_t **slot = c->slot + rnd(&s) % 64U;
+        kebr_enter(t);
+        if (c->writer)
+        {
+            obj_t *p = obj_new(c, (unsigned int)i);
+            p = __atomic_exchange_n(slot, p, __ATOMIC_ACQ_REL);
+            kebr_retire(t, &p->r);
+            ++c->retired;
+        }
+        else
+        {
+            obj_t *p = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+            if (p->magic != LIVE)
+            {
+                fail("use after free");
+            }
+        }
+        kebr_exit(t);
+        if (i % 4096U == 0U)
+        {
+            kebr_leave(t);
+            t = kebr_join(c->d, obj_free, c);
+        }
+    }
+    kebr_leave(t);
+    return NULL;
+}
+
+void test2(unsigned int nt)
+{
+    kebr_t d;
+    obj_t *slot[64];
+    pthread_t tid[16];
+    ctx_t c[16];
+    kebr_init(&d);
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        memset(c + i, 0, sizeof(*c));
+        kmp_init(c[i].kmp);
+        c[i].d = &d;
+        c[i].slot = slot;
+        c[i].seed = i + 1U;
+        c[i].ops = 200000U;
+        c[i].writer = i & 1U;
+    }
+    for (unsigned int i = 0U; i != 64U; ++i)
+    {
+        slot[i] = obj_new(c, i);
+    }
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_create(tid + i, NULL, task, c + i);
+    }
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_join(tid[i], NULL);
+    }
+    size_t n = 0U, pending = 0U;
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        pending += c[i].retired - c[i].freed;
+    }
+    kebr_clear(&d);
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        n += c[i].retired - c[i].freed;
+    }
+    printf("%2u threads: %zu nodes are pending at the end\n", nt, pending);
+    if (n)
+    {
+        fail("number of freed");
+    }
+    for (unsigned int i = 0U; i != 64U; ++i)
+    {
+        slot[i]->magic = DEAD;
+        (void)kmp_free(obj_t, c->kmp, slot[i]);
+    }
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        ctx_clear(c + i);
+    }
+}
+
+/* the cost of a critical section and of a retired node */
+void test3(void)
+{
+    const size_t n = 10000000U;
+    kebr_t d;
+    ctx_t c;
+    memset(&c, 0, sizeof(c));
+    kmp_init(c.kmp);
+    kebr_init(&d);
+    kebr_thread_t *t = kebr_join(&d, obj_free, &c);
+    if (!t)
+    {
+        fail("join");
+    }
+    double s = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kebr_enter(t);
+        kebr_exit(t);
+    }
+    printf("enter and exit : %.2f ns\n", (now() - s) * 1e9 / (double)n);
+    pthread_mutex_t mtx;
+    pthread_mutex_init(&mtx, NULL);
+    s = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        pthread_mutex_lock(&mtx);
+        pthread_mutex_unlock(&mtx);
+    }
+    printf("mutex lock     : %.2f ns\n", (now() - s) * 1e9 / (double)n);
+    pthread_mutex_destroy(&mtx);
+    pthread_rwlock_t rw;
+    pthread_rwlock_init(&rw, NULL);
+    s = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        pthread_rwlock_rdlock(&rw);
+        pthread_rwlock_unlock(&rw);
+    }
+    printf("rwlock rdlock  : %.2f ns\n", (now() - s) * 1e9 / (double)n);
+    pthread_rwlock_destroy(&rw);
+    s = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kebr_retire(t, &obj_new(&c, (unsigned int)i)->r);
+    }
+    printf("alloc and retire: %.2f ns\n", (now() - s) * 1e9 / (double)n);
+    kebr_leave(t);
+    kebr_clear(&d);
+    ctx_clear(&c);
+}
+
+int main(void)
+{
+    test1();
+    test2(2U);
+    test2(8U);
+    test2(16U);
+    test3();
+    return 0;
+}
+
+/* END OF FILE */
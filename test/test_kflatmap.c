@@ -0,0 +1,293 @@
+/*!
+ @file           test_kflatmap.c
+ @brief          test sorted flat map
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kflatmap.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define LT(a, b)     ((a) < (b))
+#define STR_LT(a, b) (strcmp(a, b) < 0)
+
+kflatmap_init(u32, uint32_t, uint32_t, LT)
+kflatmap_init(str, const char *, size_t, STR_LT)
+
+static void check(const kflatmap_t(u32) * kf)
+{
+    for (size_t i = 1U; i < kf->s; ++i)
+    {
+        if (!LT(kf->k.v[i - 1U], kf->k.v[i]))
+        {
+            fail("sorted keys");
+        }
+    }
+}
+
+/* random set, del and get against a direct array */
+void test1(void)
+{
+    const size_t u = 1U << 14;
+    uint32_t *ref = (uint32_t *)calloc(u, sizeof(uint32_t));
+    kflatmap_t(u32) kf;
+    kfm_u32_init(&kf);
+    size_t n = 0U;
+    uint64_t s = 1U;
+    for (size_t i = 0U; i != 1000000U; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % u);
+        uint32_t r = (uint32_t)(rnd(&s) % 8U);
+        if (r < 5U)
+        {
+            uint32_t v = (uint32_t)i | 1U;
+            int absent = kfm_u32_set(&kf, x, v);
+            if (absent != !ref[x])
+            {
+                fail("set");
+            }
+            n += (size_t)absent;
+            ref[x] = v;
+        }
+        else if (r < 7U)
+        {
+            if (kfm_u32_del(&kf, x) != (ref[x] ? 0 : -1))
+            {
+                fail("del");
+            }
+            n -= ref[x] ? 1U : 0U;
+            ref[x] = 0U;
+        }
+        else if (i & 1U)
+        {
+            /* a batch with duplicates, the last value is kept */
+            uint32_t k[16], v[16];
+            for (uint32_t j = 0U; j != 16U; ++j)
+            {
+                k[j] = (uint32_t)(rnd(&s) % (j & 1U ? 16U : u));
+                v[j] = ((uint32_t)i << 4 | j) | 1U;
+            }
+            if (kfm_u32_insert(&kf, k, v, 16U))
+            {
+                fail("insert");
+            }
+            for (uint32_t j = 0U; j != 16U; ++j)
+            {
+                n += ref[k[j]] ? 0U : 1U;
+                ref[k[j]] = v[j];
+            }
+        }
+        else
+        {
+            uint32_t *v = kfm_u32_get(&kf, x);
+            if (ref[x] ? !v || *v != ref[x] : v != NULL)
+            {
+                fail("get");
+            }
+        }
+        if (kfm_u32_size(&kf) != n)
+        {
+            fail("size");
+        }
+        if (i % 100000U == 0U)
+        {
+            check(&kf);
+        }
+    }
+    if (kfm_u32_flush(&kf) || kf.s != n)
+    {
+        fail("flush");
+    }
+    check(&kf);
+    size_t j = 0U;
+    for (uint32_t x = 0U; x != u; ++x)
+    {
+        if (ref[x])
+        {
+            if (kf.k.v[j] != x || kf.v.v[j] != ref[x])
+            {
+                fail("order");
+            }
+            ++j;
+        }
+        size_t l = kfm_u32_lower(&kf, x);
+        if (l != j - (ref[x] ? 1U : 0U))
+        {
+            fail("lower");
+        }
+    }
+    kfm_u32_clear(&kf);
+    free(ref);
+}
+
+/* keys of c strings */
+void test2(void)
+{
+    static const char *const s[] = {"pear", "apple", "fig", "kiwi", "apple", "date"};
+    kflatmap_t(str) kf;
+    kfm_str_init(&kf);
+    for (size_t i = 0U; i != sizeof(s) / sizeof(*s); ++i)
+    {
+        int absent = 0;
+        size_t *v = kfm_str_put(&kf, s[i], &absent);
+        *v = absent ? 1U : *v + 1U;
+    }
+    (void)kfm_str_flush(&kf);
+    for (size_t i = 0U; i != kfm_str_size(&kf); ++i)
+    {
+        printf("%s:%zu ", kf.k.v[i], kf.v.v[i]);
+    }
+    putchar('\n');
+    if (kfm_str_size(&kf) != 5U || *kfm_str_get(&kf, "apple") != 2U)
+    {
+        fail("string keys");
+    }
+    kfm_str_clear(&kf);
+}
+
+/* one by one sorted insertion, O(n) per element */
+static void insert1(uint32_t *k, uint32_t *v, size_t *n, uint32_t x)
+{
+    size_t i = 0U;
+    while (i != *n && k[i] < x)
+    {
+        ++i;
+    }
+    if (i != *n && k[i] == x)
+    {
+        v[i] = x;
+        return;
+    }
+    (void)memmove(k + i + 1U, k + i, sizeof(uint32_t) * (*n - i));
+    (void)memmove(v + i + 1U, v + i, sizeof(uint32_t) * (*n - i));
+    k[i] = v[i] = x;
+    ++*n;
+}
+
+/* branchy binary search */
+static size_t lower1(const uint32_t *k, size_t n, uint32_t x)
+{
+    size_t lo = 0U, hi = n;
+    while (lo < hi)
+    {
+        size_t mid = lo + ((hi - lo) >> 1);
+        if (k[mid] < x)
+        {
+            lo = mid + 1U;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void test3(size_t n)
+{
+    kflatmap_t(u32) kf;
+    kfm_u32_init(&kf);
+    uint64_t s = 2U;
+    double t = now();
+    if (n <= 100000U)
+    {
+        for (size_t i = 0U; i != n; ++i)
+        {
+            (void)kfm_u32_set(&kf, (uint32_t)rnd(&s), (uint32_t)i);
+        }
+        (void)kfm_u32_flush(&kf);
+        printf("kflatmap set    %zu: %.3f sec\n", n, now() - t);
+        kfm_u32_clear(&kf);
+        s = 2U;
+        t = now();
+    }
+    /* bursts of inserts */
+    uint32_t *b = (uint32_t *)malloc(sizeof(uint32_t) * 65536U);
+    for (size_t i = 0U; i < n; i += 65536U)
+    {
+        size_t c = n - i < 65536U ? n - i : 65536U;
+        for (size_t j = 0U; j != c; ++j)
+        {
+            b[j] = (uint32_t)rnd(&s);
+        }
+        (void)kfm_u32_insert(&kf, b, b, c);
+    }
+    free(b);
+    printf("kflatmap insert %zu: %.3f sec\n", n, now() - t);
+
+    if (n <= 100000U)
+    {
+        uint32_t *k = (uint32_t *)malloc(sizeof(uint32_t) * n);
+        uint32_t *v = (uint32_t *)malloc(sizeof(uint32_t) * n);
+        size_t m = 0U;
+        s = 2U;
+        t = now();
+        for (size_t i = 0U; i != n; ++i)
+        {
+            insert1(k, v, &m, (uint32_t)rnd(&s));
+        }
+        printf("sorted insert   %zu: %.3f sec\n", n, now() - t);
+        if (m != kfm_u32_size(&kf) || memcmp(k, kf.k.v, sizeof(uint32_t) * m))
+        {
+            fail("sorted insert");
+        }
+        free(k);
+        free(v);
+    }
+
+    size_t c = 0U;
+    s = 3U;
+    t = now();
+    for (size_t i = 0U; i != 4000000U; ++i)
+    {
+        c += kfm_u32_lower(&kf, (uint32_t)rnd(&s));
+    }
+    printf("branchless lower: %.3f sec\n", now() - t);
+    s = 3U;
+    t = now();
+    for (size_t i = 0U; i != 4000000U; ++i)
+    {
+        c -= lower1(kf.k.v, kf.s, (uint32_t)rnd(&s));
+    }
+    printf("branchy lower   : %.3f sec\n", now() - t);
+    if (c)
+    {
+        fail("lower");
+    }
+    kfm_u32_clear(&kf);
+}
+
+int main(void)
+{
+    test1();
+    test2();
+    test3(100000U);
+    test3(4000000U);
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,227 @@
+/*!
+ @file           test_khash.c
+ @brief          test hash map library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "khash.h"
+#include "ksort.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+khash_init(u64, uint64_t, uint64_t, kh_hash_u64, kh_eq)
+khash_init(str, const char *, size_t, kh_hash_str, kh_str_eq)
+
+/* a bad hash, all keys go to the same group at first */
+#define hash_bad(x) ((uint64_t)(x)&0x7FU)
+khash_init(bad, uint64_t, uint64_t, hash_bad, kh_eq)
+
+#define LT(a, b) ((a) < (b))
+
+/* random set and del against a direct array */
+void test1(void)
+{
+    const size_t u = 1U << 16;
+    uint64_t *ref = (uint64_t *)calloc(u, sizeof(uint64_t));
+    uint64_t s = 88172645463325252U;
+    khash_t(u64) kh;
+    kh_u64_init(&kh);
+    size_t n = 0U;
+    for (size_t k = 0U; k != 2000000U; ++k)
+    {
+        uint64_t r = rnd(&s);
+        /* the number of keys goes up and down */
+        uint64_t x = (r >> 8) % ((k >> 18) & 1U ? u >> 4 : u);
+        if (r & 1U)
+        {
+            int ret = kh_u64_set(&kh, x, r | 1U);
+            if (ret != !ref[x])
+            {
+                fprintf(stderr, "Bug in kh_u64_set!\n");
+                exit(EXIT_FAILURE);
+            }
+            n += !ref[x];
+            ref[x] = r | 1U;
+        }
+        else
+        {
+            if (kh_u64_del(&kh, x) != (ref[x] ? 0 : -1))
+            {
+                fprintf(stderr, "Bug in kh_u64_del!\n");
+                exit(EXIT_FAILURE);
+            }
+            n -= !!ref[x];
+            ref[x] = 0U;
+        }
+        if (kh_u64_size(&kh) != n)
+        {
+            fprintf(stderr, "Bug in kh_u64_size!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (uint64_t x = 0U; x != u; ++x)
+    {
+        uint64_t *v = kh_u64_get(&kh, x);
+        if (ref[x] ? !v || *v != ref[x] : v != NULL)
+        {
+            fprintf(stderr, "Bug in kh_u64_get!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    size_t c = 0U;
+    for (size_t i = 0U; !kh_u64_next(&kh, &i); ++i)
+    {
+        c += ref[kh.k[i]] == kh.v[i];
+    }
+    kh_u64_rehash(&kh);
+    if (c != n || kh_u64_size(&kh) != n || kh_u64_get(&kh, u) != NULL)
+    {
+        fprintf(stderr, "Bug in kh_u64_next!\n");
+        exit(EXIT_FAILURE);
+    }
+    kh_u64_clear(&kh);
+    free(ref);
+}
+
+/* strings and a bad hash */
+void test2(void)
+{
+    const char *words[] = {"alpha", "beta", "gamma", "delta", "epsilon"};
+    khash_t(str) ks;
+    kh_str_init(&ks);
+    for (size_t i = 0U; i != 5U; ++i)
+    {
+        kh_str_set(&ks, words[i], i);
+    }
+    char buf[8] = "gamma";
+    size_t *v = kh_str_get(&ks, buf);
+    if (!v || *v != 2U || kh_str_get(&ks, "zeta") || kh_str_set(&ks, buf, 9U))
+    {
+        fprintf(stderr, "Bug in kh_str_get!\n");
+        exit(EXIT_FAILURE);
+    }
+    kh_str_clear(&ks);
+
+    khash_t(bad) kb;
+    kh_bad_init(&kb);
+    kh_bad_reserve(&kb, 100U);
+    size_t m = kb.m;
+    for (uint64_t x = 0U; x != 10000U; ++x)
+    {
+        kh_bad_set(&kb, x, x);
+        if (x < 100U && kb.m != m)
+        {
+            fprintf(stderr, "Bug in kh_bad_reserve!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (uint64_t x = 0U; x != 10000U; x += 2U)
+    {
+        kh_bad_del(&kb, x);
+    }
+    for (uint64_t x = 0U; x != 10000U; ++x)
+    {
+        uint64_t *p = kh_bad_get(&kb, x);
+        if ((x & 1U) ? !p || *p != x : p != NULL)
+        {
+            fprintf(stderr, "Bug in kh_bad_get!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    kh_bad_clear(&kb);
+}
+
+/* compare with binary search on a sorted array */
+void test3(size_t n)
+{
+    uint64_t s = 88172645463325252U;
+    uint64_t *p = (uint64_t *)malloc(sizeof(uint64_t) * n);
+    for (size_t i = 0U; i != n; ++i)
+    {
+        p[i] = rnd(&s);
+    }
+    khash_t(u64) kh;
+    kh_u64_init(&kh);
+
+    double t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kh_u64_set(&kh, p[i], i);
+    }
+    printf("khash set %zu: %.3f sec\n", n, now() - t);
+
+    uint64_t *q = (uint64_t *)malloc(sizeof(uint64_t) * n);
+    (void)memcpy(q, p, sizeof(uint64_t) * n);
+    t = now();
+    ksort_intro(uint64_t, q, n, LT);
+    printf("sort      %zu: %.3f sec\n", n, now() - t);
+
+    s = 2463534242U;
+    size_t a = 0U, b = 0U;
+    t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        uint64_t x = (i & 1U) ? p[rnd(&s) % n] : rnd(&s);
+        a += kh_u64_get(&kh, x) != NULL;
+    }
+    printf("khash get %zu: %.3f sec\n", n, now() - t);
+
+    s = 2463534242U;
+    t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        uint64_t x = (i & 1U) ? p[rnd(&s) % n] : rnd(&s);
+        size_t lo = 0U, len = n;
+        while (len > 1U)
+        {
+            size_t h = len >> 1;
+            lo += q[lo + h] <= x ? h : 0U;
+            len -= h;
+        }
+        b += q[lo] == x;
+    }
+    printf("bsearch   %zu: %.3f sec\n", n, now() - t);
+    if (a != b)
+    {
+        fprintf(stderr, "Bug in kh_u64_get!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kh_u64_clear(&kh);
+    free(p);
+    free(q);
+}
+
+int main(void)
+{
+    test1();
+    test2();
+    test3(1000000U);
+    test3(4000000U);
+    return 0;
+}
+
+/* END OF FILE */
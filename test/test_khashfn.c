@@ -0,0 +1,238 @@
+/*!
+ @file           test_khashfn.c
+ @brief          test fast non-cryptographic hash functions
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+/* the library is built here to reach the lanes of each path */
+#include "khashfn.c"
+#include "khash.h"
+#include "ksort.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define LT(a, b) ((a) < (b))
+
+/* FNV-1a of n bytes, as the ad-hoc loops over ks->s */
+static uint64_t fnv1a(const void *p, size_t n)
+{
+    const uint8_t *s = (const uint8_t *)p;
+    uint64_t h = 0xCBF29CE484222325U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        h ^= s[i];
+        h *= 0x100000001B3U;
+    }
+    return h;
+}
+
+/* every length through the short, middle and long paths */
+void test1(void)
+{
+    const size_t u = 2U * KHF_LONG + 100U;
+    uint8_t *b = (uint8_t *)malloc(u + 1U);
+    uint8_t *c = (uint8_t *)malloc(u + 1U);
+    uint64_t s = 1U;
+    for (size_t i = 0U; i != u + 1U; ++i)
+    {
+        b[i] = (uint8_t)rnd(&s);
+    }
+    if (khf_hash(NULL, 0U, 0U) != khf_hash(b, 0U, 0U))
+    {
+        fail("empty input");
+    }
+    double flips = 0, tests = 0;
+    for (size_t n = 0U; n <= u; ++n)
+    {
+        uint64_t h = khf_hash(b, n, 0U);
+        /* the same bytes at another alignment */
+        (void)memcpy(c + 1, b, n);
+        if (khf_hash(c + 1, n, 0U) != h)
+        {
+            fail("alignment");
+        }
+        if (n && khf_hash(b, n, 1U) == h)
+        {
+            fail("seed");
+        }
+        if (n && khf_hash(b, n - 1U, 0U) == h)
+        {
+            fail("length");
+        }
+        /* flip each bit, about half bits of hash should be changed */
+        for (size_t i = 0U; i < n * 8U; i += n < 64U ? 1U : 61U)
+        {
+            b[i >> 3] ^= (uint8_t)(1U << (i & 7U));
+            uint64_t x = khf_hash(b, n, 0U) ^ h;
+            b[i >> 3] ^= (uint8_t)(1U << (i & 7U));
+            if (x == 0U)
+            {
+                fail("bit flip");
+            }
+            flips += kpopcount64(x);
+            ++tests;
+        }
+    }
+    flips /= tests;
+    printf("avalanche: %.2f of 64 bits changed\n", flips);
+    if (flips < 31 || flips > 33)
+    {
+        fail("avalanche");
+    }
+    free(b);
+    free(c);
+}
+
+/* no collision of similar short keys */
+void test2(size_t n)
+{
+    uint64_t *h = (uint64_t *)malloc(n * sizeof(uint64_t));
+    char str[32];
+    kstring_t *ks = ks_init();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        int l = sprintf(str, "key%zu", i);
+        h[i] = khf_str(str);
+        ks->l = 0U;
+        (void)kputsn(ks, str, (size_t)l);
+        if (ks_hash(ks) != h[i] || khf_hash(str, (size_t)l, 0U) != h[i])
+        {
+            fail("ks_hash");
+        }
+    }
+    ksort_intro(uint64_t, h, n, LT);
+    for (size_t i = 1U; i < n; ++i)
+    {
+        if (h[i - 1U] == h[i])
+        {
+            fail("collision");
+        }
+    }
+    for (uint32_t i = 1U; i != 1000U; ++i)
+    {
+        if (khf_u32(i) == khf_u32(i - 1U) || khf_u64(i) == khf_u64(i - 1U))
+        {
+            fail("integer hash");
+        }
+    }
+    ks_free(ks);
+    free(h);
+}
+
+/* the lanes of each path give the same, lengths around the blocks */
+void test4(void)
+{
+    const size_t u = 3U * KHF_LONG + 100U;
+    uint8_t *b = (uint8_t *)malloc(u);
+    uint64_t s = 2U;
+    for (size_t i = 0U; i != u; ++i)
+    {
+        b[i] = (uint8_t)rnd(&s);
+    }
+    uint64_t k[16];
+    for (unsigned int i = 0U; i != 16U; ++i)
+    {
+        k[i] = khf_k[i] + rnd(&s);
+    }
+    for (size_t n = KHF_STRIPE; n <= u; ++n)
+    {
+        uint64_t a[8], c[8];
+        for (unsigned int i = 0U; i != 8U; ++i)
+        {
+            a[i] = c[i] = khf_k[i] ^ k[i];
+        }
+        khf_lanes_c(a, b, n, k);
+#if defined KHF_SSE2
+        khf_lanes_sse2(c, b, n, k);
+        if (memcmp(a, c, sizeof(a)))
+        {
+            fail("khf_lanes_sse2");
+        }
+#endif /* KHF_SSE2 */
+#if defined KHF_AVX2
+        if (__builtin_cpu_supports("avx2"))
+        {
+            for (unsigned int i = 0U; i != 8U; ++i)
+            {
+                c[i] = khf_k[i] ^ k[i];
+            }
+            khf_lanes_avx2(c, b, n, k);
+            if (memcmp(a, c, sizeof(a)))
+            {
+                fail("khf_lanes_avx2");
+            }
+        }
+#endif /* KHF_AVX2 */
+    }
+    free(b);
+}
+
+/* throughput against FNV-1a */
+void test3(size_t len)
+{
+    size_t m = len < 64U ? 64U : len;
+    size_t r = ((size_t)1 << 28) / m;
+    uint8_t *b = (uint8_t *)malloc(m + r);
+    uint64_t s = 3U;
+    for (size_t i = 0U; i != m + r; ++i)
+    {
+        b[i] = (uint8_t)rnd(&s);
+    }
+    uint64_t x = 0U;
+    double t = now();
+    for (size_t i = 0U; i != r; ++i)
+    {
+        x += khf_hash(b + (i & 63U), len, 0U);
+    }
+    double t1 = now() - t;
+    t = now();
+    for (size_t i = 0U; i != r; ++i)
+    {
+        x += fnv1a(b + (i & 63U), len);
+    }
+    double t2 = now() - t;
+    double g = (double)len * (double)r / 1e9;
+    printf("%8zu bytes: khf_hash %6.2f GB/s, fnv1a %5.2f GB/s %c\n",
+           len, g / t1, g / t2, (int)(x & 1U) + '0');
+    free(b);
+}
+
+int main(void)
+{
+    test1();
+    test2(1000000U);
+    test4();
+    test3(8U);
+    test3(16U);
+    test3(64U);
+    test3(KHF_LONG - 1U);
+    test3(KHF_LONG);
+    test3(4096U);
+    test3(1U << 20);
+    return 0;
+}
+
+/* END OF FILE */
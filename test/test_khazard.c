@@ -0,0 +1,386 @@
+/*!
+ @file           test_khazard.c
+ @brief          test hazard pointers
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kebr.h"
+#include "khazard.h"
+#include "klist.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define LIVE 0x1DEA5EEDU
+#define DEAD 0xDEADBEEFU
+
+/* node of Michael-Scott queue, the retired link is the first member */
+typedef struct node_t
+{
+    khazard_node_t r;
+    kebr_node_t e;
+    struct node_t *next;
+    uint64_t x;
+    unsigned int magic;
+} node_t;
+
+kmempool_type(node, node_t);
+
+typedef struct
+{
+    node_t *head;
+    char pad[64];
+    node_t *tail;
+} queue_t;
+
+typedef struct
+{
+    kmp_node_t kmp;
+    size_t retired;
+    size_t freed;
+    khazard_t *d;
+    queue_t *q;
+    uint64_t sum;
+    size_t ops;
+    size_t nt;
+    unsigned int id;
+} ctx_t;
+
+klist_init(u64, uint64_t, (void))
+
+static node_t *node_new(ctx_t *c, uint64_t x)
+{
+    node_t *p = kmp_alloc(node_t, c->kmp);
+    p->next = NULL;
+    p->x = x;
+    p->magic = LIVE;
+    return p;
+}
+
+/* the node goes back to the pool of the thread that frees it */
+static void node_del(ctx_t *c, node_t *p)
+{
+    if (p->magic != LIVE)
+    {
+        fail("double free");
+    }
+    p->magic = DEAD;
+    ++c->freed;
+    (void)kmp_free(node_t, c->kmp, p);
+}
+
+static void node_free(void *arg, khazard_node_t *r)
+{
+    node_del((ctx_t *)arg, (node_t *)(void *)r);
+}
+
+static void node_free_ebr(void *arg, kebr_node_t *r)
+{
+    node_del((ctx_t *)arg, kebr_entry(r, node_t, e));
+}
+
+static void queue_init(queue_t *q, ctx_t *c)
+{
+    q->head = q->tail = node_new(c, 0U);
+}
+
+static void queue_push(queue_t *q, khazard_thread_t *t, ctx_t *c, uint64_t x)
+{
+    node_t *p = node_new(c, x);
+    for (;;)
+    {
+        node_t *tail = (node_t *)khazard_protect(t, 0U, (void *const *)&q->tail);
+        node_t *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+        if (tail != __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE))
+        {
+            continue;
+        }
+        if (next)
+        {
+            (void)__atomic_compare_exchange_n(&q->tail, &tail, next, 0,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&tail->next, &next, p, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+            (void)__atomic_compare_exchange_n(&q->tail, &tail, p, 0,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    khazard_reset(t, 0U);
+}
+
+static int queue_shift(queue_t *q, khazard_thread_t *t, ctx_t *c, uint64_t *x)
+{
+    for (;;)
+    {
+        node_t *head = (node_t *)khazard_protect(t, 0U, (void *const *)&q->head);
+        node_t *tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+        node_t *next = (node_t *)khazard_protect(t, 1U, (void *const *)&head->next);
+        if (head != __atomic_load_n(&q->head, __ATOMIC_ACQUIRE))
+        {
+            continue;
+        }
+        if (!next)
+        {
+            khazard_reset(t, 0U);
+            khazard_reset(t, 1U);
+            return -1;
+        }
+        if (head == tail)
+        {
+            (void)__atomic_compare_exchange_n(&q->tail, &tail, next, 0,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+            continue;
+        }
+        *x = next->x;
+        if (next->magic != LIVE)
+        {
+            fail("use after free");
+        }
+        if (__atomic_compare_exchange_n(&q->head, &head, next, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            khazard_reset(t, 0U);
+            khazard_reset(t, 1U);
+            khazard_retire(t, &head->r);
+            ++c->retired;
+            return 0;
+        }
+    }
+}
+
+/* a stalled reader keeps its slot only, an epoch keeps everything */
+void test1(void)
+{
+    ctx_t c;
+    memset(&c, 0, sizeof(c));
+    kmp_init(c.kmp);
+    khazard_t d;
+    khazard_init(&d);
+    khazard_thread_t *a = khazard_join(&d, node_free, &c);
+    khazard_thread_t *b = khazard_join(&d, node_free, &c);
+    if (!a || !b || a == b || (uintptr_t)a % KHAZARD_LINE)
+    {
+        fail("join");
+    }
+    queue_t q;
+    queue_init(&q, &c);
+    queue_push(&q, b, &c, 1U);
+    node_t *x = (node_t *)khazard_protect(a, 0U, (void *const *)&q.head);
+    size_t most = 0U;
+    for (uint64_t i = 0U; i != 100000U; ++i)
+    {
+        uint64_t y = 0U;
+        queue_push(&q, b, &c, i);
+        if (queue_shift(&q, b, &c, &y))
+        {
+            fail("shift");
+        }
+        most = b->n > most ? b->n : most;
+    }
+    if (x->magic != LIVE || most >= KHAZARD_BATCH + 1U)
+    {
+        fail("bounded garbage");
+    }
+    printf("khazard: %zu retired nodes at most with a stalled reader\n", most);
+
+    /* the nodes of a record that is left are freed by others */
+    khazard_reset(a, 0U);
+    khazard_leave(b);
+    if (khazard_scan(a) || x->magic != DEAD || c.retired != c.freed)
+    {
+        fail("scan");
+    }
+    khazard_leave(a);
+    khazard_clear(&d);
+
+    kebr_t e;
+    kebr_init(&e);
+    kebr_thread_t *s = kebr_join(&e, node_free_ebr, &c);
+    kebr_thread_t *t = kebr_join(&e, node_free_ebr, &c);
+    kebr_enter(s);
+    size_t freed = c.freed;
+    for (uint64_t i = 0U; i != 100000U; ++i)
+    {
+        kebr_retire(t, &node_new(&c, i)->e);
+    }
+    printf("kebr   : %zu retired nodes with a stalled reader\n", 100000U - (c.freed - freed));
+    kebr_exit(s);
+    kebr_leave(s);
+    kebr_leave(t);
+    kebr_clear(&e);
+
+    node_del(&c, q.head->next);
+    node_del(&c, q.head);
+    kmp_clear((void), c.kmp);
+}
+
+static void *task(void *arg)
+{
+    ctx_t *c = (ctx_t *)arg;
+    khazard_thread_t *t = khazard_join(c->d, node_free, c);
+    uint64_t last[16] = {0};
+    for (size_t i = 1U; i <= c->ops; ++i)
+    {
+        uint64_t x = 0U;
+        queue_push(c->q, t, c, (uint64_t)c->id << 32 | i);
+        if (queue_shift(c->q, t, c, &x))
+        {
+            fail("shift");
+        }
+        /* the values of a thread are in order */
+        uint64_t *l = last + (x >> 32);
+        if ((x & 0xFFFFFFFFU) <= *l)
+        {
+            fail("order");
+        }
+        *l = x & 0xFFFFFFFFU;
+        c->sum += x;
+        if (t->n >= KHAZARD_SLOT * c->nt + KHAZARD_BATCH)
+        {
+            fail("bounded garbage");
+        }
+    }
+    khazard_leave(t);
+    return NULL;
+}
+
+void test2(unsigned int nt, size_t ops)
+{
+    khazard_t d;
+    queue_t q;
+    pthread_t tid[16];
+    ctx_t c[16];
+    khazard_init(&d);
+    uint64_t sum = 0U;
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        memset(c + i, 0, sizeof(*c));
+        kmp_init(c[i].kmp);
+        c[i].d = &d;
+        c[i].q = &q;
+        c[i].ops = ops;
+        c[i].nt = nt;
+        c[i].id = i;
+        sum += ((uint64_t)i << 32) * ops + ops * (ops + 1U) / 2U;
+    }
+    queue_init(&q, c);
+    double s = now();
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_create(tid + i, NULL, task, c + i);
+    }
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_join(tid[i], NULL);
+        sum -= c[i].sum;
+    }
+    s = now() - s;
+    khazard_clear(&d);
+    size_t n = 0U;
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        n += c[i].retired - c[i].freed;
+    }
+    if (sum || n || q.head->next)
+    {
+        fail("queue");
+    }
+    printf("%2u threads khazard queue: %.2f ns\n", nt, s * 1e9 / (double)(nt * ops));
+    node_del(c, q.head);
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        kmp_clear((void), c[i].kmp);
+    }
+}
+
+typedef struct
+{
+    pthread_mutex_t mtx;
+    klist_t(u64) kl;
+    size_t ops;
+} locked_t;
+
+static void *task3(void *arg)
+{
+    locked_t *l = (locked_t *)arg;
+    for (size_t i = 0U; i != l->ops; ++i)
+    {
+        uint64_t x = 0U;
+        pthread_mutex_lock(&l->mtx);
+        kl_push(u64, l->kl, i);
+        pthread_mutex_unlock(&l->mtx);
+        pthread_mutex_lock(&l->mtx);
+        if (kl_shift(u64, l->kl, x))
+        {
+            fail("klist");
+        }
+        pthread_mutex_unlock(&l->mtx);
+        (void)x;
+    }
+    return NULL;
+}
+
+/* a klist queue behind a mutex */
+void test3(unsigned int nt, size_t ops)
+{
+    pthread_t tid[16];
+    locked_t l;
+    pthread_mutex_init(&l.mtx, NULL);
+    kl_init(u64, l.kl);
+    l.ops = ops;
+    double s = now();
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_create(tid + i, NULL, task3, &l);
+    }
+    for (unsigned int i = 0U; i != nt; ++i)
+    {
+        (void)pthread_join(tid[i], NULL);
+    }
+    s = now() - s;
+    printf("%2u threads mutex klist  : %.2f ns\n", nt, s * 1e9 / (double)(nt * ops));
+    kl_clear(u64, (void), l.kl);
+    pthread_mutex_destroy(&l.mtx);
+}
+
+int main(void)
+{
+    test1();
+    for (unsigned int nt = 1U; nt <= 16U; nt <<= 1)
+    {
+        test2(nt, 1000000U / nt);
+        test3(nt, 1000000U / nt);
+    }
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,169 @@
+/*!
+ @file           test_kheap.c
+ @brief          test d-ary heap library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kheap.h"
+#include "kvec.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define LT(a, b) ((a) < (b))
+#define GT(a, b) ((a) > (b))
+
+kheap_init(max2, uint64_t, LT, 2)
+kheap_init(max4, uint64_t, LT, 4)
+kheap_init(min4, uint64_t, GT, 4)
+kvec_init(u64, uint64_t)
+
+#define TEST(NAME, CMP, n)                                              \
+    do                                                                  \
+    {                                                                   \
+        uint64_t s = 88172645463325252U;                                \
+        uint64_t *p = (uint64_t *)malloc(sizeof(uint64_t) * (n) + 1U);  \
+        for (size_t i = 0U; i != (n); ++i)                              \
+        {                                                               \
+            p[i] = rnd(&s) % 1000U;                                     \
+        }                                                               \
+        kheap_t(NAME) a, b;                                             \
+        khp_##NAME##_init(&a);                                          \
+        khp_##NAME##_init(&b);                                          \
+        double t = now();                                               \
+        for (size_t i = 0U; i != (n); ++i)                              \
+        {                                                               \
+            khp_##NAME##_push(&a, p[i]);                                \
+        }                                                               \
+        uint64_t x = 0U, y = 0U;                                        \
+        for (size_t i = 0U; i != (n); ++i)                              \
+        {                                                               \
+            uint64_t z = x;                                             \
+            if (khp_##NAME##_pop(&x, &a) || (i && CMP(z, x)))           \
+            {                                                           \
+                fprintf(stderr, "Bug in khp_" #NAME "_pop!\n");         \
+                exit(EXIT_FAILURE);                                     \
+            }                                                           \
+        }                                                               \
+        if ((n) > 1000U)                                                \
+        {                                                               \
+            printf("%-5s push and pop %zu: %.3f sec\n", #NAME,          \
+                   (size_t)(n), now() - t);                             \
+        }                                                               \
+        if (!khp_##NAME##_pop(&x, &a) || khp_##NAME##_top(&a))          \
+        {                                                               \
+            fprintf(stderr, "Bug in khp_" #NAME "_pop!\n");             \
+            exit(EXIT_FAILURE);                                         \
+        }                                                               \
+        /* heapify, then replace the top half of the times */           \
+        khp_##NAME##_heapify(&a, p, (n));                               \
+        khp_##NAME##_heapify(&b, p, (n));                               \
+        for (size_t i = 0U; i != (n); ++i)                              \
+        {                                                               \
+            if (i & 1U)                                                 \
+            {                                                           \
+                khp_##NAME##_replace_top(&x, &a, p[i] + 1U);            \
+                khp_##NAME##_pop(&y, &b);                               \
+                khp_##NAME##_push(&b, p[i] + 1U);                       \
+            }                                                           \
+            else                                                        \
+            {                                                           \
+                khp_##NAME##_pop(&x, &a);                               \
+                khp_##NAME##_pop(&y, &b);                               \
+            }                                                           \
+            if (x != y ||                                               \
+                khp_##NAME##_size(&a) != khp_##NAME##_size(&b))         \
+            {                                                           \
+                fprintf(stderr, "Bug in khp_" #NAME "_replace_top!\n"); \
+                exit(EXIT_FAILURE);                                     \
+            }                                                           \
+        }                                                               \
+        khp_##NAME##_clear(&a);                                         \
+        khp_##NAME##_clear(&b);                                         \
+        free(p);                                                        \
+    } while (0)
+
+/* a scheduler that sorts a vector again on every insert */
+void test2(size_t n)
+{
+    uint64_t s = 88172645463325252U;
+    kvec_t(u64) kv;
+    kv_u64_init(&kv);
+    kheap_t(min4) kh;
+    khp_min4_init(&kh);
+
+    double t = now();
+    uint64_t a = 0U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kv_u64_push(&kv, rnd(&s));
+        ksort_intro(uint64_t, kv.v, kv.n, GT);
+        if (i & 1U)
+        {
+            a += kv.v[--kv.n];
+        }
+    }
+    printf("sorted kvec %zu: %.3f sec\n", n, now() - t);
+
+    s = 88172645463325252U;
+    t = now();
+    uint64_t b = 0U, x = 0U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        khp_min4_push(&kh, rnd(&s));
+        if (i & 1U)
+        {
+            khp_min4_pop(&x, &kh);
+            b += x;
+        }
+    }
+    printf("kheap       %zu: %.3f sec\n", n, now() - t);
+    if (a != b)
+    {
+        fprintf(stderr, "Bug in khp_min4_pop!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kv_u64_clear(&kv);
+    khp_min4_clear(&kh);
+}
+
+int main(void)
+{
+    for (size_t n = 0U; n != 40U; ++n)
+    {
+        TEST(max2, LT, n);
+        TEST(max4, LT, n);
+        TEST(min4, GT, n);
+    }
+    TEST(max2, LT, 1000000U);
+    TEST(max4, LT, 1000000U);
+    TEST(min4, GT, 1000000U);
+    test2(5000U);
+    return 0;
+}
+
+/* END OF FILE */
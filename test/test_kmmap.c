@@ -0,0 +1,209 @@
+/*!
+ @file           test_kmmap.c
+ @brief          test file mapped vector library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+
+#include "kmmap.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define TEST_PATH "test_kmmap.bin"
+
+typedef struct record_t
+{
+    unsigned int id;
+    float x;
+    float y;
+    double t;
+} record_t;
+
+kvec_init(rec, record_t)
+kvec_mmap_init(rec, record_t)
+
+void test1(size_t n)
+{
+    kvec_mmap_t(rec) kv;
+
+    if (kv_rec_mmap_open(&kv, TEST_PATH, "w+"))
+    {
+        fprintf(stderr, "open %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    clock_t t = clock();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        record_t r = {(unsigned int)i, (float)i, -(float)i, (double)i / 2};
+        kv_rec_mmap_push(&kv, r);
+    }
+    kv_rec_mmap_sync(&kv);
+    printf("mmap push %zu: %.3f sec\n", n,
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    record_t r = {0U, 0.0F, 0.0F, 0.0};
+    kv_rec_mmap_pop(&r, &kv);
+    printf("pop %u, size = %zu, memory = %zu\n",
+           r.id, kv_size(kv), kv_max(kv));
+
+    kv_rec_mmap_close(&kv);
+
+    t = clock();
+    if (kv_rec_mmap_open(&kv, TEST_PATH, "r"))
+    {
+        fprintf(stderr, "open %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+    printf("mmap load %zu: %.3f sec\n", kv_size(kv),
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    if (kv_size(kv) != n - 1U)
+    {
+        fprintf(stderr, "Bug in kvec mmap size!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0U; i != kv_size(kv); ++i)
+    {
+        if (kv_v(kv, i).id != i || kv_v(kv, i).y != -(float)i)
+        {
+            fprintf(stderr, "Bug in kvec mmap data!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (kv_rec_mmap_push(&kv, r) == 0)
+    {
+        fprintf(stderr, "Bug in kvec mmap read only!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kv_rec_mmap_close(&kv);
+}
+
+void test2(size_t n)
+{
+    kvec_t(rec) kv;
+    kv_rec_init(&kv);
+    for (size_t i = 0U; i != n; ++i)
+    {
+        record_t r = {(unsigned int)i, (float)i, -(float)i, (double)i / 2};
+        kv_rec_push(&kv, r);
+    }
+
+    kvec_mmap_t(rec) mm;
+    if (kv_rec_mmap_open(&mm, TEST_PATH, "w+"))
+    {
+        fprintf(stderr, "open %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+    if (kv_rec_mmap_copy(&mm, &kv) || kv_size(mm) != n)
+    {
+        fprintf(stderr, "Bug in kvec mmap copy!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (kv_rec_mmap_resize(&mm, n / 2U) || kv_size(mm) != n / 2U)
+    {
+        fprintf(stderr, "Bug in kvec mmap resize!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (kv_rec_mmap_close(&mm))
+    {
+        fprintf(stderr, "close %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    if (kv_rec_mmap_open(&mm, TEST_PATH, "a+"))
+    {
+        fprintf(stderr, "open %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+    printf("resize: size = %zu, memory = %zu\n",
+           kv_size(mm), kv_max(mm));
+    if (kv_size(mm) != n / 2U)
+    {
+        fprintf(stderr, "Bug in kvec mmap size!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0U; i != kv_size(mm); ++i)
+    {
+        if (kv_v(mm, i).id != kv_v(kv, i).id)
+        {
+            fprintf(stderr, "Bug in kvec mmap copy!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (kv_rec_mmap_close(&mm))
+    {
+        fprintf(stderr, "close %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    /* fread and kv_push */
+    FILE *fp = fopen(TEST_PATH, "rb");
+    if (!fp)
+    {
+        fprintf(stderr, "open %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+    clock_t t = clock();
+    kvmm_head_t h;
+    if (fread(&h, sizeof(h), 1U, fp) != 1U || fseek(fp, KVMM_HEAD, SEEK_SET))
+    {
+        fprintf(stderr, "read %s failed!\n", TEST_PATH);
+        exit(EXIT_FAILURE);
+    }
+    kv_rec_clear(&kv);
+    for (size_t i = 0U; i != h.n; ++i)
+    {
+        record_t r;
+        if (fread(&r, sizeof(r), 1U, fp) != 1U)
+        {
+            break;
+        }
+        kv_rec_push(&kv, r);
+    }
+    printf("fread load %zu: %.3f sec\n", kv_size(kv),
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+    fclose(fp);
+    if (kv_size(kv) != n / 2U)
+    {
+        fprintf(stderr, "Bug in kvec mmap file!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kv_rec_clear(&kv);
+    remove(TEST_PATH);
+}
+
+int main(void)
+{
+    test1(1000000U); /* test push, sync and load */
+
+    test2(1000000U); /* test copy and resize */
+
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,167 @@
+/*!
+ @file           test_kpack.c
+ @brief          test bit packed integer vector library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kpack.h"
+#include "kvec.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+kvec_init(u32, uint32_t)
+kvec_packed_init(u32, uint32_t)
+
+void test1(int mode, unsigned int bits, size_t n)
+{
+    kvec_packed_t kp;
+    kvp_init(&kp, mode);
+    uint64_t s = 88172645463325252U;
+    uint64_t *a = (uint64_t *)malloc(sizeof(uint64_t) * (n + 1U));
+    uint64_t *b = (uint64_t *)malloc(sizeof(uint64_t) * (n + 1U));
+    for (size_t i = 0U; i != n; ++i)
+    {
+        uint64_t x = rnd(&s);
+        a[i] = bits < 64U ? x & ((UINT64_C(1) << bits) - 1U) : x;
+        /* large values that are close */
+        if (mode == KVP_FOR)
+        {
+            a[i] += UINT64_C(1) << 40;
+        }
+        kvp_push(&kp, a[i]);
+    }
+    for (size_t i = 0U; i != n; ++i)
+    {
+        uint64_t x = 0U;
+        if (kvp_v(&x, &kp, i) || x != a[i])
+        {
+            fprintf(stderr, "Bug in kvp_v!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (size_t i = 0U; i < n; i += 77U)
+    {
+        size_t c = n - i < 300U ? n - i : 300U;
+        if (kvp_decode(b, &kp, i, c) || memcmp(a + i, b, sizeof(uint64_t) * c))
+        {
+            fprintf(stderr, "Bug in kvp_decode!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    uint64_t x = 0U;
+    if (kvp_v(&x, &kp, n) == 0 || kvp_decode(b, &kp, n, 1U) == 0)
+    {
+        fprintf(stderr, "Bug in kvec_packed range!\n");
+        exit(EXIT_FAILURE);
+    }
+    kvp_free(&kp);
+    free(a);
+    free(b);
+}
+
+void test2(void)
+{
+    size_t N = 1U << 24;
+    unsigned int M = 20U;
+    uint64_t s = 88172645463325252U;
+
+    kvec_t(u32) kv, out;
+    kv_u32_init(&kv);
+    kv_u32_init(&out);
+    kv_u32_resize(&kv, N);
+    for (size_t i = 0U; i != N; ++i)
+    {
+        kv_push(uint32_t, kv, (uint32_t)(rnd(&s) & 0xFFFU));
+    }
+
+    kvec_packed_t kp;
+    kvp_init(&kp, KVP_BITS);
+    kv_u32_pack(&kp, &kv);
+    kvp_shrink(&kp);
+    printf("plain %zu bytes, packed %zu bytes, %.2fx\n",
+           sizeof(uint32_t) * N, kvp_bytes(&kp),
+           (double)(sizeof(uint32_t) * N) / (double)kvp_bytes(&kp));
+
+    clock_t t = clock();
+    uint64_t sum = 0U;
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        for (size_t i = 0U; i != kv.n; ++i)
+        {
+            sum += kv.v[i];
+        }
+    }
+    printf("plain scan: %.3f sec\n", (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    t = clock();
+    uint64_t sum2 = 0U;
+    uint32_t b[KVP_BLOCK];
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        for (size_t i = 0U; i != kvp_size(kp); i += KVP_BLOCK)
+        {
+            size_t c = kvp_size(kp) - i;
+            c = c < KVP_BLOCK ? c : KVP_BLOCK;
+            kvp_decode32(b, &kp, i, c);
+            for (size_t j = 0U; j != c; ++j)
+            {
+                sum2 += b[j];
+            }
+        }
+    }
+    printf("packed scan: %.3f sec\n", (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    kv_u32_unpack(&out, &kp);
+    if (sum != sum2 || out.n != kv.n ||
+        memcmp(out.v, kv.v, sizeof(uint32_t) * kv.n))
+    {
+        fprintf(stderr, "Bug in kvec_packed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kvp_free(&kp);
+    kv_u32_clear(&kv);
+    kv_u32_clear(&out);
+}
+
+int main(void)
+{
+    unsigned int bits[] = {0U, 1U, 3U, 12U, 31U, 33U, 63U, 64U};
+    for (size_t k = 0U; k != sizeof(bits) / sizeof(*bits); ++k)
+    {
+        test1(KVP_BITS, bits[k], 1000U);
+        test1(KVP_FOR, bits[k] < 40U ? bits[k] : 40U, 1000U);
+    }
+    test1(KVP_BITS, 12U, 0U);
+    test1(KVP_BITS, 12U, 128U);
+    test1(KVP_FOR, 7U, 100000U);
+
+    test2();
+
+    return 0;
+}
+
+/* END OF FILE */
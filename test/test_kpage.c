@@ -0,0 +1,153 @@
+/*!
+ @file           test_kpage.c
+ @brief          test paged sparse array library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kpage.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+kpage_init(u32, uint32_t, 12)
+kpage_init(u8, uint8_t, 4)
+
+void test1(void)
+{
+    kpage_t(u32) kp;
+    kpg_u32_init(&kp);
+
+    /* one write far away touches one page */
+    if (kpg_u32_set(&kp, 1000000000U, 7U) || kpg_u32_pages(&kp) != 1U ||
+        kpg_u32_size(&kp) != 1000000001U || kpg_u32_get(&kp, 1000000000U) != 7U ||
+        kpg_u32_get(&kp, 999999999U) != 0U || kpg_u32_get(&kp, 5U) != 0U ||
+        kpg_u32_ptr(&kp, 5U) != NULL)
+    {
+        fprintf(stderr, "Bug in kpg_u32_set!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("index 1e9: %zu bytes\n", kpg_u32_bytes(&kp));
+
+    size_t i = 0U;
+    if (kpg_u32_next(&kp, &i) || i != (1000000000U >> 12) << 12)
+    {
+        fprintf(stderr, "Bug in kpg_u32_next!\n");
+        exit(EXIT_FAILURE);
+    }
+    i = 1000000001U;
+    if (!kpg_u32_next(&kp, &i))
+    {
+        fprintf(stderr, "Bug in kpg_u32_next!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* the largest index does not depend on the size of page */
+    kpage_t(u8) kq;
+    kpg_u8_init(&kq);
+    size_t m = kpg_u32_max(&kp);
+    if (m != kpg_u8_max(&kq) || kpg_u8_set(&kq, 1000000000U, 7U) ||
+        kpg_u8_get(&kq, 1000000000U) != 7U || kpg_u8_at(&kq, m + 1U) != NULL ||
+        kpg_u8_pages(&kq) != 1U)
+    {
+        fprintf(stderr, "Bug in kpg_u8_max!\n");
+        exit(EXIT_FAILURE);
+    }
+    kpg_u8_clear(&kq);
+
+    /* the top is bounded, nothing is allocated above the largest index */
+    if ((KPAGE_MAX_BITS < sizeof(size_t) * 8U && m != ((size_t)1 << KPAGE_MAX_BITS) - 1U) ||
+        kpg_u32_at(&kp, m + 1U) != NULL || kpg_u32_at(&kp, (size_t)-1) != NULL ||
+        kpg_u32_set(&kp, m + 1U, 1U) != -1 || kpg_u32_pages(&kp) != 1U ||
+        kpg_u32_set(&kp, m, 9U) || kpg_u32_get(&kp, m) != 9U || kpg_u32_size(&kp) != m + 1U)
+    {
+        fprintf(stderr, "Bug in kpg_u32_at!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kpg_u32_clear(&kp);
+}
+
+void test2(void)
+{
+    const size_t n = 100000U;
+    const size_t u = (size_t)1 << 30;
+    uint64_t s = 88172645463325252U;
+    size_t *idx = (size_t *)malloc(sizeof(size_t) * n);
+    kpage_t(u32) kp;
+    kpg_u32_init(&kp);
+    for (size_t k = 0U; k != n; ++k)
+    {
+        /* clustered, a few pages hold most of the values */
+        uint64_t r = rnd(&s);
+        idx[k] = (size_t)(r % ((r & 63U) ? (u >> 10) : u));
+        kpg_u32_set(&kp, idx[k], (uint32_t)k + 1U);
+    }
+    for (size_t k = 0U; k != n; ++k)
+    {
+        uint32_t x = kpg_u32_get(&kp, idx[k]);
+        if (x == 0U || idx[x - 1U] != idx[k])
+        {
+            fprintf(stderr, "Bug in kpg_u32_get!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    /* each nonzero element is visited once in order */
+    size_t c = 0U, pages = 0U, last = (size_t)-1;
+    for (size_t i = 0U; !kpg_u32_next(&kp, &i); ++i)
+    {
+        if (i >> 12 != last)
+        {
+            last = i >> 12;
+            ++pages;
+        }
+        c += kpg_u32_get(&kp, i) != 0U;
+    }
+    size_t d = 0U;
+    for (size_t k = 0U; k != n; ++k)
+    {
+        d += kpg_u32_get(&kp, idx[k]) == (uint32_t)k + 1U;
+    }
+    if (c != d || pages != kpg_u32_pages(&kp))
+    {
+        fprintf(stderr, "Bug in kpg_u32_next!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("%zu values in [0, 2^30): %zu pages %zu bytes, dense %zu bytes\n",
+           n, kpg_u32_pages(&kp), kpg_u32_bytes(&kp),
+           sizeof(uint32_t) * kpg_u32_size(&kp));
+
+    kpg_u32_clear(&kp);
+    free(idx);
+}
+
+int main(void)
+{
+    test1();
+    test2();
+    return 0;
+}
+
+/* END OF FILE */
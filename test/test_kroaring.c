@@ -0,0 +1,435 @@
+/*!
+ @file           test_kroaring.c
+ @brief          test compressed bitmap library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/* the library is built here to make its reallocs fail */
+static int nomem = 0;
+static void *nomem_realloc(void *p, size_t n)
+{
+    return nomem ? NULL : realloc(p, n);
+}
+#define realloc nomem_realloc
+#include "kroaring.c"
+#undef realloc
+
+/* values are less than 2^24 */
+#define U     (1U << 24)
+#define WORDS (U >> 6)
+
+static void check(const kroaring_t *kr, const uint64_t *ref, const char *s)
+{
+    uint64_t n = 0U;
+    for (size_t i = 0U; i != WORDS; ++i)
+    {
+        n += kpopcount64(ref[i]);
+    }
+    kr_iter_t it = {0U, 0U, 0U};
+    uint32_t x, last = 0U;
+    uint64_t k = 0U;
+    while (kr_next(kr, &it, &x))
+    {
+        if (x >= U || !(ref[x >> 6] >> (x & 63U) & 1U) || (k && x <= last))
+        {
+            fprintf(stderr, "Bug in %s: kr_next!\n", s);
+            exit(EXIT_FAILURE);
+        }
+        last = x;
+        ++k;
+    }
+    if (k != n || kr_card(kr) != n)
+    {
+        fprintf(stderr, "Bug in %s: kr_card!\n", s);
+        exit(EXIT_FAILURE);
+    }
+    uint32_t *p = (uint32_t *)malloc(sizeof(uint32_t) * (n + 1U));
+    if (kr_to_array(p, kr) != n)
+    {
+        fprintf(stderr, "Bug in %s: kr_to_array!\n", s);
+        exit(EXIT_FAILURE);
+    }
+    it.c = 0U;
+    it.j = 0U;
+    it.r = 0U;
+    for (size_t i = 0U; kr_next(kr, &it, &x); ++i)
+    {
+        if (p[i] != x)
+        {
+            fprintf(stderr, "Bug in %s: kr_to_array!\n", s);
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(p);
+    for (uint32_t i = 0U; i < U; i += 97U)
+    {
+        if (kr_contains(kr, i) != (int)(ref[i >> 6] >> (i & 63U) & 1U))
+        {
+            fprintf(stderr, "Bug in %s: kr_contains!\n", s);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/* sparse values, dense blocks and long runs */
+static void fill(kroaring_t *kr, uint64_t *ref, uint64_t s)
+{
+    for (size_t i = 0U; i != 20000U; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % U);
+        kr_add(kr, x);
+        ref[x >> 6] |= UINT64_C(1) << (x & 63U);
+    }
+    for (size_t i = 0U; i != 8U; ++i)
+    {
+        uint32_t k = (uint32_t)(rnd(&s) % (U >> 16)) << 16;
+        for (size_t j = 0U; j != 30000U; ++j)
+        {
+            uint32_t x = k | (uint32_t)(rnd(&s) & 0xFFFFU);
+            kr_add(kr, x);
+            ref[x >> 6] |= UINT64_C(1) << (x & 63U);
+        }
+    }
+    for (size_t i = 0U; i != 16U; ++i)
+    {
+        uint32_t a = (uint32_t)(rnd(&s) % (U - 200000U));
+        uint32_t b = a + (uint32_t)(rnd(&s) % 200000U);
+        for (uint32_t x = a; x <= b; ++x)
+        {
+            kr_add(kr, x);
+            ref[x >> 6] |= UINT64_C(1) << (x & 63U);
+        }
+    }
+}
+
+void test1(void)
+{
+    kroaring_t kr;
+    kr_init(&kr);
+    uint64_t *ref = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    fill(&kr, ref, 88172645463325252U);
+    check(&kr, ref, "kr_add");
+
+    uint64_t s = 2463534242U;
+    for (size_t i = 0U; i != 400000U; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % U);
+        kr_remove(&kr, x);
+        ref[x >> 6] &= ~(UINT64_C(1) << (x & 63U));
+    }
+    check(&kr, ref, "kr_remove");
+
+    size_t bytes = kr_bytes(&kr);
+    kr_optimize(&kr);
+    check(&kr, ref, "kr_optimize");
+    if (kr_bytes(&kr) > bytes)
+    {
+        fprintf(stderr, "Bug in kr_optimize!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* change the runs */
+    for (size_t i = 0U; i != 100000U; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % U);
+        if (i & 1U)
+        {
+            kr_add(&kr, x);
+            ref[x >> 6] |= UINT64_C(1) << (x & 63U);
+        }
+        else
+        {
+            kr_remove(&kr, x);
+            ref[x >> 6] &= ~(UINT64_C(1) << (x & 63U));
+        }
+    }
+    check(&kr, ref, "kr_add and kr_remove of runs");
+
+    /* remove all */
+    uint32_t x;
+    kr_iter_t it = {0U, 0U, 0U};
+    kroaring_t cp;
+    kr_init(&cp);
+    kr_or(&cp, &kr, &cp);
+    while (kr_next(&cp, &it, &x))
+    {
+        kr_remove(&kr, x);
+    }
+    if (kr_card(&kr) || kr.c.n)
+    {
+        fprintf(stderr, "Bug in kr_remove!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kr_free(&cp);
+    kr_free(&kr);
+    free(ref);
+}
+
+void test2(void)
+{
+    uint64_t s = 88172645463325252U;
+    size_t n = 2000000U;
+    uint32_t *v = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    uint64_t *ref = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    for (size_t i = 0U; i != n; ++i)
+    {
+        /* skewed, some containers are full of values */
+        uint64_t r = rnd(&s);
+        v[i] = (uint32_t)(r % ((r & 1U) ? U : (U >> 6)));
+        ref[v[i] >> 6] |= UINT64_C(1) << (v[i] & 63U);
+    }
+    kroaring_t kr, ka;
+    kr_init(&kr);
+    kr_init(&ka);
+
+    double t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kr_add(&ka, v[i]);
+    }
+    printf("kr_add     : %.3f sec\n", now() - t);
+    t = now();
+    kr_add_many(&kr, v, n >> 1);
+    kr_add_many(&kr, v + (n >> 1), n - (n >> 1));
+    printf("kr_add_many: %.3f sec\n", now() - t);
+    check(&ka, ref, "kr_add");
+    check(&kr, ref, "kr_add_many");
+
+    kr_free(&ka);
+    kr_free(&kr);
+    free(ref);
+    free(v);
+}
+
+void test3(void)
+{
+    kroaring_t a, b, c;
+    kr_init(&a);
+    kr_init(&b);
+    kr_init(&c);
+    uint64_t *ra = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    uint64_t *rb = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    uint64_t *rc = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    fill(&a, ra, 88172645463325252U);
+    fill(&b, rb, 2463534242U);
+    /* the same containers of different types */
+    for (uint32_t x = 0U; x != 0x20000U; ++x)
+    {
+        if (x % 3U == 0U)
+        {
+            kr_add(&a, x);
+            ra[x >> 6] |= UINT64_C(1) << (x & 63U);
+        }
+        if (x % 29U == 0U)
+        {
+            kr_add(&b, x);
+            rb[x >> 6] |= UINT64_C(1) << (x & 63U);
+        }
+    }
+
+    for (int k = 0; k != 2; ++k)
+    {
+        kr_or(&c, &a, &b);
+        for (size_t i = 0U; i != WORDS; ++i)
+        {
+            rc[i] = ra[i] | rb[i];
+        }
+        check(&c, rc, "kr_or");
+        kr_and(&c, &a, &b);
+        for (size_t i = 0U; i != WORDS; ++i)
+        {
+            rc[i] = ra[i] & rb[i];
+        }
+        check(&c, rc, "kr_and");
+        kr_andnot(&c, &a, &b);
+        for (size_t i = 0U; i != WORDS; ++i)
+        {
+            rc[i] = ra[i] & ~rb[i];
+        }
+        check(&c, rc, "kr_andnot");
+        kr_andnot(&c, &b, &a);
+        for (size_t i = 0U; i != WORDS; ++i)
+        {
+            rc[i] = rb[i] & ~ra[i];
+        }
+        check(&c, rc, "kr_andnot");
+        /* the same again with runs */
+        kr_optimize(&a);
+        kr_optimize(&b);
+    }
+
+    /* dst is one of the operands */
+    kr_and(&a, &a, &b);
+    for (size_t i = 0U; i != WORDS; ++i)
+    {
+        ra[i] &= rb[i];
+    }
+    check(&a, ra, "kr_and");
+    kr_or(&b, &a, &b);
+    check(&b, rb, "kr_or");
+
+    kr_free(&a);
+    kr_free(&b);
+    kr_free(&c);
+    free(ra);
+    free(rb);
+    free(rc);
+}
+
+/* compare with a plain bitset and a sorted array */
+void test4(uint32_t d)
+{
+    uint64_t s = 88172645463325252U;
+    kroaring_t a, b, c;
+    kr_init(&a);
+    kr_init(&b);
+    kr_init(&c);
+    uint64_t *ra = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    uint64_t *rb = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    uint64_t *rc = (uint64_t *)calloc(WORDS, sizeof(uint64_t));
+    for (uint32_t x = 0U; x != U; ++x)
+    {
+        if (rnd(&s) % d == 0U)
+        {
+            kr_add(&a, x);
+            ra[x >> 6] |= UINT64_C(1) << (x & 63U);
+        }
+        if (rnd(&s) % d == 0U)
+        {
+            kr_add(&b, x);
+            rb[x >> 6] |= UINT64_C(1) << (x & 63U);
+        }
+    }
+    kr_optimize(&a);
+    kr_optimize(&b);
+    printf("1/%-6u kroaring %8zu bitset %8zu array %8zu bytes\n", d,
+           kr_bytes(&a), sizeof(uint64_t) * WORDS,
+           sizeof(uint32_t) * (size_t)kr_card(&a));
+
+    double t = now();
+    for (int i = 0; i != 10; ++i)
+    {
+        kr_and(&c, &a, &b);
+    }
+    double t1 = now() - t;
+    t = now();
+    for (int i = 0; i != 10; ++i)
+    {
+        for (size_t j = 0U; j != WORDS; ++j)
+        {
+            rc[j] = ra[j] & rb[j];
+        }
+    }
+    double t2 = now() - t;
+    printf("1/%-6u kr_and %.4f sec bitset %.4f sec\n", d, t1, t2);
+    check(&c, rc, "kr_and");
+
+    kr_free(&a);
+    kr_free(&b);
+    kr_free(&c);
+    free(ra);
+    free(rb);
+    free(rc);
+}
+
+/* true if kr has the values less than n and none of the others below m */
+static int same(const kroaring_t *kr, uint32_t n, uint32_t m)
+{
+    for (uint32_t x = 0U; x != m; ++x)
+    {
+        if (kr_contains(kr, x) != (x < n))
+        {
+            return 0;
+        }
+    }
+    return kr_card(kr) == n;
+}
+
+/* the set is left as it is if it has no memory */
+static void test5(void)
+{
+    uint32_t v[3000];
+    for (uint32_t i = 0U; i != 3000U; ++i)
+    {
+        v[i] = i;
+    }
+    kroaring_t kr;
+    kr_init(&kr);
+    /* the runs are changed to array */
+    if (kr_add_many(&kr, v, 1000U) || kr_optimize(&kr))
+    {
+        fprintf(stderr, "Bug in test5: kr_optimize!\n");
+        exit(EXIT_FAILURE);
+    }
+    nomem = 1;
+    int add = kr_add(&kr, 5000U);
+    int del = kr_remove(&kr, 10U);
+    nomem = 0;
+    if (add != -1 || del != -1 || !same(&kr, 1000U, 0x10000U))
+    {
+        fprintf(stderr, "Bug in test5: kr_add!\n");
+        exit(EXIT_FAILURE);
+    }
+    kr_free(&kr);
+    /* the words are changed to array */
+    if (kr_add_many(&kr, v, 3000U))
+    {
+        fprintf(stderr, "Bug in test5: kr_add_many!\n");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t w[1100];
+    for (uint32_t i = 0U; i != 1100U; ++i)
+    {
+        w[i] = i < 1000U ? i : i + 2000U;
+    }
+    nomem = 1;
+    add = kr_add_many(&kr, w, 1100U);
+    nomem = 0;
+    if (add != -1 || !same(&kr, 3000U, 0x10000U))
+    {
+        fprintf(stderr, "Bug in test5: kr_add_many!\n");
+        exit(EXIT_FAILURE);
+    }
+    kr_free(&kr);
+}
+
+int main(void)
+{
+    test1();
+    test2();
+    test3();
+    test4(2U);
+    test4(64U);
+    test4(10000U);
+    test5();
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,162 @@
+/*!
+ @file           test_ksearch.c
+ @brief          test search of sorted array
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "ksearch.h"
+#include "ksort.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LT(a, b) ((a) < (b))
+
+/* branchy binary search */
+static size_t lower1(const uint32_t *p, size_t n, uint32_t x)
+{
+    size_t lo = 0U, hi = n;
+    while (lo < hi)
+    {
+        size_t mid = lo + ((hi - lo) >> 1);
+        if (p[mid] < x)
+        {
+            lo = mid + 1U;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static size_t lower2(const uint32_t *p, size_t n, uint32_t x)
+{
+    size_t r;
+    ksearch_lower(uint32_t, r, p, n, x, LT);
+    return r;
+}
+
+static size_t lower3(const uint32_t *e, size_t n, uint32_t x)
+{
+    size_t r;
+    ksearch_eytzinger_lower(uint32_t, r, e, n, x, LT);
+    return r;
+}
+
+/* all the lengths of small arrays with duplicates */
+void test1(void)
+{
+    uint32_t p[300], e[301];
+    uint64_t s = 1U;
+    for (size_t n = 0U; n != 300U; ++n)
+    {
+        for (size_t i = 0U; i != n; ++i)
+        {
+            p[i] = (uint32_t)(rnd(&s) % 200U) * 2U;
+        }
+        ksort_intro(uint32_t, p, n, LT);
+        ksearch_eytzinger_build(uint32_t, e, p, n);
+        for (uint32_t x = 0U; x != 402U; ++x)
+        {
+            size_t i = lower1(p, n, x);
+            size_t k = lower3(e, n, x);
+            if (lower2(p, n, x) != i)
+            {
+                fail("lower bound");
+            }
+            if (i == n ? k != 0U : k == 0U || e[k] != p[i])
+            {
+                fail("eytzinger lower bound");
+            }
+        }
+    }
+}
+
+void test2(size_t n, size_t q)
+{
+    uint32_t *p = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    uint32_t *e = NULL;
+    if (posix_memalign((void **)&e, 64U, sizeof(uint32_t) * (n + 1U)))
+    {
+        fail("memory");
+    }
+    /* odd values, about half of queries are found */
+    for (size_t i = 0U; i != n; ++i)
+    {
+        p[i] = (uint32_t)(i << 1 | 1U);
+    }
+    double t = now();
+    ksearch_eytzinger_build(uint32_t, e, p, n);
+    double tb = now() - t;
+
+    uint32_t m = (uint32_t)(n << 1);
+    uint64_t s = 7U;
+    size_t c1 = 0U, c2 = 0U, c3 = 0U;
+    t = now();
+    for (size_t i = 0U; i != q; ++i)
+    {
+        c1 += lower1(p, n, (uint32_t)(rnd(&s) % m));
+    }
+    double t1 = now() - t;
+    s = 7U;
+    t = now();
+    for (size_t i = 0U; i != q; ++i)
+    {
+        c2 += lower2(p, n, (uint32_t)(rnd(&s) % m));
+    }
+    double t2 = now() - t;
+    s = 7U;
+    t = now();
+    for (size_t i = 0U; i != q; ++i)
+    {
+        size_t k = lower3(e, n, (uint32_t)(rnd(&s) % m));
+        c3 += k ? e[k] >> 1 : n;
+    }
+    double t3 = now() - t;
+    if (c1 != c2 || c1 != c3)
+    {
+        fail("search");
+    }
+    printf("%10zu: branchy %5.0f ns, branchless %5.0f ns, eytzinger %5.0f ns, build %.3f sec\n",
+           n, t1 * 1e9 / (double)q, t2 * 1e9 / (double)q, t3 * 1e9 / (double)q, tb);
+    free(p);
+    free(e);
+}
+
+int main(void)
+{
+    test1();
+    for (size_t n = 10000U; n <= 100000000U; n *= 10U)
+    {
+        test2(n, 2000000U);
+    }
+    return 0;
+}
+
+/* END OF FILE */
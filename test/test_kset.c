@@ -0,0 +1,208 @@
+/*!
+ @file           test_kset.c
+ @brief          test Robin Hood hash set library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kset.h"
+#include "khash.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+kset_init(u64, uint64_t, kh_hash_u64)
+khash_init(u64, uint64_t, uint8_t, kh_hash_u64, kh_eq)
+
+/* a bad hash, the keys of x << 9 are crowded in few slots */
+#define hash_bad(x) ((size_t)(x))
+kset_init(bad, uint64_t, hash_bad)
+
+/* random add and del against a direct array */
+void test1(void)
+{
+    const size_t u = 1U << 16;
+    uint8_t *ref = (uint8_t *)calloc(u, 1U);
+    uint64_t s = 88172645463325252U;
+    kset_t(u64) ks;
+    kset_u64_init(&ks);
+    size_t n = 0U;
+    for (size_t k = 0U; k != 2000000U; ++k)
+    {
+        uint64_t r = rnd(&s);
+        uint64_t x = (r >> 8) % ((k >> 18) & 1U ? u >> 4 : u);
+        if (r & 1U)
+        {
+            if (kset_u64_add(&ks, x) != !ref[x])
+            {
+                fprintf(stderr, "Bug in kset_u64_add!\n");
+                exit(EXIT_FAILURE);
+            }
+            n += !ref[x];
+            ref[x] = 1U;
+        }
+        else
+        {
+            if (kset_u64_del(&ks, x) != (ref[x] ? 0 : -1))
+            {
+                fprintf(stderr, "Bug in kset_u64_del!\n");
+                exit(EXIT_FAILURE);
+            }
+            n -= ref[x];
+            ref[x] = 0U;
+        }
+        if (kset_u64_size(&ks) != n || ks.n * 10U > ks.m * 9U)
+        {
+            fprintf(stderr, "Bug in kset_u64_size!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (uint64_t x = 0U; x != u; ++x)
+    {
+        if (kset_u64_contains(&ks, x) != ref[x])
+        {
+            fprintf(stderr, "Bug in kset_u64_contains!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    size_t c = 0U;
+    for (size_t i = 0U; !kset_u64_next(&ks, &i); ++i)
+    {
+        c += ref[ks.k[i]];
+    }
+    if (c != n)
+    {
+        fprintf(stderr, "Bug in kset_u64_next!\n");
+        exit(EXIT_FAILURE);
+    }
+    kset_u64_clear(&ks);
+
+    /* long probes make the table grow */
+    kset_t(bad) kb;
+    kset_bad_init(&kb);
+    for (uint64_t x = 0U; x != 100000U; ++x)
+    {
+        if (kset_bad_add(&kb, x << 9) != 1)
+        {
+            fprintf(stderr, "Bug in kset_bad_add!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (uint64_t x = 0U; x < 100000U << 9; x += 97U)
+    {
+        if (kset_bad_contains(&kb, x) != ((x & 511U) == 0U))
+        {
+            fprintf(stderr, "Bug in kset_bad_add!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    kset_bad_clear(&kb);
+    free(ref);
+}
+
+/* deduplication of n ids, about half of them are repeated */
+void test2(size_t n)
+{
+    uint64_t s = 88172645463325252U;
+    uint64_t *p = (uint64_t *)malloc(sizeof(uint64_t) * n);
+    uint8_t *out = (uint8_t *)malloc(n);
+    for (size_t i = 0U; i != n; ++i)
+    {
+        p[i] = rnd(&s) % n;
+    }
+
+    kset_t(u64) ks;
+    kset_u64_init(&ks);
+    double t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kset_u64_add(&ks, p[i]);
+    }
+    printf("kset add      %zu: %.3f sec\n", n, now() - t);
+    size_t c = ks.n;
+    kset_u64_clear(&ks);
+
+    t = now();
+    kset_u64_add_many(&ks, p, n);
+    printf("kset add_many %zu: %.3f sec\n", n, now() - t);
+
+    khash_t(u64) kh;
+    kh_u64_init(&kh);
+    t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kh_u64_set(&kh, p[i], 1U);
+    }
+    printf("khash set     %zu: %.3f sec\n", n, now() - t);
+    if (c != ks.n || c != kh.n)
+    {
+        fprintf(stderr, "Bug in kset_u64_add_many!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0U; i != n; ++i)
+    {
+        p[i] = rnd(&s) % (n << 1);
+    }
+    t = now();
+    size_t a = 0U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        a += (size_t)kset_u64_contains(&ks, p[i]);
+    }
+    printf("kset contains %zu: %.3f sec\n", n, now() - t);
+    t = now();
+    size_t b = kset_u64_contains_many(&ks, p, n, out);
+    printf("contains_many %zu: %.3f sec\n", n, now() - t);
+    if (a != b)
+    {
+        fprintf(stderr, "Bug in kset_u64_contains_many!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int dmax = 0U;
+    for (size_t i = 0U; i != ks.m; ++i)
+    {
+        dmax = ks.d[i] > dmax ? ks.d[i] : dmax;
+    }
+    printf("kset  %zu keys: load %.2f, longest probe %u, %zu bytes\n", ks.n,
+           (double)ks.n / (double)ks.m, dmax, (sizeof(uint64_t) + 1U) * ks.m);
+    printf("khash %zu keys: load %.2f, %zu bytes\n", kh.n,
+           (double)kh.n / (double)kh.m, (sizeof(uint64_t) + 2U) * kh.m);
+
+    kset_u64_clear(&ks);
+    kh_u64_clear(&kh);
+    free(p);
+    free(out);
+}
+
+int main(void)
+{
+    test1();
+    test2(1000000U);
+    test2(7000000U);
+    return 0;
+}
+
+/* END OF FILE */
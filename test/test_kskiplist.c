@@ -0,0 +1,303 @@
+/*!
+ @file           test_kskiplist.c
+ @brief          test skip list of ordered map
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#include "kskiplist.h"
+#include "kbtree.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define LT(a, b)     ((a) < (b))
+#define STR_LT(a, b) (strcmp(a, b) < 0)
+
+kskiplist_init(u32, uint32_t, uint32_t, LT)
+kskiplist_init(str, const char *, size_t, STR_LT)
+kbtree_init(u32, uint32_t, uint32_t, LT)
+
+/* each level is sorted, and a node of a level is in the level below */
+static void check(const kskiplist_t(u32) * kl)
+{
+    size_t n = 0U;
+    for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)
+    {
+        if (!kl->head[i] != (i >= kl->h))
+        {
+            fail("levels");
+        }
+        const kskiplist_n(u32) *b = kl->head[i ? i - 1U : 0U];
+        for (const kskiplist_n(u32) *p = kl->head[i]; p; p = p->next[i])
+        {
+            if (p->h <= i || (p->next[i] && !LT(p->k, p->next[i]->k)))
+            {
+                fail("order of level");
+            }
+            while (b != p)
+            {
+                b = b->next[i ? i - 1U : 0U];
+            }
+            n += i ? 0U : 1U;
+        }
+    }
+    if (n != kl->n)
+    {
+        fail("number of list");
+    }
+}
+
+/* random set, del, get and lower against a direct array */
+void test1(void)
+{
+    const size_t u = 1U << 14;
+    uint32_t *ref = (uint32_t *)calloc(u, sizeof(uint32_t));
+    kskiplist_t(u32) kl;
+    ksl_u32_init(&kl);
+    size_t n = 0U;
+    uint64_t s = 1U;
+    for (size_t i = 0U; i != 1000000U; ++i)
+    {
+        uint32_t x = (uint32_t)(rnd(&s) % u);
+        uint32_t r = (uint32_t)(rnd(&s) % 8U) + (i / 250000U & 1U ? 2U : 0U);
+        if (r < 5U)
+        {
+            uint32_t v = (uint32_t)i | 1U;
+            int absent = ksl_u32_set(&kl, x, v);
+            if (absent != !ref[x])
+            {
+                fail("set");
+            }
+            n += (size_t)absent;
+            ref[x] = v;
+        }
+        else if (r < 8U)
+        {
+            if (ksl_u32_del(&kl, x) != (ref[x] ? 0 : -1))
+            {
+                fail("del");
+            }
+            n -= ref[x] ? 1U : 0U;
+            ref[x] = 0U;
+        }
+        else if (i & 1U)
+        {
+            uint32_t *v = ksl_u32_get(&kl, x);
+            if (ref[x] ? !v || *v != ref[x] : v != NULL)
+            {
+                fail("get");
+            }
+        }
+        else
+        {
+            uint32_t y = x;
+            while (y != u && !ref[y])
+            {
+                ++y;
+            }
+            kskiplist_n(u32) *p = ksl_u32_lower(&kl, x);
+            if (p ? y == u || p->k != y || p->v != ref[y] : y != u)
+            {
+                fail("lower");
+            }
+        }
+        if (ksl_u32_size(&kl) != n)
+        {
+            fail("size");
+        }
+        if (i % 50000U == 0U)
+        {
+            check(&kl);
+        }
+    }
+    check(&kl);
+    /* a quarter of the nodes of a level are in the level above */
+    size_t c[3] = {0U, 0U, 0U};
+    for (unsigned int i = 0U; i != 3U; ++i)
+    {
+        for (kskiplist_n(u32) *p = kl.head[i]; p; p = p->next[i])
+        {
+            ++c[i];
+        }
+    }
+    printf("levels %u, nodes of level 0 1 2: %zu %zu %zu\n", kl.h, c[0], c[1], c[2]);
+    if (c[1] * 5U < c[0] || c[1] * 3U > c[0])
+    {
+        fail("height");
+    }
+    uint32_t x = 0U;
+    for (kskiplist_n(u32) *p = ksl_u32_begin(&kl); p; p = ksl_u32_next(p))
+    {
+        while (!ref[x])
+        {
+            ++x;
+        }
+        if (p->k != x || p->v != ref[x])
+        {
+            fail("order");
+        }
+        ++x;
+    }
+    while (x != u && !ref[x])
+    {
+        ++x;
+    }
+    if (x != u)
+    {
+        fail("iteration");
+    }
+    for (x = 0U; x != u; ++x)
+    {
+        if (ref[x] && ksl_u32_del(&kl, x))
+        {
+            fail("del all");
+        }
+    }
+    if (ksl_u32_size(&kl) || kl.h || kl.head[0])
+    {
+        fail("empty");
+    }
+    /* the nodes are in the pools, they are used again */
+    size_t m = 0U;
+    for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)
+    {
+        m += kl.kmp[i].n + kl.kmp[i].cnt;
+    }
+    (void)ksl_u32_set(&kl, 1U, 1U);
+    for (unsigned int i = 0U; i != KSKIPLIST_MAX; ++i)
+    {
+        m -= kl.kmp[i].n + kl.kmp[i].cnt;
+    }
+    if (m)
+    {
+        fail("memory pool");
+    }
+    ksl_u32_clear(&kl);
+    free(ref);
+}
+
+/* keys of c strings */
+void test2(void)
+{
+    static const char *const s[] = {"pear", "apple", "fig", "kiwi", "apple", "date"};
+    kskiplist_t(str) kl;
+    ksl_str_init(&kl);
+    for (size_t i = 0U; i != sizeof(s) / sizeof(*s); ++i)
+    {
+        int absent = 0;
+        size_t *v = ksl_str_put(&kl, s[i], &absent);
+        *v = absent ? 1U : *v + 1U;
+    }
+    for (kskiplist_n(str) *p = ksl_str_begin(&kl); p; p = ksl_str_next(p))
+    {
+        printf("%s:%zu ", p->k, p->v);
+    }
+    putchar('\n');
+    kskiplist_n(str) *p = ksl_str_lower(&kl, "e");
+    if (ksl_str_size(&kl) != 5U || *ksl_str_get(&kl, "apple") != 2U || !p || strcmp(p->k, "fig"))
+    {
+        fail("string keys");
+    }
+    ksl_str_clear(&kl);
+}
+
+/* a stream of orders near a moving price, the best one is taken often */
+void test3(size_t n)
+{
+    kskiplist_t(u32) kl;
+    kbtree_t(u32) kb;
+    ksl_u32_init(&kl);
+    kb_u32_init(&kb);
+    uint64_t s = 2U, sum = 0U;
+    uint32_t mid = 1U << 30;
+    double t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        uint64_t r = rnd(&s);
+        mid += (uint32_t)(r & 0xFFU) - 0x80U;
+        (void)ksl_u32_set(&kl, mid + (uint32_t)(r >> 40), (uint32_t)i);
+        if (r & 0x100U)
+        {
+            kskiplist_n(u32) *p = ksl_u32_begin(&kl);
+            sum += p->v;
+            (void)ksl_u32_del(&kl, p->k);
+        }
+    }
+    printf("kskiplist order book %zu: %.3f sec\n", n, now() - t);
+    s = 2U;
+    mid = 1U << 30;
+    t = now();
+    for (size_t i = 0U; i != n; ++i)
+    {
+        uint64_t r = rnd(&s);
+        mid += (uint32_t)(r & 0xFFU) - 0x80U;
+        (void)kb_u32_set(&kb, mid + (uint32_t)(r >> 40), (uint32_t)i);
+        if (r & 0x100U)
+        {
+            kbtree_i(u32) it;
+            (void)kb_u32_begin(&kb, &it);
+            sum -= kb_val(it);
+            (void)kb_u32_del(&kb, kb_key(it));
+        }
+    }
+    printf("kbtree order book    %zu: %.3f sec\n", n, now() - t);
+    if (sum || ksl_u32_size(&kl) != kb_u32_size(&kb))
+    {
+        fail("order book");
+    }
+
+    size_t c = 0U;
+    s = 3U;
+    t = now();
+    for (size_t i = 0U; i != 1000000U; ++i)
+    {
+        c += ksl_u32_get(&kl, (1U << 30) + (uint32_t)(rnd(&s) >> 40)) != NULL;
+    }
+    printf("kskiplist get: %.3f sec\n", now() - t);
+    s = 3U;
+    t = now();
+    for (size_t i = 0U; i != 1000000U; ++i)
+    {
+        c -= kb_u32_get(&kb, (1U << 30) + (uint32_t)(rnd(&s) >> 40)) != NULL;
+    }
+    printf("kbtree get   : %.3f sec\n", now() - t);
+    if (c)
+    {
+        fail("get");
+    }
+    ksl_u32_clear(&kl);
+    kb_u32_clear(&kb);
+}
+
+int main(void)
+{
+    test1();
+    test2();
+    test3(100000U);
+    test3(4000000U);
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,169 @@
+/*!
+ @file           test_ksoa.c
+ @brief          test structure of arrays vector library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+
+#include "ksoa.h"
+#include "kvec.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/* record with ten fields */
+typedef struct record_t
+{
+    unsigned int id;
+    unsigned int flag;
+    double price;
+    double volume;
+    double open;
+    double close;
+    double high;
+    double low;
+    long time;
+    long seq;
+} record_t;
+
+kvec_init(rec, record_t)
+
+kvec_soa_init(rec,
+              (unsigned int, id),
+              (unsigned int, flag),
+              (double, price),
+              (double, volume),
+              (double, open),
+              (double, close),
+              (double, high),
+              (double, low),
+              (long, time),
+              (long, seq))
+
+void test1(void)
+{
+    kvec_soa_t(rec) kv;
+
+    ksoa_rec_init(&kv);
+
+    for (unsigned int i = 0; i != 10; ++i)
+    {
+        kvec_soa_row_t(rec) r = {i, i & 1U, i * 0.5, 0, 0, 0, 0, 0, (long)i, -(long)i};
+        ksoa_rec_push(&kv, r);
+    }
+
+    kvec_soa_row_t(rec) r;
+    for (unsigned int i = 0; i != 3; ++i)
+    {
+        ksoa_rec_pop(&r, &kv);
+        printf("%u ", r.id);
+    }
+
+    ksoa_rec_v(&r, &kv, 2U);
+    r.price = 100.0;
+    ksoa_rec_set(&kv, 2U, r);
+
+    for (size_t i = 0; i != ksoa_size(kv); ++i)
+    {
+        printf("%g ", ksoa_v(kv, price, i));
+    }
+
+    kvec_soa_t(rec) kv2;
+    ksoa_rec_init(&kv2);
+    ksoa_rec_copy(&kv2, &kv);
+    ksoa_rec_resize(&kv2, 4U);
+
+    long *seq = ksoa_rec_seq(&kv2);
+    for (size_t i = 0; i != ksoa_rec_size(&kv2); ++i)
+    {
+        printf("%li ", seq[i]);
+    }
+
+    printf("\nmemory = %zu\n", ksoa_rec_max(&kv));
+
+    ksoa_rec_clear(&kv2);
+    ksoa_rec_clear(&kv);
+}
+
+void test2(size_t n)
+{
+    kvec_t(rec) aos;
+    kvec_soa_t(rec) soa;
+    kv_rec_init(&aos);
+    ksoa_rec_init(&soa);
+
+    for (size_t i = 0; i != n; ++i)
+    {
+        record_t r = {(unsigned int)i, 0, (double)i, 1.0, 0, 0, 0, 0, 0, 0};
+        kvec_soa_row_t(rec) s = {(unsigned int)i, 0, (double)i, 1.0, 0, 0, 0, 0, 0, 0};
+        kv_rec_push(&aos, r);
+        ksoa_rec_push(&soa, s);
+    }
+
+    clock_t t = clock();
+    double x = 0;
+    for (unsigned int k = 0; k != 10; ++k)
+    {
+        for (size_t i = 0; i != aos.n; ++i)
+        {
+            x += aos.v[i].price * aos.v[i].volume;
+        }
+    }
+    printf("array of structs: %g %.3f sec\n", x,
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    t = clock();
+    double y = 0;
+    for (unsigned int k = 0; k != 10; ++k)
+    {
+        const double *price = ksoa_col(soa, price);
+        const double *volume = ksoa_col(soa, volume);
+        for (size_t i = 0; i != ksoa_size(soa); ++i)
+        {
+            y += price[i] * volume[i];
+        }
+    }
+    printf("struct of arrays: %g %.3f sec\n", y,
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    if (x != y)
+    {
+        fprintf(stderr, "Bug in struct of arrays!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kv_rec_clear(&aos);
+    ksoa_rec_clear(&soa);
+}
+
+int main(void)
+{
+    test1(); /* test function */
+
+    test2(10000000U); /* test scan of column */
+
+    return 0;
+}
+
+/* END OF FILE */
@@ -29,6 +29,7 @@
 
 #include "ksort.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,6 +37,18 @@
 
 #define CMP(x, y) ((x) < (y))
 
+#define KEY_I(x)    ksort_key_i32(x)
+#define KEY_U64(x)  (x)
+#define KEY_F64(x)  ksort_key_f64(x)
+#define KEY_KV(x)   ((x).k)
+#define KV_LT(a, b) ((a).k < (b).k)
+
+typedef struct
+{
+    uint16_t k;
+    uint32_t i;
+} kv_t;
+
 void test_merge(size_t n)
 {
     int *array = malloc(sizeof(int) * 10);
@@ -84,6 +97,138 @@ void test_merge(size_t n)
     array = NULL;
 }
 
+void test_tim(size_t n)
+{
+    int *array = malloc(sizeof(int) * 10);
+
+    for (size_t i = 0U; i != 10U; ++i)
+    {
+        array[i] = rand() % 100;
+    }
+
+    printf("tim\t");
+
+    ksort_tim(int, array, 10, CMP, NULL);
+
+    for (size_t i = 0U; i != 10U; ++i)
+    {
+        printf("%i ", array[i]);
+    }
+
+    free(array);
+    array = malloc(sizeof(int) * n);
+
+    printf("\n%-10zu: ", n);
+    fflush(stdout);
+
+    for (size_t i = 0U; i != n; ++i)
+    {
+        array[i] = rand();
+    }
+
+    clock_t t = clock();
+    ksort_tim(int, array, n, CMP, NULL);
+    printf("%.3f sec\n", (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    for (size_t i = 0U; i != n - 1U; ++i)
+    {
+        if (array[i] > array[i + 1])
+        {
+            fprintf(stderr, "Bug in tim sort!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    free(array);
+    array = NULL;
+
+    /* the elements of equal keys keep their order, the buffer is n / 2 */
+    kv_t *kv = malloc(sizeof(kv_t) * n);
+    kv_t *buf = malloc(sizeof(kv_t) * (n / 2U));
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kv[i].k = (uint16_t)(rand() % 1000);
+        kv[i].i = (uint32_t)i;
+    }
+    ksort_tim(kv_t, kv, n, KV_LT, buf);
+    for (size_t i = 0U; i != n - 1U; ++i)
+    {
+        if (kv[i].k > kv[i + 1].k ||
+            (kv[i].k == kv[i + 1].k && kv[i].i > kv[i + 1].i))
+        {
+            fprintf(stderr, "Bug in tim sort, it is not stable!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(buf);
+    free(kv);
+}
+
+/* merge sort and adaptive merge sort on patterns of input */
+void test_stable(size_t n)
+{
+    static const char *const name[] = {
+        "random", "sorted", "95% sorted", "reversed", "few unique", "appended"};
+    int *array = malloc(sizeof(int) * n);
+
+    printf("pattern      merge      tim\n");
+    for (unsigned int k = 0U; k != sizeof(name) / sizeof(*name); ++k)
+    {
+        double sec[2];
+        for (unsigned int j = 0U; j != 2U; ++j)
+        {
+            srand(k);
+            for (size_t i = 0U; i != n; ++i)
+            {
+                switch (k)
+                {
+                case 0U:
+                    array[i] = rand();
+                    break;
+                case 1U:
+                    array[i] = (int)i;
+                    break;
+                case 2U:
+                    array[i] = rand() % 20 ? (int)i : rand() % (int)n;
+                    break;
+                case 3U:
+                    array[i] = (int)(n - i);
+                    break;
+                case 4U:
+                    array[i] = rand() % 16;
+                    break;
+                default:
+                    /* a sorted log with a short unsorted tail */
+                    array[i] = i < n - n / 100U ? (int)i : rand() % (int)n;
+                    break;
+                }
+            }
+            clock_t t = clock();
+            if (j)
+            {
+                ksort_tim(int, array, n, CMP, NULL);
+            }
+            else
+            {
+                ksort_merge(int, array, n, CMP, NULL);
+            }
+            sec[j] = (double)(clock() - t) / CLOCKS_PER_SEC;
+            for (size_t i = 0U; i != n - 1U; ++i)
+            {
+                if (array[i] > array[i + 1])
+                {
+                    fprintf(stderr, "Bug in %s sort!\n", j ? "tim" : "merge");
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        printf("%-10s: %.3f sec %.3f sec\n", name[k], sec[0], sec[1]);
+    }
+
+    free(array);
+    array = NULL;
+}
+
 void test_heap(size_t n)
 {
     int *array = malloc(sizeof(int) * 10);
@@ -270,6 +415,220 @@ void test_intro(size_t n)
     array = NULL;
 }
 
+void test_pdq(size_t n)
+{
+    int *array = malloc(sizeof(int) * 10);
+
+    for (size_t i = 0U; i != 10U; ++i)
+    {
+        array[i] = rand() % 100;
+    }
+
+    printf("pdq\t");
+
+    ksort_pdq(int, array, 10, CMP);
+
+    for (size_t i = 0U; i != 10U; ++i)
+    {
+        printf("%i ", array[i]);
+    }
+
+    free(array);
+    array = malloc(sizeof(int) * n);
+
+    printf("\n%-10zu: ", n);
+    fflush(stdout);
+
+    for (size_t i = 0U; i != n; ++i)
+    {
+        array[i] = rand();
+    }
+
+    clock_t t = clock();
+    ksort_pdq(int, array, n, CMP);
+    printf("%.3f sec\n", (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    for (size_t i = 0U; i != n - 1U; ++i)
+    {
+        if (array[i] > array[i + 1])
+        {
+            fprintf(stderr, "Bug in pdq sort!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    free(array);
+    array = NULL;
+}
+
+/* intro sort and pdq sort on patterns of input */
+void test_pattern(size_t n)
+{
+    static const char *const name[] = {
+        "random", "sorted", "reversed", "few unique", "organ pipe", "sawtooth"};
+    int *array = malloc(sizeof(int) * n);
+
+    printf("pattern      intro      pdq\n");
+    for (unsigned int k = 0U; k != sizeof(name) / sizeof(*name); ++k)
+    {
+        double sec[2];
+        for (unsigned int j = 0U; j != 2U; ++j)
+        {
+            srand(k);
+            for (size_t i = 0U; i != n; ++i)
+            {
+                switch (k)
+                {
+                case 0U:
+                    array[i] = rand();
+                    break;
+                case 1U:
+                    array[i] = (int)i;
+                    break;
+                case 2U:
+                    array[i] = (int)(n - i);
+                    break;
+                case 3U:
+                    array[i] = rand() % 16;
+                    break;
+                case 4U:
+                    array[i] = (int)(i < n / 2U ? i : n - i);
+                    break;
+                default:
+                    array[i] = (int)(i % 1000U);
+                    break;
+                }
+            }
+            clock_t t = clock();
+            if (j)
+            {
+                ksort_pdq(int, array, n, CMP);
+            }
+            else
+            {
+                ksort_intro(int, array, n, CMP);
+            }
+            sec[j] = (double)(clock() - t) / CLOCKS_PER_SEC;
+            for (size_t i = 0U; i != n - 1U; ++i)
+            {
+                if (array[i] > array[i + 1])
+                {
+                    fprintf(stderr, "Bug in %s sort!\n", j ? "pdq" : "intro");
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        printf("%-10s: %.3f sec %.3f sec\n", name[k], sec[0], sec[1]);
+    }
+
+    free(array);
+    array = NULL;
+}
+
+void test_radix(size_t n)
+{
+    int *array = malloc(sizeof(int) * 10);
+
+    for (size_t i = 0U; i != 10U; ++i)
+    {
+        array[i] = rand() % 100 - 50;
+    }
+
+    printf("radix\t");
+
+    ksort_radix(int, array, 10, KEY_I, NULL);
+
+    for (size_t i = 0U; i != 10U; ++i)
+    {
+        printf("%i ", array[i]);
+    }
+
+    free(array);
+    array = malloc(sizeof(int) * n);
+    int *buf = malloc(sizeof(int) * n);
+
+    printf("\n%-10zu: ", n);
+    fflush(stdout);
+
+    for (size_t i = 0U; i != n; ++i)
+    {
+        array[i] = rand() - RAND_MAX / 2;
+    }
+
+    clock_t t = clock();
+    ksort_radix(int, array, n, KEY_I, buf);
+    printf("%.3f sec\n", (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    for (size_t i = 0U; i != n - 1U; ++i)
+    {
+        if (array[i] > array[i + 1])
+        {
+            fprintf(stderr, "Bug in radix sort!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    free(buf);
+    free(array);
+    array = NULL;
+
+    /* wide keys that differ in the low bits only */
+    uint64_t *u = malloc(sizeof(uint64_t) * n);
+    for (size_t i = 0U; i != n; ++i)
+    {
+        u[i] = 0x0123456700000000U | (uint64_t)(rand() & 0xFFFFF);
+    }
+    ksort_radix(uint64_t, u, n, KEY_U64, NULL);
+    for (size_t i = 0U; i != n - 1U; ++i)
+    {
+        if (u[i] > u[i + 1])
+        {
+            fprintf(stderr, "Bug in radix sort of uint64_t!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(u);
+
+    double *d = malloc(sizeof(double) * n);
+    for (size_t i = 0U; i != n; ++i)
+    {
+        d[i] = (double)(rand() - RAND_MAX / 2) / (double)(rand() | 1);
+    }
+    d[0] = -0.0;
+    d[1] = 0.0;
+    t = clock();
+    ksort_radix(double, d, n, KEY_F64, NULL);
+    printf("radix double: %.3f sec\n", (double)(clock() - t) / CLOCKS_PER_SEC);
+    for (size_t i = 0U; i != n - 1U; ++i)
+    {
+        if (d[i] > d[i + 1])
+        {
+            fprintf(stderr, "Bug in radix sort of double!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(d);
+
+    /* the elements of equal keys keep their order */
+    kv_t *kv = malloc(sizeof(kv_t) * n);
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kv[i].k = (uint16_t)(rand() % 1000);
+        kv[i].i = (uint32_t)i;
+    }
+    ksort_radix(kv_t, kv, n, KEY_KV, NULL);
+    for (size_t i = 0U; i != n - 1U; ++i)
+    {
+        if (kv[i].k > kv[i + 1].k ||
+            (kv[i].k == kv[i + 1].k && kv[i].i > kv[i + 1].i))
+        {
+            fprintf(stderr, "Bug in radix sort, it is not stable!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(kv);
+}
+
 void test_ksmall(size_t n)
 {
     printf("ksmall\t");
@@ -302,6 +661,11 @@ int main(void)
     srand(t);
     test_merge(n);
 
+    srand(t);
+    test_tim(n);
+
+    test_stable(n);
+
     srand(t);
     test_heap(n);
 
@@ -314,6 +678,14 @@ int main(void)
     srand(t);
     test_intro(n);
 
+    srand(t);
+    test_pdq(n);
+
+    test_pattern(n);
+
+    srand(t);
+    test_radix(n);
+
     srand(t);
     test_ksmall(n);
 
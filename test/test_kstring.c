@@ -28,6 +28,7 @@
 #include "kstring.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 int main(void)
@@ -54,6 +55,37 @@ int main(void)
 
     ks_free(ks);
 
+    /* the size near 2^63 can not be rounded up, it fails before realloc */
+    ks = ks_init();
+    size_t m = ks->m;
+    if (!ks_resize(ks, (~(size_t)0 >> 1) + 2U) || !ks_resize(ks, ~(size_t)0) || ks->m != m)
+    {
+        fprintf(stderr, "Bug in ks_resize!\n");
+        exit(EXIT_FAILURE);
+    }
+    /* 4 GiB + 1 is rounded up to 8 GiB */
+    if (sizeof(size_t) == 8U)
+    {
+        size_t n = (size_t)(1ULL << 32) + 1U;
+        kroundup(n);
+        if (n != (size_t)(1ULL << 33))
+        {
+            fprintf(stderr, "Bug in kroundup!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    /* it is allocated only if KLIB_TEST_HUGE is set */
+    if (sizeof(size_t) == 8U && getenv("KLIB_TEST_HUGE"))
+    {
+        size_t n = (size_t)(1ULL << 32) + 1U;
+        if (ks_resize(ks, n) ? ks->m != m : ks->m != (n - 1U) << 1)
+        {
+            fprintf(stderr, "Bug in ks_resize!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    ks_free(ks);
+
     return 0;
 }
 
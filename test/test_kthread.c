@@ -0,0 +1,161 @@
+/*!
+ @file           test_kthread.c
+ @brief          test thread pool library
+ @author         tqfx tqfx@foxmail.com
+ @version        0
+ @date           2021-06-14
+ @copyright      Copyright (C) 2021 tqfx
+ \n \n
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ \n \n
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ \n \n
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+
+#include "kthread.h"
+#include "kvec.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <time.h>
+
+kvec_init(u64, unsigned long long)
+kvec_math_init(u64, unsigned long long)
+kvec_parallel_init(u64, unsigned long long)
+kvec_parallel_scan_init(u64, unsigned long long)
+
+static void square(unsigned long long *p, size_t n, void *arg)
+{
+    (void)arg;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        p[i] = p[i] * p[i];
+    }
+}
+
+static unsigned long long add(unsigned long long a, unsigned long long b)
+{
+    return a + b;
+}
+
+static int odd(const unsigned long long *x, void *arg)
+{
+    (void)arg;
+    return (int)(*x & 1U);
+}
+
+void test(kthread_t *kt, size_t n)
+{
+    kvec_t(u64) kv, out;
+    kv_u64_init(&kv);
+    kv_u64_init(&out);
+    kv_u64_resize(&kv, n);
+    for (size_t i = 0U; i != n; ++i)
+    {
+        kv_push(unsigned long long, kv, i);
+    }
+
+    printf("threads %u\n", kt_size(kt));
+
+    double t = now();
+    kv_u64_parallel_for(kt, &kv, square, NULL, 0U);
+    printf("parallel_for   : %.3f sec\n", now() - t);
+
+    t = now();
+    unsigned long long sum = 0U;
+    kv_u64_parallel_reduce(&sum, kt, &kv, 0U, add, 0U);
+    printf("parallel_reduce: %.3f sec\n", now() - t);
+
+    t = now();
+    kv_u64_parallel_filter(kt, &out, &kv, odd, NULL, 0U);
+    printf("parallel_filter: %.3f sec\n", now() - t);
+
+    kvec_t(u64) scan;
+    kv_u64_init(&scan);
+    t = now();
+    kv_u64_parallel_scan_inclusive(kt, &scan, &kv, 0U);
+    printf("parallel_scan  : %.3f sec\n", now() - t);
+
+    unsigned long long s = 0U;
+    size_t j = 0U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        unsigned long long x = (unsigned long long)i * i;
+        if (kv_v(kv, i) != x)
+        {
+            fprintf(stderr, "Bug in parallel for!\n");
+            exit(EXIT_FAILURE);
+        }
+        s += x;
+        if (kv_v(scan, i) != s)
+        {
+            fprintf(stderr, "Bug in parallel scan!\n");
+            exit(EXIT_FAILURE);
+        }
+        if (x & 1U)
+        {
+            if (j == kv_size(out) || kv_v(out, j) != x)
+            {
+                fprintf(stderr, "Bug in parallel filter!\n");
+                exit(EXIT_FAILURE);
+            }
+            ++j;
+        }
+    }
+    if (s != sum || j != kv_size(out))
+    {
+        fprintf(stderr, "Bug in parallel reduce!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kv_u64_parallel_scan_exclusive(kt, &kv, &kv, 0U);
+    s = 0U;
+    for (size_t i = 0U; i != n; ++i)
+    {
+        if (kv_v(kv, i) != s)
+        {
+            fprintf(stderr, "Bug in parallel scan!\n");
+            exit(EXIT_FAILURE);
+        }
+        s += (unsigned long long)i * i;
+    }
+
+    kv_u64_clear(&kv);
+    kv_u64_clear(&out);
+    kv_u64_clear(&scan);
+}
+
+int main(void)
+{
+    kthread_t *kt = kt_init(1U);
+    test(kt, 10000000U);
+    kt_free(kt);
+
+    kt = kt_init(0U);
+    test(kt, 10000000U);
+    test(kt, 1000U);
+    test(kt, 0U);
+    kt_free(kt);
+
+    kt = kt_init(4U);
+    test(kt, 1000001U);
+    kt_free(kt);
+
+    return 0;
+}
+
+/* END OF FILE */
@@ -81,6 +81,12 @@ void test1(void)
 
 /* impl type and functon */
 __KVEC_INIT(u32, unsigned int)
+kvec_math_init(u32, unsigned int)
+
+kvec_init(f32, float)
+kvec_math_init(f32, float)
+
+kvec_init(u8, unsigned char)
 
 /*!
  @brief          test kver_t macros
@@ -270,6 +276,230 @@ void test4(void)
            (double)(clock() - t) / CLOCKS_PER_SEC);
 }
 
+/*!
+ @brief          test search and reduction
+*/
+void test5(void)
+{
+    unsigned int M = 2000U;
+    unsigned int N = 65536U;
+
+    kvec_t(u32) kv;
+    kvec_t(f32) kf;
+    kv_u32_init(&kv);
+    kv_f32_init(&kf);
+    for (unsigned int i = 0; i != N; ++i)
+    {
+        kv_push(unsigned int, kv, (i * 2654435761U) >> 8U);
+        kv_push(float, kf, (float)(i % 1000U) - 500.0F);
+    }
+    unsigned int x = kv_v(kv, N - 7U);
+
+    clock_t t = clock();
+    size_t find = 0U, count = 0U;
+    unsigned int min = ~0U, max = 0U, sum = 0U;
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        for (find = 0U; find != kv.n && kv.v[find] != x; ++find)
+        {
+        }
+        count = 0U;
+        for (size_t i = 0U; i != kv.n; ++i)
+        {
+            count += kv.v[i] == x;
+        }
+        for (size_t i = 0U; i != kv.n; ++i)
+        {
+            min = kv.v[i] < min ? kv.v[i] : min;
+        }
+        for (size_t i = 0U; i != kv.n; ++i)
+        {
+            max = kv.v[i] > max ? kv.v[i] : max;
+        }
+        sum = 0U;
+        for (size_t i = 0U; i != kv.n; ++i)
+        {
+            sum += kv.v[i];
+        }
+    }
+    printf("scalar loop: %.3f sec\n",
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    t = clock();
+    size_t find2 = 0U, count2 = 0U;
+    unsigned int min2 = 0U, max2 = 0U, sum2 = 0U;
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        find2 = kv_u32_find(&kv, x);
+        count2 = kv_u32_count(&kv, x);
+        kv_u32_vmin(&min2, &kv);
+        kv_u32_vmax(&max2, &kv);
+        sum2 = kv_u32_sum(&kv);
+    }
+    printf("kvec math: %.3f sec\n",
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    if (find != find2 || count != count2 ||
+        min != min2 || max != max2 || sum != sum2 ||
+        kv_u32_find(&kv, ~0U) != kv.n)
+    {
+        fprintf(stderr, "Bug in kvec math!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    float fmin = 0, fmax = 0;
+    kv_f32_vmin(&fmin, &kf);
+    kv_f32_vmax(&fmax, &kf);
+    printf("find %zu count %zu min %g max %g sum %g\n",
+           kv_f32_find(&kf, 499.0F),
+           kv_f32_count(&kf, 0.0F),
+           (double)fmin,
+           (double)fmax,
+           (double)kv_f32_sum(&kf));
+    if (fmin != -500.0F || fmax != 499.0F || kv_f32_find(&kf, 499.0F) != 999U)
+    {
+        fprintf(stderr, "Bug in kvec math!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kv_u32_clear(&kv);
+    kv_f32_clear(&kf);
+}
+
+/*!
+ @brief          test prefix sum
+*/
+void test6(void)
+{
+    unsigned int M = 2000U;
+    unsigned int N = 65536U + 3U;
+
+    kvec_t(u32) kv, out;
+    kv_u32_init(&kv);
+    kv_u32_init(&out);
+    for (unsigned int i = 0; i != N; ++i)
+    {
+        kv_push(unsigned int, kv, (i * 2654435761U) >> 8U);
+    }
+    std::vector<unsigned int> ref(N);
+
+    clock_t t = clock();
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        unsigned int s = 0U;
+        for (size_t i = 0U; i != kv.n; ++i)
+        {
+            s += kv.v[i];
+            ref[i] = s;
+        }
+    }
+    printf("scalar scan: %.3f sec\n",
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    t = clock();
+    for (unsigned int k = 0; k != M; ++k)
+    {
+        kv_u32_scan_inclusive(&out, &kv);
+    }
+    printf("kvec scan: %.3f sec\n",
+           (double)(clock() - t) / CLOCKS_PER_SEC);
+
+    if (out.n != N || memcmp(out.v, &ref[0], sizeof(unsigned int) * N))
+    {
+        fprintf(stderr, "Bug in kvec scan_inclusive!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kv_u32_scan_exclusive(&kv, &kv);
+    for (size_t i = 0U; i != N; ++i)
+    {
+        if (kv.v[i] != (i ? ref[i - 1U] : 0U))
+        {
+            fprintf(stderr, "Bug in kvec scan_exclusive!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    kv_u32_clear(&kv);
+    kv_u32_clear(&out);
+}
+
+/*!
+ @brief          test growth near 4 GiB and 2^63
+*/
+void test7(void)
+{
+    unsigned long long x = (1ULL << 32) + 1U;
+    unsigned long long y = 1ULL << 32;
+    unsigned int u = 0x80000001U;
+    unsigned int w = 1000U;
+    kroundup64(x);
+    kroundup64(y);
+    kroundup(u);
+    kroundup(w);
+    if (x != 1ULL << 33 || y != 1ULL << 32 || u != 0U || w != 1024U)
+    {
+        fprintf(stderr, "Bug in kroundup!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* 2^63 */
+    size_t h = (~(size_t)0 >> 1) + 1U;
+    size_t z = (h >> 1) + 1U;
+    kroundup(z);
+    if (z != h || (z = h + 1U, kroundup(z), z != 0U))
+    {
+        fprintf(stderr, "Bug in kroundup!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!ksize_overflow(h, sizeof(unsigned int)) || ksize_overflow(h - 1U, 1U) ||
+        ksize_mul(h, sizeof(unsigned int)) != ~(size_t)0)
+    {
+        fprintf(stderr, "Bug in ksize_overflow!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kvec_t(u32) kv;
+    kv_u32_init(&kv);
+    if (!kv_u32_resize(&kv, h) || !kv_u32_vi(&kv, h + 1U, 1U) ||
+        !kv_u32_vi(&kv, ~(size_t)0, 1U) || kv.m || kv.v)
+    {
+        fprintf(stderr, "Bug in kvec growth near 2^63!\n");
+        exit(EXIT_FAILURE);
+    }
+    kv_u32_clear(&kv);
+
+    /* 4 GiB, only the pages written are touched, if KLIB_TEST_HUGE is set */
+    if (sizeof(size_t) < 8U || !getenv("KLIB_TEST_HUGE"))
+    {
+        return;
+    }
+    kvec_t(u8) kb;
+    kv_u8_init(&kb);
+    size_t n = (size_t)(1ULL << 32) + 1U;
+    if (kv_u8_resize(&kb, n))
+    {
+        printf("kvec 4 GiB: no memory, skipped\n");
+        return;
+    }
+    kb.n = n - 1U;
+    kv_u8_push(&kb, 7U);
+    kb.v[(size_t)1 << 31] = 3U;
+    if (kb.m != n || kb.v[n - 1U] != 7U || kb.v[(size_t)1 << 31] != 3U)
+    {
+        fprintf(stderr, "Bug in kvec growth near 4 GiB!\n");
+        exit(EXIT_FAILURE);
+    }
+    /* double to 8 GiB, the memory may not be enough */
+    if (kv_u8_push(&kb, 9U) ? kb.m != n : kb.m != n << 1 || kb.v[n] != 9U)
+    {
+        fprintf(stderr, "Bug in kvec growth near 4 GiB!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("kvec 4 GiB: %zu elements\n", kb.n);
+    kv_u8_clear(&kb);
+}
+
 int main(void)
 {
     test1();
@@ -280,6 +510,12 @@ int main(void)
 
     test4();
 
+    test5();
+
+    test6();
+
+    test7();
+
     return 0;
 }
 